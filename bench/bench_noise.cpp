@@ -0,0 +1,321 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//
+// Throughput benchmark of noise() and pnoise() in 1D to 4D.
+//
+// Every case evaluates a fixed set of sample points, either uniformly
+// random in [-128,128]^D or a dense grid with 16 samples per lattice cell
+// and axis, through the single point functions (scalar), the batch entry
+// points (batch) or, for 2D and 3D grids, the row spans (span), on one
+// thread and on all threads. The best of several repetitions is reported.
+//
+// usage: bench_noise [-n samples] [-r repetitions] [-t threads]
+//                    [--csv file] [--json file]
+//
+
+#include <cgmath/noise.h>
+#include <cgmath/parallel.h>
+#include <cgmath/timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cgmath;
+
+
+namespace {
+
+    // Samples per parallel work item
+    const int CHUNK = 4096;
+
+    // Periods of the pnoise() cases
+    const int PERIOD = 64;
+
+
+    struct Result {
+        const char *function;
+        int dim;
+        const char *pattern;
+        const char *api;
+        int threads;
+        size_t samples;
+        double ns_per_sample;
+        double samples_per_sec;
+    };
+
+
+    struct Points {
+        int dim;
+        size_t row;     ///< samples per grid row, 0 for random points
+        std::vector<float> c[4];
+    };
+
+
+    Points random_points( int dim, size_t n ) {
+        Points p;
+        p.dim = dim;
+        p.row = 0;
+        uint32_t s = 12345;
+        for (int d = 0; d < dim; ++d) {
+            p.c[d].resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                s = 1664525u * s + 1013904223u;
+                p.c[d][i] = (s >> 8) * (256.0f / 16777216.0f) - 128.0f;
+            }
+        }
+        return p;
+    }
+
+
+    // Row-major grid, x fastest, as rasterizing an image or volume does
+    Points grid_points( int dim, size_t n ) {
+        Points p;
+        p.dim = dim;
+        size_t side = static_cast<size_t>(std::ceil(std::pow(static_cast<double>(n), 1.0 / dim)));
+        p.row = side;
+        for (int d = 0; d < dim; ++d) {
+            p.c[d].resize(n);
+            size_t stride = 1;
+            for (int k = 0; k < d; ++k) stride *= side;
+            for (size_t i = 0; i < n; ++i) {
+                p.c[d][i] = static_cast<float>((i / stride) % side) / 16 + 0.03125f;
+            }
+        }
+        return p;
+    }
+
+
+    void eval_scalar( const NoiseContext& ctx, bool periodic, const Points& p,
+                      float *out, size_t begin, size_t end )
+    {
+        const float *x = &p.c[0][0];
+        const float *y = (p.dim > 1)? &p.c[1][0] : 0;
+        const float *z = (p.dim > 2)? &p.c[2][0] : 0;
+        const float *w = (p.dim > 3)? &p.c[3][0] : 0;
+        const int P = PERIOD;
+        switch (p.dim * 2 + (periodic? 1 : 0)) {
+            case 2: for (size_t i = begin; i < end; ++i) out[i] = ctx.noise(x[i]); break;
+            case 3: for (size_t i = begin; i < end; ++i) out[i] = ctx.pnoise(x[i], P); break;
+            case 4: for (size_t i = begin; i < end; ++i) out[i] = ctx.noise(x[i], y[i]); break;
+            case 5: for (size_t i = begin; i < end; ++i) out[i] = ctx.pnoise(x[i], y[i], P, P); break;
+            case 6: for (size_t i = begin; i < end; ++i) out[i] = ctx.noise(x[i], y[i], z[i]); break;
+            case 7: for (size_t i = begin; i < end; ++i) out[i] = ctx.pnoise(x[i], y[i], z[i], P, P, P); break;
+            case 8: for (size_t i = begin; i < end; ++i) out[i] = ctx.noise(x[i], y[i], z[i], w[i]); break;
+            case 9: for (size_t i = begin; i < end; ++i) out[i] = ctx.pnoise(x[i], y[i], z[i], w[i], P, P, P, P); break;
+        }
+    }
+
+
+    void eval_batch( const NoiseContext& ctx, bool periodic, const Points& p,
+                     float *out, size_t begin, size_t end )
+    {
+        const float *x = &p.c[0][begin];
+        const float *y = (p.dim > 1)? &p.c[1][begin] : 0;
+        const float *z = (p.dim > 2)? &p.c[2][begin] : 0;
+        const float *w = (p.dim > 3)? &p.c[3][begin] : 0;
+        const int P = PERIOD;
+        size_t n = end - begin;
+        out += begin;
+        switch (p.dim * 2 + (periodic? 1 : 0)) {
+            case 2: ctx.noise_batch(x, out, n); break;
+            case 3: ctx.pnoise_batch(x, P, out, n); break;
+            case 4: ctx.noise_batch(x, y, out, n); break;
+            case 5: ctx.pnoise_batch(x, y, P, P, out, n); break;
+            case 6: ctx.noise_batch(x, y, z, out, n); break;
+            case 7: ctx.pnoise_batch(x, y, z, P, P, P, out, n); break;
+            case 8: ctx.noise_batch(x, y, z, w, out, n); break;
+            case 9: ctx.pnoise_batch(x, y, z, w, P, P, P, P, out, n); break;
+        }
+    }
+
+
+    // Grid points only, dimensions 2 and 3
+    void eval_span( const NoiseContext& ctx, bool periodic, const Points& p,
+                    float *out, size_t begin, size_t end )
+    {
+        const int P = PERIOD;
+        const float dx = 1.0f / 16;
+        for (size_t i = begin; i < end; ) {
+            size_t n = std::min(end, i - i % p.row + p.row) - i;
+            float x = p.c[0][i], y = p.c[1][i];
+            if (p.dim == 2) {
+                if (periodic) ctx.pnoise_span(x, y, dx, P, P, out + i, n); else ctx.noise_span(x, y, dx, out + i, n);
+            } else {
+                float z = p.c[2][i];
+                if (periodic) ctx.pnoise_span(x, y, z, dx, P, P, P, out + i, n); else ctx.noise_span(x, y, z, dx, out + i, n);
+            }
+            i += n;
+        }
+    }
+
+
+    enum Api { SCALAR, BATCH, SPAN };
+
+    void eval( Api api, const NoiseContext& ctx, bool periodic, const Points& p,
+               float *out, size_t begin, size_t end )
+    {
+        switch (api) {
+            case SCALAR: eval_scalar(ctx, periodic, p, out, begin, end); break;
+            case BATCH: eval_batch(ctx, periodic, p, out, begin, end); break;
+            case SPAN: eval_span(ctx, periodic, p, out, begin, end); break;
+        }
+    }
+
+
+    // Best time of reps runs in ms
+    double run( Api api, const NoiseContext& ctx, bool periodic, const Points& p,
+                std::vector<float>& out, ThreadPool *pool, int reps )
+    {
+        size_t n = out.size();
+        int chunks = static_cast<int>((n + CHUNK - 1) / CHUNK);
+        double best = 1e30;
+        for (int r = 0; r < reps; ++r) {
+            timer t;
+            if (pool) {
+                parallel_for(chunks, [&]( int c ) {
+                    size_t begin = static_cast<size_t>(c) * CHUNK;
+                    eval(api, ctx, periodic, p, &out[0], begin, std::min(n, begin + CHUNK));
+                }, *pool);
+            } else {
+                eval(api, ctx, periodic, p, &out[0], 0, n);
+            }
+            best = std::min(best, t.get_elapsed_time());
+        }
+        return best;
+    }
+
+
+    void write_csv( FILE *f, const std::vector<Result>& results ) {
+        std::fprintf(f, "function,dim,pattern,api,threads,samples,ns_per_sample,samples_per_sec\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::fprintf(f, "%s,%d,%s,%s,%d,%lu,%.4f,%.0f\n", r.function, r.dim, r.pattern, r.api,
+                         r.threads, static_cast<unsigned long>(r.samples), r.ns_per_sample, r.samples_per_sec);
+        }
+    }
+
+
+    void write_json( FILE *f, const std::vector<Result>& results ) {
+        std::fprintf(f, "[\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::fprintf(f, "  { \"function\": \"%s\", \"dim\": %d, \"pattern\": \"%s\", \"api\": \"%s\", "
+                         "\"threads\": %d, \"samples\": %lu, \"ns_per_sample\": %.4f, \"samples_per_sec\": %.0f }%s\n",
+                         r.function, r.dim, r.pattern, r.api, r.threads, static_cast<unsigned long>(r.samples),
+                         r.ns_per_sample, r.samples_per_sec, (i + 1 < results.size())? "," : "");
+        }
+        std::fprintf(f, "]\n");
+    }
+
+
+    bool write( const char *path, const std::vector<Result>& results,
+                void (*writer)( FILE*, const std::vector<Result>& ) )
+    {
+        FILE *f = std::fopen(path, "w");
+        if (!f) {
+            std::fprintf(stderr, "bench_noise: cannot write %s\n", path);
+            return false;
+        }
+        writer(f, results);
+        std::fclose(f);
+        return true;
+    }
+
+}
+
+
+int main( int argc, char **argv ) {
+    size_t samples = 1 << 20;
+    int reps = 5;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    const char *csv = 0;
+    const char *json = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        bool more = i + 1 < argc;
+        if (!std::strcmp(argv[i], "-n") && more) {
+            samples = std::max(1L, std::atol(argv[++i]));
+        } else if (!std::strcmp(argv[i], "-r") && more) {
+            reps = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "-t") && more) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--csv") && more) {
+            csv = argv[++i];
+        } else if (!std::strcmp(argv[i], "--json") && more) {
+            json = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [-n samples] [-r repetitions] [-t threads] "
+                         "[--csv file] [--json file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // the calling thread takes part in parallel_for
+    ThreadPool pool(threads - 1);
+    const NoiseContext& ctx = default_noise_context();
+    std::vector<float> out(samples);
+    std::vector<Result> results;
+    double checksum = 0;
+
+    std::printf("%-8s %3s %-7s %-7s %7s %12s %14s\n",
+                "function", "dim", "pattern", "api", "threads", "ns/sample", "samples/sec");
+
+    for (int dim = 1; dim <= 4; ++dim) {
+        for (int pattern = 0; pattern < 2; ++pattern) {
+            Points p = pattern? grid_points(dim, samples) : random_points(dim, samples);
+            for (int periodic = 0; periodic < 2; ++periodic) {
+                for (int api = SCALAR; api <= SPAN; ++api) {
+                    if ((api == SPAN) && (!pattern || (dim < 2) || (dim > 3))) continue;
+                    for (int mt = 0; mt < ((threads > 1)? 2 : 1); ++mt) {
+                        double ms = run(Api(api), ctx, periodic != 0, p, out, mt? &pool : 0, reps);
+                        checksum += out[samples / 2];
+
+                        Result r;
+                        r.function = periodic? "pnoise" : "noise";
+                        r.dim = dim;
+                        r.pattern = pattern? "grid" : "random";
+                        r.api = (api == SPAN)? "span" : (api == BATCH)? "batch" : "scalar";
+                        r.threads = mt? threads : 1;
+                        r.samples = samples;
+                        r.ns_per_sample = 1e6 * ms / samples;
+                        r.samples_per_sec = (ms > 0)? 1e3 * samples / ms : 0;
+                        results.push_back(r);
+
+                        std::printf("%-8s %3d %-7s %-7s %7d %12.3f %14.0f\n", r.function, r.dim, r.pattern,
+                                    r.api, r.threads, r.ns_per_sample, r.samples_per_sec);
+                        std::fflush(stdout);
+                    }
+                }
+            }
+        }
+    }
+
+    // keeps the evaluations from being optimized away
+    std::printf("checksum %g\n", checksum);
+
+    bool ok = true;
+    if (csv) ok = write(csv, results, write_csv) && ok;
+    if (json) ok = write(json, results, write_json) && ok;
+    return ok? 0 : 1;
+}
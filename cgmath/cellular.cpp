@@ -0,0 +1,363 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/cellular.h>
+#include <cgmath/parallel.h>
+#include <cgmath/simd.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+
+namespace {
+
+    using cgmath::CellularNoise;
+
+    using namespace cgmath::simd;
+
+    // Distances are compared in a monotonic form (squared for EUCLIDEAN)
+    // and finished once F1 and F2 are known
+    inline vfloat abs( vfloat x ) {
+        return max(x, sub(splat(0.0f), x));
+    }
+
+    struct Euclidean {
+        static vfloat dist( vfloat x, vfloat y ) { return add(mul(x, x), mul(y, y)); }
+        static vfloat dist( vfloat x, vfloat y, vfloat z ) { return add(add(mul(x, x), mul(y, y)), mul(z, z)); }
+        static float finish( float d ) { return std::sqrt(d); }
+    };
+
+    struct Manhattan {
+        static vfloat dist( vfloat x, vfloat y ) { return add(abs(x), abs(y)); }
+        static vfloat dist( vfloat x, vfloat y, vfloat z ) { return add(add(abs(x), abs(y)), abs(z)); }
+        static float finish( float d ) { return d; }
+    };
+
+    struct Chebyshev {
+        static vfloat dist( vfloat x, vfloat y ) { return max(abs(x), abs(y)); }
+        static vfloat dist( vfloat x, vfloat y, vfloat z ) { return max(max(abs(x), abs(y)), abs(z)); }
+        static float finish( float d ) { return d; }
+    };
+
+
+    inline int floor_int( float x ) {
+        int i = static_cast<int>(x);
+        return (x < i)? i - 1 : i;
+    }
+
+
+    inline const int* perm_of( const CellularNoise& c ) {
+        return (c.context? *c.context : cgmath::default_noise_context()).perm();
+    }
+
+
+    inline int cell_hash( const int *perm, int ix, int iy ) {
+        return perm[perm[ix & 255] + (iy & 255)];
+    }
+
+
+    inline int cell_hash( const int *perm, int ix, int iy, int iz ) {
+        return perm[perm[perm[ix & 255] + (iy & 255)] + (iz & 255)];
+    }
+
+
+    // Feature points are displaced from the cell center by jitter times
+    // (v + 0.5) / 256 - 0.5 along each axis, for a permutation entry v,
+    // folded into base + v * scale
+    struct Jitter {
+        Jitter( float j ) : base(0.5f - 0.5f * j + 0.5f * j / 256), scale(j / 256) { }
+        float base;
+        float scale;
+    };
+
+
+    // Position of the feature point along axis k within the cell. Each
+    // axis uses its own permutation entry next to the cell hash.
+    inline float offset( const int *perm, int h, int k, const Jitter& j ) {
+        return j.base + perm[h + k] * j.scale;
+    }
+
+
+    // Candidate counts rounded up to whole registers. Padding points are
+    // far enough away to never be among the two nearest.
+    enum { N2 = (9 + width - 1) / width * width, N3 = (27 + width - 1) / width * width };
+    const float FAR = 1e4f;
+
+
+    // Feature points of the 3x3 (3x3x3) cells around the current cell,
+    // relative to its corner, as n = 3 * j + i (9 * k + 3 * j + i). Samples
+    // that stay in the cell reuse them, and a step to the next cell in x,
+    // as along the rows of fill(), only hashes the new column.
+    template <int D> class Cells {
+    public:
+        enum { N = (D == 2)? N2 : N3, ROWS = (D == 2)? 3 : 9 };
+
+        Cells( const CellularNoise& c ) : m_perm(perm_of(c)), m_jitter(c.jitter), m_valid(false) {
+            for (int n = 0; n < N; ++n) {
+                for (int d = 0; d < 3; ++d) p[d][n] = FAR;
+            }
+        }
+
+        void locate( const int *cell ) {
+            bool same = m_valid;
+            for (int d = 1; d < D; ++d) same = same && (cell[d] == m_cell[d]);
+            if (same && (cell[0] == m_cell[0])) return;
+
+            if (same && (cell[0] == m_cell[0] + 1)) {
+                for (int r = 0; r < ROWS; ++r) {
+                    for (int i = 0; i < 2; ++i) {
+                        for (int d = 0; d < D; ++d) p[d][3 * r + i] = p[d][3 * r + i + 1];
+                        p[0][3 * r + i] -= 1;
+                    }
+                }
+                m_cell[0] = cell[0];
+                load_column(2);
+            } else {
+                for (int d = 0; d < D; ++d) m_cell[d] = cell[d];
+                for (int i = 0; i < 3; ++i) load_column(i);
+                m_valid = true;
+            }
+        }
+
+        float p[3][N];
+
+    private:
+        // The hash chain is shared along the column, like perm[perm[x] + y]
+        // of noise() is shared by the corners of a cell
+        void load_column( int i ) {
+            int hx = m_perm[(m_cell[0] + i - 1) & 255];
+            for (int j = 0; j < 3; ++j) {
+                int hxy = m_perm[hx + ((m_cell[1] + j - 1) & 255)];
+                for (int k = 0; k < ROWS / 3; ++k) {
+                    int h = (D == 2)? hxy : m_perm[hxy + ((m_cell[2] + k - 1) & 255)];
+                    int n = 9 * k + 3 * j + i;
+                    p[0][n] = i - 1 + offset(m_perm, h, 0, m_jitter);
+                    p[1][n] = j - 1 + offset(m_perm, h, 1, m_jitter);
+                    if (D == 3) p[2][n] = k - 1 + offset(m_perm, h, 2, m_jitter);
+                }
+            }
+        }
+
+        const int *m_perm;
+        Jitter m_jitter;
+        int m_cell[3];
+        bool m_valid;
+    };
+
+
+    // Two smallest values of the lanes of d1 and d2, where d1 <= d2 lane-wise
+    template <typename M> void finish( vfloat d1, vfloat d2, float *f1, float *f2 ) {
+        float a[width], b[width];
+        store(a, d1);
+        store(b, d2);
+        float r1 = a[0], r2 = b[0];
+        for (int k = 1; k < width; ++k) {
+            r2 = std::min(std::max(r1, a[k]), std::min(r2, b[k]));
+            r1 = std::min(r1, a[k]);
+        }
+        *f1 = M::finish(r1);
+        *f2 = M::finish(r2);
+    }
+
+
+    // All candidates are tested without branches, a lane per candidate;
+    // each lane keeps the two smallest distances it has seen.
+    template <typename M> void search( Cells<2>& cells, float x, float y, float *f1, float *f2 ) {
+        int c[2] = { floor_int(x), floor_int(y) };
+        cells.locate(c);
+        vfloat fx = splat(x - c[0]);
+        vfloat fy = splat(y - c[1]);
+
+        vfloat d1 = splat(std::numeric_limits<float>::max());
+        vfloat d2 = d1;
+        for (int n = 0; n < N2; n += width) {
+            vfloat d = M::dist(sub(load(cells.p[0] + n), fx), sub(load(cells.p[1] + n), fy));
+            d2 = min(d2, max(d1, d));
+            d1 = min(d1, d);
+        }
+        finish<M>(d1, d2, f1, f2);
+    }
+
+
+    template <typename M> void search( Cells<3>& cells, float x, float y, float z, float *f1, float *f2 ) {
+        int c[3] = { floor_int(x), floor_int(y), floor_int(z) };
+        cells.locate(c);
+        vfloat fx = splat(x - c[0]);
+        vfloat fy = splat(y - c[1]);
+        vfloat fz = splat(z - c[2]);
+
+        vfloat d1 = splat(std::numeric_limits<float>::max());
+        vfloat d2 = d1;
+        for (int n = 0; n < N3; n += width) {
+            vfloat d = M::dist(sub(load(cells.p[0] + n), fx), sub(load(cells.p[1] + n), fy), 
+                               sub(load(cells.p[2] + n), fz));
+            d2 = min(d2, max(d1, d));
+            d1 = min(d1, d);
+        }
+        finish<M>(d1, d2, f1, f2);
+    }
+
+
+    inline float value( const CellularNoise& c, float f1, float f2 ) {
+        switch (c.type) {
+            case CellularNoise::F1: return f1;
+            case CellularNoise::F2: return f2;
+            default: return f2 - f1;
+        }
+    }
+
+
+    // zs == 0 selects 2D
+    template <typename M> void eval( const CellularNoise& c, const float *xs, const float *ys, const float *zs,
+                                     float *out, size_t n )
+    {
+        float f1, f2;
+        if (zs) {
+            Cells<3> cells(c);
+            for (size_t i = 0; i < n; ++i) {
+                search<M>(cells, xs[i], ys[i], zs[i], &f1, &f2);
+                out[i] = value(c, f1, f2);
+            }
+        } else {
+            Cells<2> cells(c);
+            for (size_t i = 0; i < n; ++i) {
+                search<M>(cells, xs[i], ys[i], &f1, &f2);
+                out[i] = value(c, f1, f2);
+            }
+        }
+    }
+
+
+    void eval( const CellularNoise& c, const float *xs, const float *ys, const float *zs,
+               float *out, size_t n )
+    {
+        switch (c.metric) {
+            case CellularNoise::EUCLIDEAN: eval<Euclidean>(c, xs, ys, zs, out, n); break;
+            case CellularNoise::MANHATTAN: eval<Manhattan>(c, xs, ys, zs, out, n); break;
+            case CellularNoise::CHEBYSHEV: eval<Chebyshev>(c, xs, ys, zs, out, n); break;
+        }
+    }
+
+
+    template <typename M> void find_distances( const CellularNoise& c, float x, float y, const float *z,
+                                               float *f1, float *f2 )
+    {
+        if (z) {
+            Cells<3> cells(c);
+            search<M>(cells, x, y, *z, f1, f2);
+        } else {
+            Cells<2> cells(c);
+            search<M>(cells, x, y, f1, f2);
+        }
+    }
+
+
+    void find_distances( const CellularNoise& c, float x, float y, const float *z, float *f1, float *f2 ) {
+        switch (c.metric) {
+            case CellularNoise::EUCLIDEAN: find_distances<Euclidean>(c, x, y, z, f1, f2); break;
+            case CellularNoise::MANHATTAN: find_distances<Manhattan>(c, x, y, z, f1, f2); break;
+            case CellularNoise::CHEBYSHEV: find_distances<Chebyshev>(c, x, y, z, f1, f2); break;
+        }
+    }
+
+}
+
+
+float cgmath::CellularNoise::operator()( float x, float y ) const {
+    float r;
+    eval(*this, &x, &y, 0, &r, 1);
+    return r;
+}
+
+
+float cgmath::CellularNoise::operator()( float x, float y, float z ) const {
+    float r;
+    eval(*this, &x, &y, &z, &r, 1);
+    return r;
+}
+
+
+void cgmath::CellularNoise::distances( float x, float y, float *f1, float *f2 ) const {
+    CellularNoise c(*this);
+    c.type = F2;
+    find_distances(c, x, y, 0, f1, f2);
+}
+
+
+void cgmath::CellularNoise::distances( float x, float y, float z, float *f1, float *f2 ) const {
+    CellularNoise c(*this);
+    c.type = F2;
+    find_distances(c, x, y, &z, f1, f2);
+}
+
+
+void cgmath::CellularNoise::feature_point( int ix, int iy, float *p ) const {
+    const int *perm = perm_of(*this);
+    int h = cell_hash(perm, ix, iy);
+    Jitter j(jitter);
+    p[0] = ix + offset(perm, h, 0, j);
+    p[1] = iy + offset(perm, h, 1, j);
+}
+
+
+void cgmath::CellularNoise::feature_point( int ix, int iy, int iz, float *p ) const {
+    const int *perm = perm_of(*this);
+    int h = cell_hash(perm, ix, iy, iz);
+    Jitter j(jitter);
+    p[0] = ix + offset(perm, h, 0, j);
+    p[1] = iy + offset(perm, h, 1, j);
+    p[2] = iz + offset(perm, h, 2, j);
+}
+
+
+void cgmath::CellularNoise::eval_batch( const float *xs, const float *ys, float *out, size_t n ) const {
+    eval(*this, xs, ys, 0, out, n);
+}
+
+
+void cgmath::CellularNoise::eval_batch( const float *xs, const float *ys, const float *zs,
+                                        float *out, size_t n ) const
+{
+    eval(*this, xs, ys, zs, out, n);
+}
+
+
+void cgmath::CellularNoise::fill( float *dst, int width, int height,
+                                  float x0, float y0, float dx, float dy ) const
+{
+    if (width <= 0) return;
+    parallel_for(height, [&]( int j ) {
+        std::vector<float> xs(width), ys(width, y0 + j * dy);
+        for (int i = 0; i < width; ++i) xs[i] = x0 + i * dx;
+        eval(*this, &xs[0], &ys[0], 0, dst + static_cast<size_t>(j) * width, width);
+    });
+}
+
+
+void cgmath::CellularNoise::fill( float *dst, int width, int height, int depth,
+                                  float x0, float y0, float z0, float dx, float dy, float dz ) const
+{
+    if (width <= 0) return;
+    parallel_for(height * depth, [&]( int r ) {
+        int j = r % height;
+        int k = r / height;
+        std::vector<float> xs(width), ys(width, y0 + j * dy), zs(width, z0 + k * dz);
+        for (int i = 0; i < width; ++i) xs[i] = x0 + i * dx;
+        eval(*this, &xs[0], &ys[0], &zs[0], dst + static_cast<size_t>(r) * width, width);
+    });
+}
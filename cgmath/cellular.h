@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/noise.h>
+#include <cstddef>
+
+namespace cgmath {
+
+    /// Cellular (Worley) noise: distances to the nearest feature points.
+    ///
+    /// Every lattice cell holds one feature point, displaced from the cell
+    /// center by up to jitter / 2 along each axis. The displacement is
+    /// hashed from the cell coordinates with the permutation table of the
+    /// context, like the gradients of noise(), so the pattern repeats
+    /// every 256 units. Only the 3x3 (3x3x3) neighbourhood of the cell
+    /// containing a sample is searched. With the full jitter of 1 a nearer
+    /// point two cells away is missed in rare cases, as in most Worley
+    /// implementations; lower jitter gives more regular cells and makes
+    /// this less likely. Results are distances in lattice units.
+    ///
+    /// The batch and fill functions hash a neighbourhood once and reuse it
+    /// for all following samples in the same cell, and a step to the next
+    /// cell in x only hashes the new column of cells. Sampling a grid with
+    /// a few samples per cell therefore costs less than two noise() calls.
+    class CellularNoise {
+    public:
+        enum Type {
+            F1,             ///< distance to the nearest feature point
+            F2,             ///< distance to the second nearest feature point
+            F2_MINUS_F1     ///< F2 - F1, zero along the cell borders
+        };
+
+        enum Metric {
+            EUCLIDEAN,
+            MANHATTAN,      ///< sum of the absolute coordinate differences
+            CHEBYSHEV       ///< maximum of the absolute coordinate differences
+        };
+
+        CellularNoise( Type t = F1, Metric m = EUCLIDEAN, float j = 1 )
+            : type(t), metric(m), jitter(j), context(0) { }
+
+        float operator()( float x, float y ) const;
+        float operator()( float x, float y, float z ) const;
+
+        /// F1 and F2 at once
+        void distances( float x, float y, float *f1, float *f2 ) const;
+        void distances( float x, float y, float z, float *f1, float *f2 ) const;
+
+        /// Feature point of cell (ix,iy) or (ix,iy,iz) in lattice coordinates
+        void feature_point( int ix, int iy, float *p ) const;
+        void feature_point( int ix, int iy, int iz, float *p ) const;
+
+        /// out[i] = (*this)(xs[i], ys[i], ...)
+        void eval_batch( const float *xs, const float *ys, float *out, size_t n ) const;
+        void eval_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const;
+
+        /// Fills a width x height row-major image, sampling pixel (i,j) at
+        /// (x0 + i * dx, y0 + j * dy). Rows are computed in parallel.
+        void fill( float *dst, int width, int height,
+                   float x0, float y0, float dx, float dy ) const;
+
+        /// Fills a width x height x depth volume (x fastest), sampling voxel
+        /// (i,j,k) at (x0 + i * dx, y0 + j * dy, z0 + k * dz).
+        void fill( float *dst, int width, int height, int depth,
+                   float x0, float y0, float z0, float dx, float dy, float dz ) const;
+
+        Type type;
+        Metric metric;
+        float jitter;   ///< displacement of the feature points, 0 (cell centers) to 1
+        const NoiseContext *context;    ///< permutation to hash cells with (0 = default_noise_context())
+    };
+
+}
@@ -0,0 +1,267 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/clipmap.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
+
+
+namespace {
+
+    typedef std::tuple<int, int, int> Key;     // level, i, j
+
+}
+
+
+// State shared with the queued tasks. Tasks keep it alive after the
+// clipmap is gone and then return without generating anything; the
+// destructor only waits for the tiles that are being generated.
+struct cgmath::NoiseClipmap::State {
+    State( const FractalNoise& f, int l, int t, int r, float s, size_t c, ThreadPool& p )
+        : fractal(f), levels(l), tile_size(t), radius(r), spacing(s), capacity(c), pool(p),
+          center(4 * l, 0), centered(false), closed(false), running(0) {}
+
+    float cell( int level ) const {
+        return std::ldexp(spacing, level) * tile_size;
+    }
+
+    // Tiles within radius of the viewer or the predicted viewer
+    bool wanted( const Key& k ) const {
+        if (!centered) return true;
+        int l = std::get<0>(k);
+        for (int p = 0; p < 2; ++p) {
+            const int *c = &center[(p * levels + l) * 2];
+            if ((std::abs(std::get<1>(k) - c[0]) <= radius) && (std::abs(std::get<2>(k) - c[1]) <= radius)) return true;
+        }
+        return false;
+    }
+
+    TilePtr generate( const Key& k ) const {
+        Tile *t = new Tile;
+        t->level = std::get<0>(k);
+        t->i = std::get<1>(k);
+        t->j = std::get<2>(k);
+        t->size = tile_size + 1;
+        t->spacing = std::ldexp(spacing, t->level);
+        t->x0 = static_cast<float>(static_cast<double>(t->i) * cell(t->level));
+        t->y0 = static_cast<float>(static_cast<double>(t->j) * cell(t->level));
+        t->heights.resize(static_cast<size_t>(t->size) * t->size);
+        fractal.fill(&t->heights[0], t->size, t->size, t->x0, t->y0, t->spacing, t->spacing);
+        return TilePtr(t);
+    }
+
+    // Moves a cached tile to the front of the LRU list, the mutex held
+    TilePtr touch( const Key& k ) {
+        std::map<Key, Entry>::iterator it = cache.find(k);
+        if (it == cache.end()) return TilePtr();
+        lru.splice(lru.begin(), lru, it->second.pos);
+        return it->second.tile;
+    }
+
+    // Caches a finished tile, evicting the least recently used ones
+    void insert( const Key& k, const TilePtr& t ) {
+        if (cache.count(k)) return;
+        lru.push_front(k);
+        Entry e = { t, lru.begin() };
+        cache[k] = e;
+        while (cache.size() > capacity) {
+            cache.erase(lru.back());
+            lru.pop_back();
+        }
+    }
+
+    struct Entry {
+        TilePtr tile;
+        std::list<Key>::iterator pos;
+    };
+
+    const FractalNoise fractal;
+    const int levels;
+    const int tile_size;
+    const int radius;
+    const float spacing;
+    const size_t capacity;
+    ThreadPool& pool;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    std::list<Key> lru;                 // most recently used first
+    std::map<Key, Entry> cache;
+    std::set<Key> queued;
+    std::vector<TilePtr> ready;
+    std::vector<int> center;            // viewer tile per level, current and predicted
+    bool centered;
+    bool closed;
+    int running;
+};
+
+
+namespace {
+
+    typedef cgmath::NoiseClipmap::TilePtr TilePtr;
+
+    template <typename S> void run( const std::shared_ptr<S>& s, const Key& k ) {
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            if (s->closed || !s->wanted(k)) {
+                s->queued.erase(k);
+                s->done.notify_all();
+                return;
+            }
+            ++s->running;
+        }
+
+        TilePtr t = s->generate(k);
+
+        std::lock_guard<std::mutex> lock(s->mutex);
+        --s->running;
+        s->queued.erase(k);
+        s->insert(k, t);
+        // tiles nobody polls for are not kept twice
+        if (s->ready.size() >= s->capacity) s->ready.erase(s->ready.begin());
+        s->ready.push_back(t);
+        s->done.notify_all();
+    }
+
+}
+
+
+cgmath::NoiseClipmap::NoiseClipmap( const FractalNoise& f, int levels, int tile_size, int radius,
+                                    float spacing, size_t capacity, ThreadPool& pool )
+    : lookahead(8), max_requests(0)
+{
+    levels = std::max(levels, 1);
+    radius = std::max(radius, 0);
+    if (capacity == 0) capacity = 2 * static_cast<size_t>(levels) * (2 * radius + 1) * (2 * radius + 1);
+    m_state = std::make_shared<State>(f, levels, std::max(tile_size, 1), radius, spacing, capacity, pool);
+}
+
+
+cgmath::NoiseClipmap::~NoiseClipmap() {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->closed = true;
+    while (m_state->running > 0) m_state->done.wait(lock);
+}
+
+
+void cgmath::NoiseClipmap::tile_index( int level, float x, float y, int *i, int *j ) const {
+    float c = m_state->cell(level);
+    *i = static_cast<int>(std::floor(x / c));
+    *j = static_cast<int>(std::floor(y / c));
+}
+
+
+void cgmath::NoiseClipmap::update( float x, float y, float vx, float vy ) {
+    State& s = *m_state;
+    bool predict = (lookahead > 0) && ((vx != 0) || (vy != 0));
+    float px = x + vx * lookahead;
+    float py = y + vy * lookahead;
+
+    std::vector<Key> missing;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (int l = 0; l < s.levels; ++l) {
+            int *c = &s.center[2 * l];
+            int *p = &s.center[2 * (s.levels + l)];
+            tile_index(l, x, y, &c[0], &c[1]);
+            if (predict) tile_index(l, px, py, &p[0], &p[1]); else { p[0] = c[0]; p[1] = c[1]; }
+        }
+        s.centered = true;
+
+        // current tiles, then the predicted ones; coarse levels first and
+        // rings of growing distance within a level
+        for (int pass = 0; pass < (predict? 2 : 1); ++pass) {
+            for (int l = s.levels - 1; l >= 0; --l) {
+                const int *c = &s.center[2 * (pass * s.levels + l)];
+                for (int r = 0; r <= s.radius; ++r) {
+                    for (int dj = -r; dj <= r; ++dj) {
+                        for (int di = -r; di <= r; ++di) {
+                            if ((std::abs(di) != r) && (std::abs(dj) != r)) continue;
+                            Key k(l, c[0] + di, c[1] + dj);
+                            if (s.touch(k) || s.queued.count(k)) continue;
+                            if (std::find(missing.begin(), missing.end(), k) != missing.end()) continue;
+                            missing.push_back(k);
+                        }
+                    }
+                }
+            }
+        }
+
+        if ((max_requests > 0) && (missing.size() > static_cast<size_t>(max_requests))) missing.resize(max_requests);
+        for (size_t i = 0; i < missing.size(); ++i) s.queued.insert(missing[i]);
+    }
+
+    for (size_t i = 0; i < missing.size(); ++i) {
+        std::shared_ptr<State> state = m_state;
+        Key k = missing[i];
+        s.pool.submit([state, k]() { run(state, k); });
+    }
+}
+
+
+cgmath::NoiseClipmap::TilePtr cgmath::NoiseClipmap::tile( int level, int i, int j ) const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->touch(Key(level, i, j));
+}
+
+
+cgmath::NoiseClipmap::TilePtr cgmath::NoiseClipmap::wait( int level, int i, int j ) {
+    State& s = *m_state;
+    Key k(level, i, j);
+    {
+        std::unique_lock<std::mutex> lock(s.mutex);
+        for (;;) {
+            TilePtr t = s.touch(k);
+            if (t) return t;
+            if (!s.queued.count(k)) break;
+            s.done.wait(lock);
+        }
+    }
+
+    TilePtr t = s.generate(k);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.insert(k, t);
+    return t;
+}
+
+
+size_t cgmath::NoiseClipmap::poll( std::vector<TilePtr>& ready ) {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    size_t n = m_state->ready.size();
+    ready.insert(ready.end(), m_state->ready.begin(), m_state->ready.end());
+    m_state->ready.clear();
+    return n;
+}
+
+
+size_t cgmath::NoiseClipmap::pending() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->queued.size();
+}
+
+
+size_t cgmath::NoiseClipmap::cached() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->cache.size();
+}
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/fractal.h>
+#include <cgmath/parallel.h>
+#include <memory>
+#include <vector>
+
+namespace cgmath {
+
+    /// Level of detail tiles of a fractal heightfield around a moving
+    /// viewer, generated in the background.
+    ///
+    /// Level l samples the fractal every spacing * 2^l units, in tiles of
+    /// tile_size x tile_size cells. A tile stores (tile_size + 1)^2 samples,
+    /// so neighbouring tiles share their border samples. update() requests
+    /// the tiles within radius tiles of the viewer at every level, coarse
+    /// levels first, followed by the tiles around the position predicted
+    /// from the viewer velocity, and queues the missing ones on a thread
+    /// pool. Finished tiles are kept in a cache of at most capacity tiles,
+    /// least recently used first out, and are handed out by tile(), wait()
+    /// and poll(). Queued tiles that have left the requested area by the
+    /// time a worker gets to them are dropped.
+    ///
+    /// The fractal's noise context and the pool have to outlive the
+    /// clipmap. All member functions may be called from any thread.
+    class NoiseClipmap {
+    public:
+        struct Tile {
+            int level;
+            int i, j;               ///< tile index, covering cells i * tile_size .. (i + 1) * tile_size in x
+            int size;               ///< samples per side, tile_size + 1
+            float x0, y0;           ///< position of sample (0,0)
+            float spacing;          ///< distance between samples
+            std::vector<float> heights;     ///< size x size samples, row-major
+        };
+
+        typedef std::shared_ptr<const Tile> TilePtr;
+
+        /// A capacity of 0 keeps twice the tiles requested by an update.
+        NoiseClipmap( const FractalNoise& f, int levels = 6, int tile_size = 64, int radius = 2,
+                      float spacing = 1, size_t capacity = 0, ThreadPool& pool = ThreadPool::global() );
+        ~NoiseClipmap();
+
+        /// Moves the viewer to (x, y), travelling (vx, vy) per update, and
+        /// queues up to max_requests missing tiles (0 = no limit).
+        void update( float x, float y, float vx = 0, float vy = 0 );
+
+        /// Cached tile, or 0 if it has not been generated yet
+        TilePtr tile( int level, int i, int j ) const;
+
+        /// Waits for a queued tile, or generates it on the calling thread
+        TilePtr wait( int level, int i, int j );
+
+        /// Appends the tiles finished since the last call to ready and
+        /// returns their number
+        size_t poll( std::vector<TilePtr>& ready );
+
+        /// Index of the tile containing (x, y) at level
+        void tile_index( int level, float x, float y, int *i, int *j ) const;
+
+        size_t pending() const;
+        size_t cached() const;
+
+        int lookahead;          ///< updates to predict the viewer ahead for prefetching (8, 0 = none)
+        int max_requests;       ///< tiles queued per update at most (0 = all missing)
+
+    private:
+        NoiseClipmap( const NoiseClipmap& );
+        NoiseClipmap& operator=( const NoiseClipmap& );
+
+        struct State;
+        std::shared_ptr<State> m_state;
+    };
+
+}
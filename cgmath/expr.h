@@ -0,0 +1,358 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/vec2.h>
+#include <cgmath/vec3.h>
+#include <cgmath/vec4.h>
+#include <cgmath/mat33.h>
+#include <cgmath/mat44.h>
+
+namespace cgmath {
+
+    //
+    // Opt-in expression templates. lazy() wraps a vector or matrix, and
+    // arithmetic on the wrapper builds an expression that is evaluated in
+    // one pass when it is assigned to a vector or matrix:
+    //
+    //     Vec3f r = lazy(a) * s + lazy(b) * t - c;
+    //     Mat44f M = lazy(A) * B * C;
+    //
+    // Vector expressions compute every component straight from the
+    // operands. Matrix expressions are evaluated row by row, so a chain of
+    // products keeps a single row in flight and never stores a full
+    // intermediate matrix; only a product whose right operand is itself an
+    // expression evaluates that operand once. Every component is computed
+    // by the same operations, in the same order, as the plain operators,
+    // so the results are identical. Expressions reference their operands
+    // and must be evaluated within the statement that builds them.
+    //
+
+    /// Base of the vector expressions, V being the resulting vector type
+    template <typename E, typename V> struct VecExpr {
+        typedef V vector_type;
+        typedef typename V::value_type value_type;
+        enum { dim = V::dim };
+
+        const E& self() const {
+            return static_cast<const E&>(*this);
+        }
+
+        value_type operator[]( int i ) const {
+            return self()[i];
+        }
+
+        operator V() const {
+            V r;
+            for (int i = 0; i < dim; ++i) r[i] = self()[i];
+            return r;
+        }
+    };
+
+
+    template <typename V> class VecLeaf : public VecExpr<VecLeaf<V>, V> {
+    public:
+        explicit VecLeaf( const V& v ) : m_v(v) {}
+        typename V::value_type operator[]( int i ) const { return m_v[i]; }
+    private:
+        const V& m_v;
+    };
+
+
+    template <typename A, typename B, typename V> class VecSum : public VecExpr<VecSum<A, B, V>, V> {
+    public:
+        VecSum( const A& a, const B& b ) : m_a(a), m_b(b) {}
+        typename V::value_type operator[]( int i ) const { return m_a[i] + m_b[i]; }
+    private:
+        A m_a;
+        B m_b;
+    };
+
+
+    template <typename A, typename B, typename V> class VecDiff : public VecExpr<VecDiff<A, B, V>, V> {
+    public:
+        VecDiff( const A& a, const B& b ) : m_a(a), m_b(b) {}
+        typename V::value_type operator[]( int i ) const { return m_a[i] - m_b[i]; }
+    private:
+        A m_a;
+        B m_b;
+    };
+
+
+    template <typename A, typename V> class VecNeg : public VecExpr<VecNeg<A, V>, V> {
+    public:
+        explicit VecNeg( const A& a ) : m_a(a) {}
+        typename V::value_type operator[]( int i ) const { return -m_a[i]; }
+    private:
+        A m_a;
+    };
+
+
+    /// a * k, and a / d like the vector operators: Vec2 divides, Vec3
+    /// and Vec4 multiply with the reciprocal
+    template <typename A, typename V> class VecScale : public VecExpr<VecScale<A, V>, V> {
+    public:
+        typedef typename V::value_type T;
+        VecScale( const A& a, T k, bool divide ) : m_a(a), m_k(k), m_divide(divide) {}
+        T operator[]( int i ) const { return m_divide? m_a[i] / m_k : m_a[i] * m_k; }
+    private:
+        A m_a;
+        T m_k;
+        bool m_divide;
+    };
+
+
+    template <typename T> VecLeaf<Vec2<T> > lazy( const Vec2<T>& v ) {
+        return VecLeaf<Vec2<T> >(v);
+    }
+
+    template <typename T> VecLeaf<Vec3<T> > lazy( const Vec3<T>& v ) {
+        return VecLeaf<Vec3<T> >(v);
+    }
+
+    template <typename T> VecLeaf<Vec4<T> > lazy( const Vec4<T>& v ) {
+        return VecLeaf<Vec4<T> >(v);
+    }
+
+    template <typename A, typename B, typename V>
+    VecSum<A, B, V> operator+( const VecExpr<A, V>& a, const VecExpr<B, V>& b ) {
+        return VecSum<A, B, V>(a.self(), b.self());
+    }
+
+    template <typename A, typename V>
+    VecSum<A, VecLeaf<V>, V> operator+( const VecExpr<A, V>& a, const V& b ) {
+        return VecSum<A, VecLeaf<V>, V>(a.self(), VecLeaf<V>(b));
+    }
+
+    template <typename B, typename V>
+    VecSum<VecLeaf<V>, B, V> operator+( const V& a, const VecExpr<B, V>& b ) {
+        return VecSum<VecLeaf<V>, B, V>(VecLeaf<V>(a), b.self());
+    }
+
+    template <typename A, typename B, typename V>
+    VecDiff<A, B, V> operator-( const VecExpr<A, V>& a, const VecExpr<B, V>& b ) {
+        return VecDiff<A, B, V>(a.self(), b.self());
+    }
+
+    template <typename A, typename V>
+    VecDiff<A, VecLeaf<V>, V> operator-( const VecExpr<A, V>& a, const V& b ) {
+        return VecDiff<A, VecLeaf<V>, V>(a.self(), VecLeaf<V>(b));
+    }
+
+    template <typename B, typename V>
+    VecDiff<VecLeaf<V>, B, V> operator-( const V& a, const VecExpr<B, V>& b ) {
+        return VecDiff<VecLeaf<V>, B, V>(VecLeaf<V>(a), b.self());
+    }
+
+    template <typename A, typename V> VecNeg<A, V> operator-( const VecExpr<A, V>& a ) {
+        return VecNeg<A, V>(a.self());
+    }
+
+    template <typename A, typename V>
+    VecScale<A, V> operator*( const VecExpr<A, V>& a, typename V::value_type k ) {
+        return VecScale<A, V>(a.self(), k, false);
+    }
+
+    template <typename A, typename V>
+    VecScale<A, V> operator*( typename V::value_type k, const VecExpr<A, V>& a ) {
+        return VecScale<A, V>(a.self(), k, false);
+    }
+
+    template <typename A, typename V>
+    VecScale<A, V> operator/( const VecExpr<A, V>& a, typename V::value_type d ) {
+        return (V::dim == 2)? VecScale<A, V>(a.self(), d, true) : VecScale<A, V>(a.self(), 1 / d, false);
+    }
+
+    template <typename A, typename B, typename V>
+    typename V::value_type dot( const VecExpr<A, V>& a, const VecExpr<B, V>& b ) {
+        typename V::value_type s = a[0] * b[0];
+        for (int i = 1; i < V::dim; ++i) s += a[i] * b[i];
+        return s;
+    }
+
+
+    template <typename M> struct MatTraits;
+    template <typename T> struct MatTraits<Mat33<T> > { enum { dim = 3 }; };
+    template <typename T> struct MatTraits<Mat44<T> > { enum { dim = 4 }; };
+
+    /// Base of the matrix expressions, M being the resulting matrix type.
+    /// Expressions compute a row at a time.
+    template <typename E, typename M> struct MatExpr {
+        typedef M matrix_type;
+        typedef typename M::value_type value_type;
+        enum { dim = MatTraits<M>::dim };
+
+        const E& self() const {
+            return static_cast<const E&>(*this);
+        }
+
+        void row( int i, value_type *r ) const {
+            self().row(i, r);
+        }
+
+        M eval() const {
+            M r;
+            for (int i = 0; i < dim; ++i) self().row(i, r[i]);
+            return r;
+        }
+
+        operator M() const {
+            return eval();
+        }
+    };
+
+
+    template <typename M> class MatLeaf : public MatExpr<MatLeaf<M>, M> {
+    public:
+        explicit MatLeaf( const M& m ) : m_m(m) {}
+        void row( int i, typename M::value_type *r ) const {
+            for (int j = 0; j < MatTraits<M>::dim; ++j) r[j] = m_m[i][j];
+        }
+        const M& eval() const { return m_m; }
+    private:
+        const M& m_m;
+    };
+
+
+    /// Right operands of products: leaves by reference, others evaluated
+    template <typename E> struct MatOperand { typedef typename E::matrix_type type; };
+    template <typename M> struct MatOperand<MatLeaf<M> > { typedef const M& type; };
+
+
+    template <typename A, typename B, typename M> class MatProduct : public MatExpr<MatProduct<A, B, M>, M> {
+    public:
+        typedef typename M::value_type T;
+        MatProduct( const A& a, const B& b ) : m_a(a), m_b(b.eval()) {}
+        void row( int i, T *r ) const {
+            const int n = MatTraits<M>::dim;
+            T a[n];
+            m_a.row(i, a);
+            for (int j = 0; j < n; ++j) {
+                T s = a[0] * m_b[0][j];
+                for (int k = 1; k < n; ++k) s += a[k] * m_b[k][j];
+                r[j] = s;
+            }
+        }
+    private:
+        A m_a;
+        typename MatOperand<B>::type m_b;
+    };
+
+
+    /// Element-wise a + s * b, with s = 1 or -1 picking sum or difference
+    template <typename A, typename B, typename M> class MatSum : public MatExpr<MatSum<A, B, M>, M> {
+    public:
+        typedef typename M::value_type T;
+        MatSum( const A& a, const B& b, bool subtract ) : m_a(a), m_b(b), m_subtract(subtract) {}
+        void row( int i, T *r ) const {
+            const int n = MatTraits<M>::dim;
+            T b[n];
+            m_a.row(i, r);
+            m_b.row(i, b);
+            for (int j = 0; j < n; ++j) r[j] = m_subtract? r[j] - b[j] : r[j] + b[j];
+        }
+    private:
+        A m_a;
+        B m_b;
+        bool m_subtract;
+    };
+
+
+    /// a * k; negation scales by -1 like Mat33::operator-()
+    template <typename A, typename M> class MatScale : public MatExpr<MatScale<A, M>, M> {
+    public:
+        typedef typename M::value_type T;
+        MatScale( const A& a, T k ) : m_a(a), m_k(k) {}
+        void row( int i, T *r ) const {
+            m_a.row(i, r);
+            for (int j = 0; j < MatTraits<M>::dim; ++j) r[j] *= m_k;
+        }
+    private:
+        A m_a;
+        T m_k;
+    };
+
+
+    template <typename T> MatLeaf<Mat33<T> > lazy( const Mat33<T>& m ) {
+        return MatLeaf<Mat33<T> >(m);
+    }
+
+    template <typename T> MatLeaf<Mat44<T> > lazy( const Mat44<T>& m ) {
+        return MatLeaf<Mat44<T> >(m);
+    }
+
+    template <typename A, typename B, typename M>
+    MatProduct<A, B, M> operator*( const MatExpr<A, M>& a, const MatExpr<B, M>& b ) {
+        return MatProduct<A, B, M>(a.self(), b.self());
+    }
+
+    template <typename A, typename M>
+    MatProduct<A, MatLeaf<M>, M> operator*( const MatExpr<A, M>& a, const M& b ) {
+        return MatProduct<A, MatLeaf<M>, M>(a.self(), MatLeaf<M>(b));
+    }
+
+    template <typename B, typename M>
+    MatProduct<MatLeaf<M>, B, M> operator*( const M& a, const MatExpr<B, M>& b ) {
+        return MatProduct<MatLeaf<M>, B, M>(MatLeaf<M>(a), b.self());
+    }
+
+    template <typename A, typename B, typename M>
+    MatSum<A, B, M> operator+( const MatExpr<A, M>& a, const MatExpr<B, M>& b ) {
+        return MatSum<A, B, M>(a.self(), b.self(), false);
+    }
+
+    template <typename A, typename M>
+    MatSum<A, MatLeaf<M>, M> operator+( const MatExpr<A, M>& a, const M& b ) {
+        return MatSum<A, MatLeaf<M>, M>(a.self(), MatLeaf<M>(b), false);
+    }
+
+    template <typename B, typename M>
+    MatSum<MatLeaf<M>, B, M> operator+( const M& a, const MatExpr<B, M>& b ) {
+        return MatSum<MatLeaf<M>, B, M>(MatLeaf<M>(a), b.self(), false);
+    }
+
+    template <typename A, typename B, typename M>
+    MatSum<A, B, M> operator-( const MatExpr<A, M>& a, const MatExpr<B, M>& b ) {
+        return MatSum<A, B, M>(a.self(), b.self(), true);
+    }
+
+    template <typename A, typename M>
+    MatSum<A, MatLeaf<M>, M> operator-( const MatExpr<A, M>& a, const M& b ) {
+        return MatSum<A, MatLeaf<M>, M>(a.self(), MatLeaf<M>(b), true);
+    }
+
+    template <typename B, typename M>
+    MatSum<MatLeaf<M>, B, M> operator-( const M& a, const MatExpr<B, M>& b ) {
+        return MatSum<MatLeaf<M>, B, M>(MatLeaf<M>(a), b.self(), true);
+    }
+
+    template <typename A, typename M> MatScale<A, M> operator-( const MatExpr<A, M>& a ) {
+        return MatScale<A, M>(a.self(), -1);
+    }
+
+    template <typename A, typename M>
+    MatScale<A, M> operator*( const MatExpr<A, M>& a, typename M::value_type k ) {
+        return MatScale<A, M>(a.self(), k);
+    }
+
+    template <typename A, typename M>
+    MatScale<A, M> operator*( typename M::value_type k, const MatExpr<A, M>& a ) {
+        return MatScale<A, M>(a.self(), k);
+    }
+
+}
@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#if !defined(CGMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define CGMATH_FAST_SSE
+#include <emmintrin.h>
+#endif
+
+#include <cgmath/vec2.h>
+#include <cgmath/vec3.h>
+#include <cgmath/vec4.h>
+#include <cgmath/vec_array.h>
+#include <cfloat>
+#include <cmath>
+
+namespace cgmath {
+
+    //
+    // Approximate length, distance and normalize for float vectors, built
+    // on the hardware reciprocal square root estimate refined by one
+    // Newton step. rsqrt() is within 4 ulp of 1/sqrt (relative error below
+    // 3e-7) for all normal floats; length(), distance() and normalize()
+    // add the rounding of the dot product and stay within about 8 ulp, or
+    // 1e-6 relative error. Results differ from the exact functions of
+    // vec2.h, vec3.h and vec4.h in the last bits and may differ between
+    // CPUs. Without SSE2, or if CGMATH_NO_SIMD is defined, the estimate is
+    // computed as 1/sqrt and the functions are as accurate as the exact
+    // ones.
+    //
+    // length() and distance() are 0 for zero vectors, normalize() of a
+    // zero vector is NaN like the exact version. Squared lengths below
+    // FLT_MIN (vectors shorter than about 1e-19) lose accuracy.
+    //
+    namespace fast {
+
+        /// Hardware estimate of 1/sqrt(x), good to about 12 bits
+        inline float rsqrt_estimate( float x ) {
+        #ifdef CGMATH_FAST_SSE
+            return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+        #else
+            return 1 / std::sqrt(x);
+        #endif
+        }
+
+        /// One Newton step for 1/sqrt(x) from the estimate y
+        inline float rsqrt_refine( float x, float y ) {
+            return y * (1.5f - 0.5f * x * y * y);
+        }
+
+        inline float rsqrt( float x ) {
+            return rsqrt_refine(x, rsqrt_estimate(x));
+        }
+
+        /// x * rsqrt(x), 0 for x = 0
+        inline float sqrt( float x ) {
+            return x * rsqrt((FLT_MIN < x)? x : FLT_MIN);
+        }
+
+        inline float length( const Vec2f& v ) { return fast::sqrt(dot(v, v)); }
+        inline float length( const Vec3f& v ) { return fast::sqrt(dot(v, v)); }
+        inline float length( const Vec4f& v ) { return fast::sqrt(dot(v, v)); }
+
+        inline float distance( const Vec2f& a, const Vec2f& b ) { return fast::length(a - b); }
+        inline float distance( const Vec3f& a, const Vec3f& b ) { return fast::length(a - b); }
+        inline float distance( const Vec4f& a, const Vec4f& b ) { return fast::length(a - b); }
+
+        inline Vec2f normalize( const Vec2f& v ) { return v * rsqrt(dot(v, v)); }
+        inline Vec3f normalize( const Vec3f& v ) { return v * rsqrt(dot(v, v)); }
+        inline Vec4f normalize( const Vec4f& v ) { return v * rsqrt(dot(v, v)); }
+
+        /// Batched versions, same conventions as the exact ones in
+        /// vec_array.h. Every element gives the same result as the single
+        /// vector function above.
+        void length( const Vec2Array& a, float *out );
+        void distance( const Vec2Array& a, const Vec2Array& b, float *out );
+        void normalize( const Vec2Array& a, Vec2Array& out );
+
+        void length( const Vec3Array& a, float *out );
+        void distance( const Vec3Array& a, const Vec3Array& b, float *out );
+        void normalize( const Vec3Array& a, Vec3Array& out );
+
+        void length( const Vec4Array& a, float *out );
+        void distance( const Vec4Array& a, const Vec4Array& b, float *out );
+        void normalize( const Vec4Array& a, Vec4Array& out );
+
+    }
+
+}
@@ -0,0 +1,327 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/fractal.h>
+#include <cgmath/parallel.h>
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+    using cgmath::FractalNoise;
+
+    // Samples per row segment. A 64x64 tile of output is 16 KB and, together
+    // with the per-row scratch buffers below, stays resident in L1/L2 while
+    // all octaves are accumulated into it.
+    const int TILE = 64;
+
+
+    // Scale of a RIDGED octave's signal into the weight of the next one,
+    // the "gain" of Musgrave's RidgedMultifractal(). It is unrelated to
+    // the amplitude gain of the octaves: 2 makes ridges of full height,
+    // (offset - |noise|)^2 >= 1/2, keep the next octave at full weight.
+    const float RIDGE_WEIGHT = 2;
+
+
+    // Period of an octave. For unset periods, 256 is equivalent to no
+    // period at all with the permutation table, since pnoise() wraps the
+    // lattice to 0..255 anyway, while INTEGER hashing takes 0 for none.
+    inline int octave_period( const cgmath::NoiseContext& ctx, int p, float freq ) {
+        if (p > 0) return std::max(1, static_cast<int>(p * freq + 0.5f));
+        return (ctx.hash() == cgmath::NoiseContext::INTEGER)? 0 : 256;
+    }
+
+
+    void accumulate( const FractalNoise& f, float amp, const float *nv, 
+                     float *sum, float *weight, int m ) 
+    {
+        switch (f.type) {
+            case FractalNoise::FBM:
+                for (int i = 0; i < m; ++i) sum[i] += amp * nv[i];
+                break;
+
+            case FractalNoise::TURBULENCE:
+                for (int i = 0; i < m; ++i) sum[i] += amp * std::fabs(nv[i]);
+                break;
+
+            case FractalNoise::RIDGED:
+                for (int i = 0; i < m; ++i) {
+                    float s = f.offset - std::fabs(nv[i]);
+                    s *= s;
+                    s *= weight[i];
+                    weight[i] = std::min(std::max(RIDGE_WEIGHT * s, 0.0f), 1.0f);
+                    sum[i] += amp * s;
+                }
+                break;
+        }
+    }
+
+
+    // Mean of |noise()| in 2D and 3D, measured over 4M samples
+    const float MEAN_ABS_2 = 0.198f;
+    const float MEAN_ABS_3 = 0.206f;
+
+
+    // Band-limits the noise values of an octave with fade weights a. FBM
+    // sums noise of zero mean, so it is just faded out, while the other
+    // types fade |noise| to its mean value, which they see in the limit.
+    void band_limit( const FractalNoise& f, const float *a, float mean, float *nv, int m ) {
+        if (f.type == FractalNoise::FBM) {
+            for (int i = 0; i < m; ++i) nv[i] *= a[i];
+        } else {
+            for (int i = 0; i < m; ++i) nv[i] = a[i] * std::fabs(nv[i]) + (1 - a[i]) * mean;
+        }
+    }
+
+
+    // Evaluates the fractal at m <= TILE points. zs == 0 selects 2D noise.
+    // With footprints ws, an octave is faded out while the footprint grows
+    // from 1/4 to 5/4 of its lattice spacing, and is not evaluated above.
+    // The band was fit to the box filtered fractal; fading out at the
+    // Nyquist rate already (footprint 1/2) blurs visibly more.
+    void sum_octaves( const FractalNoise& f, const float *xs, const float *ys, const float *zs,
+                      float *out, int m, const float *ws = 0 ) 
+    {
+        float sx[TILE], sy[TILE], sz[TILE], nv[TILE], weight[TILE];
+        float a[TILE] = {};     // fade weights, only computed with footprints
+        const cgmath::NoiseContext& ctx = f.context? *f.context : cgmath::default_noise_context();
+        bool periodic = (f.px > 0) || (f.py > 0) || (f.pz > 0);
+
+        for (int i = 0; i < m; ++i) {
+            out[i] = 0;
+            weight[i] = 1;
+        }
+
+        float freq = 1;
+        float amp = 1;
+        for (int k = 0; k < f.octaves; ++k) {
+            bool visible = true;
+            if (ws) {
+                visible = false;
+                for (int i = 0; i < m; ++i) {
+                    a[i] = std::min(std::max(1.25f - ws[i] * freq, 0.0f), 1.0f);
+                    visible = visible || (a[i] > 0);
+                }
+                // higher octaves are invisible as well
+                if (!visible && (f.type == FractalNoise::FBM)) break;
+            }
+
+            for (int i = 0; i < m; ++i) {
+                sx[i] = xs[i] * freq;
+                sy[i] = ys[i] * freq;
+            }
+            if (!visible) {
+                for (int i = 0; i < m; ++i) nv[i] = 0;
+            } else if (zs) {
+                for (int i = 0; i < m; ++i) sz[i] = zs[i] * freq;
+                if (periodic) {
+                    ctx.pnoise_batch(sx, sy, sz, octave_period(ctx, f.px, freq), octave_period(ctx, f.py, freq), 
+                                     octave_period(ctx, f.pz, freq), nv, m);
+                } else {
+                    ctx.noise_batch(sx, sy, sz, nv, m);
+                }
+            } else {
+                if (periodic) {
+                    ctx.pnoise_batch(sx, sy, octave_period(ctx, f.px, freq), octave_period(ctx, f.py, freq), nv, m);
+                } else {
+                    ctx.noise_batch(sx, sy, nv, m);
+                }
+            }
+
+            if (ws) band_limit(f, a, zs? MEAN_ABS_3 : MEAN_ABS_2, nv, m);
+            accumulate(f, amp, nv, out, weight, m);
+            freq *= f.lacunarity;
+            amp *= f.gain;
+        }
+    }
+
+
+    // Tile rows are summed up in place for float images and in a scratch
+    // row otherwise
+    inline void sum_row( const FractalNoise& f, const float *xs, const float *ys, const float *zs,
+                         float *dst, int m )
+    {
+        sum_octaves(f, xs, ys, zs, dst, m);
+    }
+
+    template <typename T> void sum_row( const FractalNoise& f, const float *xs, const float *ys, const float *zs,
+                                        T *dst, int m )
+    {
+        float r[TILE];
+        sum_octaves(f, xs, ys, zs, r, m);
+        cgmath::to_unorm(r, dst, m);
+    }
+
+
+    template <typename T> void fill_image( const FractalNoise& f, T *dst, int width, int height,
+                                           float x0, float y0, float dx, float dy )
+    {
+        int tx = (width + TILE - 1) / TILE;
+        int ty = (height + TILE - 1) / TILE;
+
+        cgmath::parallel_for(tx * ty, [&]( int t ) {
+            int i0 = (t % tx) * TILE;
+            int j0 = (t / tx) * TILE;
+            int m = std::min(TILE, width - i0);
+            int j1 = std::min(j0 + TILE, height);
+
+            float xs[TILE], ys[TILE];
+            for (int i = 0; i < m; ++i) xs[i] = x0 + (i0 + i) * dx;
+
+            for (int j = j0; j < j1; ++j) {
+                float y = y0 + j * dy;
+                for (int i = 0; i < m; ++i) ys[i] = y;
+                sum_row(f, xs, ys, 0, dst + static_cast<size_t>(j) * width + i0, m);
+            }
+        });
+    }
+
+
+    template <typename T> void fill_volume( const FractalNoise& f, T *dst, int width, int height, int depth,
+                                            float x0, float y0, float z0, float dx, float dy, float dz )
+    {
+        int tx = (width + TILE - 1) / TILE;
+        int ty = (height + TILE - 1) / TILE;
+
+        cgmath::parallel_for(tx * ty * depth, [&]( int t ) {
+            int i0 = (t % tx) * TILE;
+            int j0 = ((t / tx) % ty) * TILE;
+            int k = t / (tx * ty);
+            int m = std::min(TILE, width - i0);
+            int j1 = std::min(j0 + TILE, height);
+
+            float xs[TILE], ys[TILE], zs[TILE];
+            float z = z0 + k * dz;
+            for (int i = 0; i < m; ++i) {
+                xs[i] = x0 + (i0 + i) * dx;
+                zs[i] = z;
+            }
+
+            for (int j = j0; j < j1; ++j) {
+                float y = y0 + j * dy;
+                for (int i = 0; i < m; ++i) ys[i] = y;
+                sum_row(f, xs, ys, zs, dst + (static_cast<size_t>(k) * height + j) * width + i0, m);
+            }
+        });
+    }
+
+}
+
+
+float cgmath::FractalNoise::operator()( float x, float y ) const {
+    float r;
+    sum_octaves(*this, &x, &y, 0, &r, 1);
+    return r;
+}
+
+
+float cgmath::FractalNoise::operator()( float x, float y, float z ) const {
+    float r;
+    sum_octaves(*this, &x, &y, &z, &r, 1);
+    return r;
+}
+
+
+float cgmath::FractalNoise::filtered( float x, float y, float w ) const {
+    float r;
+    sum_octaves(*this, &x, &y, 0, &r, 1, &w);
+    return r;
+}
+
+
+float cgmath::FractalNoise::filtered( float x, float y, float z, float w ) const {
+    float r;
+    sum_octaves(*this, &x, &y, &z, &r, 1, &w);
+    return r;
+}
+
+
+void cgmath::FractalNoise::eval_batch( const float *xs, const float *ys, float *out, size_t n ) const {
+    for (size_t i = 0; i < n; i += TILE) {
+        sum_octaves(*this, xs + i, ys + i, 0, out + i, static_cast<int>(std::min<size_t>(TILE, n - i)));
+    }
+}
+
+
+void cgmath::FractalNoise::eval_batch( const float *xs, const float *ys, const float *zs, 
+                                       float *out, size_t n ) const 
+{
+    for (size_t i = 0; i < n; i += TILE) {
+        sum_octaves(*this, xs + i, ys + i, zs + i, out + i, static_cast<int>(std::min<size_t>(TILE, n - i)));
+    }
+}
+
+
+void cgmath::FractalNoise::filtered_batch( const float *xs, const float *ys, const float *ws, 
+                                           float *out, size_t n ) const 
+{
+    for (size_t i = 0; i < n; i += TILE) {
+        sum_octaves(*this, xs + i, ys + i, 0, out + i, static_cast<int>(std::min<size_t>(TILE, n - i)), ws + i);
+    }
+}
+
+
+void cgmath::FractalNoise::filtered_batch( const float *xs, const float *ys, const float *zs, const float *ws,
+                                           float *out, size_t n ) const 
+{
+    for (size_t i = 0; i < n; i += TILE) {
+        sum_octaves(*this, xs + i, ys + i, zs + i, out + i, static_cast<int>(std::min<size_t>(TILE, n - i)), ws + i);
+    }
+}
+
+
+void cgmath::FractalNoise::fill( float *dst, int width, int height,
+                                 float x0, float y0, float dx, float dy ) const 
+{
+    fill_image(*this, dst, width, height, x0, y0, dx, dy);
+}
+
+
+void cgmath::FractalNoise::fill( float *dst, int width, int height, int depth,
+                                 float x0, float y0, float z0, float dx, float dy, float dz ) const 
+{
+    fill_volume(*this, dst, width, height, depth, x0, y0, z0, dx, dy, dz);
+}
+
+
+void cgmath::FractalNoise::fill( uint8_t *dst, int width, int height,
+                                 float x0, float y0, float dx, float dy ) const 
+{
+    fill_image(*this, dst, width, height, x0, y0, dx, dy);
+}
+
+
+void cgmath::FractalNoise::fill( uint8_t *dst, int width, int height, int depth,
+                                 float x0, float y0, float z0, float dx, float dy, float dz ) const 
+{
+    fill_volume(*this, dst, width, height, depth, x0, y0, z0, dx, dy, dz);
+}
+
+
+void cgmath::FractalNoise::fill( uint16_t *dst, int width, int height,
+                                 float x0, float y0, float dx, float dy ) const 
+{
+    fill_image(*this, dst, width, height, x0, y0, dx, dy);
+}
+
+
+void cgmath::FractalNoise::fill( uint16_t *dst, int width, int height, int depth,
+                                 float x0, float y0, float z0, float dx, float dy, float dz ) const 
+{
+    fill_volume(*this, dst, width, height, depth, x0, y0, z0, dx, dy, dz);
+}
@@ -0,0 +1,98 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/noise.h>
+#include <cstddef>
+
+namespace cgmath {
+
+    /// Fractal sums of octaves of noise(): fBm, turbulence and ridged multifractal.
+    ///
+    /// Octave i is sampled at frequency lacunarity^i and weighted by gain^i.
+    /// If periods are set (px, py, pz > 0), pnoise() is used instead, with
+    /// the period of octave i scaled by lacunarity^i. The result then tiles
+    /// if lacunarity is an integer.
+    class FractalNoise {
+    public:
+        enum Type {
+            FBM,            ///< sum of noise
+            TURBULENCE,     ///< sum of |noise|
+            RIDGED          ///< Musgrave's ridged multifractal, (offset - |noise|)^2 weighted by twice the previous octave's value, clamped to [0,1]
+        };
+
+        FractalNoise( Type t = FBM, int n = 6, float l = 2, float g = 0.5f )
+            : type(t), octaves(n), lacunarity(l), gain(g), offset(1), px(0), py(0), pz(0), context(0) { }
+
+        float operator()( float x, float y ) const;
+        float operator()( float x, float y, float z ) const;
+
+        /// out[i] = (*this)(xs[i], ys[i]), bit-identical to the single point version
+        void eval_batch( const float *xs, const float *ys, float *out, size_t n ) const;
+        void eval_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const;
+
+        /// Anti-aliased version of operator() for a sample footprint of
+        /// width w, e.g. the larger screen space derivative of (x, y).
+        /// Octaves are faded out, and replaced by their mean, as the
+        /// footprint grows from 1/4 to 5/4 of their lattice spacing, which
+        /// approximates the box filtered fractal in one call instead of
+        /// supersampling the pixel. Octaves that are faded out for all
+        /// samples of a batch are not evaluated. w = 0 gives the same
+        /// result as operator().
+        float filtered( float x, float y, float w ) const;
+        float filtered( float x, float y, float z, float w ) const;
+
+        /// out[i] = filtered(xs[i], ys[i], ..., ws[i])
+        void filtered_batch( const float *xs, const float *ys, const float *ws, float *out, size_t n ) const;
+        void filtered_batch( const float *xs, const float *ys, const float *zs, const float *ws,
+                             float *out, size_t n ) const;
+
+        /// Fills a width x height row-major image, sampling pixel (i,j) at
+        /// (x0 + i * dx, y0 + j * dy). The image is split into cache-sized
+        /// tiles that are computed in parallel, all octaves per tile in one pass.
+        void fill( float *dst, int width, int height,
+                   float x0, float y0, float dx, float dy ) const;
+
+        /// Fills a width x height x depth volume (x fastest), sampling voxel
+        /// (i,j,k) at (x0 + i * dx, y0 + j * dy, z0 + k * dz).
+        void fill( float *dst, int width, int height, int depth,
+                   float x0, float y0, float z0, float dx, float dy, float dz ) const;
+
+        /// As above, converting each tile row with to_unorm() as soon as
+        /// its octaves are summed up. Sums outside [-1,1] saturate.
+        void fill( uint8_t *dst, int width, int height,
+                   float x0, float y0, float dx, float dy ) const;
+        void fill( uint16_t *dst, int width, int height,
+                   float x0, float y0, float dx, float dy ) const;
+        void fill( uint8_t *dst, int width, int height, int depth,
+                   float x0, float y0, float z0, float dx, float dy, float dz ) const;
+        void fill( uint16_t *dst, int width, int height, int depth,
+                   float x0, float y0, float z0, float dx, float dy, float dz ) const;
+
+        Type type;
+        int octaves;
+        float lacunarity;
+        float gain;
+        float offset;   ///< ridge offset, used by RIDGED only
+        int px;         ///< period of the first octave in x (0 = not periodic)
+        int py;
+        int pz;
+        const NoiseContext *context;    ///< noise field to sum up (0 = default_noise_context())
+    };
+
+}
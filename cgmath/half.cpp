@@ -0,0 +1,79 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/half.h>
+
+// The vector conversions treat the vectors as plain arrays of components
+static_assert(sizeof(cgmath::Vec2h) == 2 * sizeof(cgmath::Half), "Vec2h is not packed");
+static_assert(sizeof(cgmath::Vec3h) == 3 * sizeof(cgmath::Half), "Vec3h is not packed");
+static_assert(sizeof(cgmath::Vec4h) == 4 * sizeof(cgmath::Half), "Vec4h is not packed");
+static_assert(sizeof(cgmath::Vec3f) == 3 * sizeof(float), "Vec3f is not packed");
+static_assert(sizeof(cgmath::Vec4f) == 4 * sizeof(float), "Vec4f is not packed");
+
+
+void cgmath::convert( const float *src, Half *dst, size_t n ) {
+    size_t i = 0;
+#ifdef CGMATH_F16C
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), 0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+#endif
+    for (; i < n; ++i) dst[i] = Half(src[i]);
+}
+
+
+void cgmath::convert( const Half *src, float *dst, size_t n ) {
+    size_t i = 0;
+#ifdef CGMATH_F16C
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = src[i];
+}
+
+
+void cgmath::convert( const Vec2f *src, Vec2h *dst, size_t n ) {
+    convert(reinterpret_cast<const float*>(src), reinterpret_cast<Half*>(dst), 2 * n);
+}
+
+
+void cgmath::convert( const Vec2h *src, Vec2f *dst, size_t n ) {
+    convert(reinterpret_cast<const Half*>(src), reinterpret_cast<float*>(dst), 2 * n);
+}
+
+
+void cgmath::convert( const Vec3f *src, Vec3h *dst, size_t n ) {
+    convert(reinterpret_cast<const float*>(src), reinterpret_cast<Half*>(dst), 3 * n);
+}
+
+
+void cgmath::convert( const Vec3h *src, Vec3f *dst, size_t n ) {
+    convert(reinterpret_cast<const Half*>(src), reinterpret_cast<float*>(dst), 3 * n);
+}
+
+
+void cgmath::convert( const Vec4f *src, Vec4h *dst, size_t n ) {
+    convert(reinterpret_cast<const float*>(src), reinterpret_cast<Half*>(dst), 4 * n);
+}
+
+
+void cgmath::convert( const Vec4h *src, Vec4f *dst, size_t n ) {
+    convert(reinterpret_cast<const Half*>(src), reinterpret_cast<float*>(dst), 4 * n);
+}
@@ -0,0 +1,138 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#if !defined(CGMATH_NO_SIMD) && (defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define CGMATH_F16C
+#include <immintrin.h>
+#endif
+
+#include <cgmath/types.h>
+#include <cgmath/vec2.h>
+#include <cgmath/vec3.h>
+#include <cgmath/vec4.h>
+#include <cstddef>
+#include <cstring>
+
+namespace cgmath {
+
+    /// float to IEEE 754 binary16 bits, rounding to nearest even. Values
+    /// beyond the half range become infinity, NaNs stay quiet NaNs with
+    /// the top of their payload, like the F16C instructions.
+    inline uint16_t float_to_half( float f ) {
+    #ifdef CGMATH_F16C
+        return static_cast<uint16_t>(_cvtss_sh(f, 0));
+    #else
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        uint32_t sign = (u >> 16) & 0x8000;
+        u &= 0x7fffffff;
+        uint32_t h;
+        if (u >= 0x47800000) {
+            // 2^16 and beyond, infinity or NaN
+            h = (u > 0x7f800000)? 0x7e00 | ((u >> 13) & 0x3ff) : 0x7c00;
+        } else if (u < 0x38800000) {
+            // below 2^-14, the result is subnormal or zero: adding 0.5
+            // aligns the mantissa and rounds it to nearest even
+            float magic = 0.5f;
+            std::memcpy(&f, &u, sizeof(f));
+            f += magic;
+            std::memcpy(&u, &f, sizeof(u));
+            h = u - 0x3f000000;
+        } else {
+            // rebias the exponent and round to nearest even; a carry out of
+            // the mantissa correctly bumps the exponent, up to infinity
+            h = (u + 0xc8000fff + ((u >> 13) & 1)) >> 13;
+        }
+        return static_cast<uint16_t>(h | sign);
+    #endif
+    }
+
+    /// IEEE 754 binary16 bits to float, exact; NaNs become quiet NaNs
+    inline float half_to_float( uint16_t h ) {
+    #ifdef CGMATH_F16C
+        return _cvtsh_ss(h);
+    #else
+        uint32_t u = static_cast<uint32_t>(h & 0x7fff) << 13;
+        uint32_t e = u & 0x0f800000;
+        u += 0x38000000;
+        if (e == 0x0f800000) {
+            // infinity or NaN
+            u += 0x38000000;
+            if (u & 0x007fffff) u |= 0x00400000;
+        } else if (e == 0) {
+            // zero or subnormal, renormalized by subtracting 2^-14
+            float f, magic = 6.103515625e-05f;
+            u += 0x00800000;
+            std::memcpy(&f, &u, sizeof(f));
+            f -= magic;
+            std::memcpy(&u, &f, sizeof(u));
+        }
+        u |= static_cast<uint32_t>(h & 0x8000) << 16;
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+    #endif
+    }
+
+    /// IEEE 754 binary16 storage type. It converts to and from float but
+    /// has no arithmetic of its own: load into float, compute, store back.
+    class Half {
+    public:
+        Half() {}
+
+        explicit Half( float f )
+            : m_bits(float_to_half(f)) {}
+
+        operator float() const {
+            return half_to_float(m_bits);
+        }
+
+        uint16_t bits() const {
+            return m_bits;
+        }
+
+        static Half from_bits( uint16_t bits ) {
+            Half h;
+            h.m_bits = bits;
+            return h;
+        }
+
+    private:
+        uint16_t m_bits;
+    };
+
+    /// Half precision vectors for vertex and point buffers, half the size
+    /// of the float ones. Vec3h(v) and Vec3f(h) convert component-wise.
+    typedef Vec2<Half> Vec2h;
+    typedef Vec3<Half> Vec3h;
+    typedef Vec4<Half> Vec4h;
+
+    /// Bulk conversion of n values or vectors, using F16C if the compiler
+    /// targets it (-mf16c, -march=haswell or later, /arch:AVX2). Gives the
+    /// same results as the scalar conversions.
+    void convert( const float *src, Half *dst, size_t n );
+    void convert( const Half *src, float *dst, size_t n );
+    void convert( const Vec2f *src, Vec2h *dst, size_t n );
+    void convert( const Vec2h *src, Vec2f *dst, size_t n );
+    void convert( const Vec3f *src, Vec3h *dst, size_t n );
+    void convert( const Vec3h *src, Vec3f *dst, size_t n );
+    void convert( const Vec4f *src, Vec4h *dst, size_t n );
+    void convert( const Vec4h *src, Vec4f *dst, size_t n );
+
+}
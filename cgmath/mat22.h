@@ -18,6 +18,8 @@
 #pragma once
 
 #include <cgmath/vec2.h>
+#include <istream>
+#include <ostream>
 
 namespace cgmath {
 
@@ -28,54 +30,54 @@ namespace cgmath {
 
         Mat22() {}
 
-        Mat22(T s) {
+        CGMATH_CONSTEXPR Mat22(T s) : m() {
             m[0][0] = m[1][1] = s;
-            m[0][1] = = m[1][0] = 0;
+            m[0][1] = m[1][0] = 0;
         }
 
-        Mat22(T sx, T sy) {
+        CGMATH_CONSTEXPR Mat22(T sx, T sy) : m() {
             m[0][0] = sx;
             m[1][1] = sy;
             m[0][1] = m[1][0] = 0;
         }
 
-        template <typename U> Mat22(
+        template <typename U> CGMATH_CONSTEXPR Mat22(
             U a00, U a01, 
-            U a10, U a11 ) {
+            U a10, U a11 ) : m() {
             m[0][0] = static_cast<T>(a00); m[0][1] = static_cast<T>(a01); 
             m[1][0] = static_cast<T>(a10); m[1][1] = static_cast<T>(a11); 
         }
 
-        template <typename U> explicit Mat22( const U *src, bool row_major=true ) {
+        template <typename U> CGMATH_CONSTEXPR explicit Mat22( const U *src, bool row_major=true ) : m() {
             set(src, row_major);
         }
 
-        explicit Mat22( const Mat22& A, const Mat22& B ) {
+        CGMATH_CONSTEXPR explicit Mat22( const Mat22& A, const Mat22& B ) : m() {
             for (int i = 0; i < 2; ++i) {
                 m[i][0] =  A.m[i][0] * B.m[0][0] + A.m[i][1] * B.m[1][0];
                 m[i][1] =  A.m[i][0] * B.m[0][1] + A.m[i][1] * B.m[1][1];
             }
         }
 
-        bool operator==(const Mat22& rhs) const {
+        CGMATH_CONSTEXPR bool operator==(const Mat22& rhs) const {
             for (int i = 0; i < 2; ++i) 
                 for (int j = 0; j < 2; ++j) if (m[i][j] != rhs.m[i][j]) return false;
             return true;
         }
 
-        bool operator!=(const Mat22& rhs) const {
+        CGMATH_CONSTEXPR bool operator!=(const Mat22& rhs) const {
             return !this->operator ==(rhs);
         }
 
-        T* operator[]( int row ) {
+        CGMATH_CONSTEXPR T* operator[]( int row ) {
             return m[row];
         }
 
-        const T* operator[]( int row ) const {
+        CGMATH_CONSTEXPR const T* operator[]( int row ) const {
             return m[row];
         }
 
-        template <typename U> void set(const U *src, bool row_major= true) {
+        template <typename U> CGMATH_CONSTEXPR void set(const U *src, bool row_major= true) {
             if (row_major) {
                 for (int i = 0; i < 2; ++i) 
                     for (int j = 0; j < 2; ++j) m[i][j] = static_cast<float>(src[i*2+j]);
@@ -95,75 +97,75 @@ namespace cgmath {
             }
         }
         
-        void set_column( int column, const Vec2<T>& v ) {
+        CGMATH_CONSTEXPR void set_column( int column, const Vec2<T>& v ) {
             m[0][column] = v.x;
             m[1][column] = v.y;
         }
 
-        Vec2<T> get_column( int column ) const {
+        CGMATH_CONSTEXPR Vec2<T> get_column( int column ) const {
             return Vec2<T>(m[0][column], m[1][column]);
         }
 
-        void set_row( int row, const Vec2<T>& v ){
+        CGMATH_CONSTEXPR void set_row( int row, const Vec2<T>& v ){
             m[row][0] = v.x;
             m[row][1] = v.y;
         }
 
-        Vec2<T> get_row( int row ) const {
+        CGMATH_CONSTEXPR Vec2<T> get_row( int row ) const {
             return Vec2<T>(m[row][0], m[row][1]);
         }
 
-        Mat22 operator*( const Mat22& rhs ) const {
+        CGMATH_CONSTEXPR Mat22 operator*( const Mat22& rhs ) const {
             return Mat22(*this, rhs);
         }
 
-        const Mat22& operator*=( const Mat22& rhs ) {
+        CGMATH_CONSTEXPR const Mat22& operator*=( const Mat22& rhs ) {
             return (*this = Mat22(*this, rhs));
         }
 
-        const Mat22& operator*=( T k ) {
+        CGMATH_CONSTEXPR const Mat22& operator*=( T k ) {
             for (int i = 0; i < 2; ++i) 
                 for (int j = 0; j < 2; ++j) m[i][j] *= k; 
             return *this;
         }
 
-        const Mat22& operator+=( const Mat22& rhs ) {
+        CGMATH_CONSTEXPR const Mat22& operator+=( const Mat22& rhs ) {
             for (int i = 0; i < 2; ++i) 
                 for (int j = 0; j < 2; ++j) m[i][j] += rhs.m[i][j]; 
             return *this;
         }
 
-        Mat22 operator+( const Mat22& rhs ) const {
+        CGMATH_CONSTEXPR Mat22 operator+( const Mat22& rhs ) const {
             return Mat22(*this) += rhs;
         }
 
-        const Mat22& operator-=( const Mat22& rhs ) {
+        CGMATH_CONSTEXPR const Mat22& operator-=( const Mat22& rhs ) {
             for (int i = 0; i < 2; ++i) 
                 for (int j = 0; j < 2; ++j) m[i][j] -= rhs.m[i][j]; 
             return *this;
         }
 
-        Mat22 operator-( const Mat22& rhs ) const {
+        CGMATH_CONSTEXPR Mat22 operator-( const Mat22& rhs ) const {
             return Mat22(*this) -= rhs;
         }
 
-        Mat22 operator-() const {
+        CGMATH_CONSTEXPR Mat22 operator-() const {
             return Mat22(*this) *= -1;
         }
 
-        Mat22& zero() {
+        CGMATH_CONSTEXPR Mat22& zero() {
             for (int i = 0; i < 2; ++i) 
                 for (int j = 0; j < 2; ++j) m[i][j] = 0;
             return *this;
         }
 
-        Mat22& identity() {
+        CGMATH_CONSTEXPR Mat22& identity() {
             m[0][0] = m[1][1] = 1;
             m[0][1] = m[1][0] = 0;
             return *this;
         }
 
-        Mat22& scale(T sx, T sy) {
+        CGMATH_CONSTEXPR Mat22& scale(T sx, T sy) {
             for (int i = 0; i < 2; ++i) {
                 m[i][0] *= sx;
                 m[i][1] *= sy;
@@ -175,8 +177,8 @@ namespace cgmath {
         //    return *this;
         //}
 
-        template <typename U> Vec2<U> transform( const Vec2<U>& v ) const {
-            return Vec3<U>(
+        template <typename U> CGMATH_CONSTEXPR Vec2<U> transform( const Vec2<U>& v ) const {
+            return Vec2<U>(
                 static_cast<U>(m[0][0] * v.x + m[0][1] * v.y),
                 static_cast<U>(m[1][0] * v.x + m[1][1] * v.y)
             );
@@ -187,19 +189,19 @@ namespace cgmath {
     };
 
 
-    template <typename T> Mat22<T> operator*( const Mat22<T>& lhs, T k ) {
-        return Mat33<T>(lhs) *= k;
+    template <typename T> CGMATH_CONSTEXPR Mat22<T> operator*( const Mat22<T>& lhs, T k ) {
+        return Mat22<T>(lhs) *= k;
     }
 
-    template <typename T> Mat22<T> operator*( T k, const Mat22<T>& rhs ) {
-        return Mat33<T>(rhs) *= k;
+    template <typename T> CGMATH_CONSTEXPR Mat22<T> operator*( T k, const Mat22<T>& rhs ) {
+        return Mat22<T>(rhs) *= k;
     }
 
-    template <typename T> T det( const Mat22<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR T det( const Mat22<T>& m ) {
         return m[0][0]*m[1][1] - m[0][1]*m[1][0];
     }
 
-    template <typename T> T norm2( const Mat22<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR T norm2( const Mat22<T>& m ) {
         T n2 = 0;
         for (int i = 0; i < 2; ++i) 
             for (int j = 0; j < 2; ++j) n2 += m[i][j] * m[i][j];
@@ -210,7 +212,7 @@ namespace cgmath {
         return sqrt(norm2(m));
     }
 
-    template <typename T> Mat22<T> transpose( const Mat22<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR Mat22<T> transpose( const Mat22<T>& m ) {
         return Mat22<T>( m[0][0], m[1][0],
                          m[0][1], m[1][1] );
     }
@@ -218,6 +220,9 @@ namespace cgmath {
     //template <typename T> bool invert( mat33<T> *m ) {
     //}
 
+    typedef Mat22<float> Mat22f;
+    typedef Mat22<double> Mat22d;
+
     template <typename T> std::ostream& operator<<( std::ostream& os, const Mat22<T>& m ) {
         for (int i = 0; i < 2; ++i) {
             for (int j = 0; j < 2; ++j) {
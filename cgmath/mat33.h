@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cgmath/vec3.h>
+#include <cmath>
 
 namespace cgmath {
 
@@ -28,32 +29,32 @@ namespace cgmath {
 
         Mat33() {}
 
-        Mat33(T s) {
+        CGMATH_CONSTEXPR Mat33(T s) : m() {
             m[0][0] = m[1][1] = m[2][2] = s;
             m[0][1] = m[0][2] = m[1][0] = m[1][2] = m[2][0] = m[2][1] = 0;
         }
 
-        Mat33(T sx, T sy, T sz) {
+        CGMATH_CONSTEXPR Mat33(T sx, T sy, T sz) : m() {
             m[0][0] = sx;
             m[1][1] = sy;
             m[2][2] = sz;
             m[0][1] = m[0][2] = m[1][0] = m[1][2] = m[2][0] = m[2][1] = 0;
         }
 
-        template <typename U> Mat33(
+        template <typename U> CGMATH_CONSTEXPR Mat33(
             U a00, U a01, U a02, 
             U a10, U a11, U a12,
-            U a20, U a21, U a22) {
+            U a20, U a21, U a22) : m() {
             m[0][0] = static_cast<T>(a00); m[0][1] = static_cast<T>(a01); m[0][2] = static_cast<T>(a02);
             m[1][0] = static_cast<T>(a10); m[1][1] = static_cast<T>(a11); m[1][2] = static_cast<T>(a12);
             m[2][0] = static_cast<T>(a20); m[2][1] = static_cast<T>(a21); m[2][2] = static_cast<T>(a22);
         }
 
-        template <typename U> explicit Mat33( const U *src, bool row_major=true ) {
+        template <typename U> CGMATH_CONSTEXPR explicit Mat33( const U *src, bool row_major=true ) : m() {
             set(src, row_major);
         }
 
-        explicit Mat33( const Vec3<T>& a, const Vec3<T>& b, const Vec3<T>& c ) {
+        CGMATH_CONSTEXPR explicit Mat33( const Vec3<T>& a, const Vec3<T>& b, const Vec3<T>& c ) : m() {
             m[0][0] = a.x; m[0][1] = b.x; m[0][2] = c.x;
             m[1][0] = a.y; m[1][1] = b.y; m[1][2] = c.y;
             m[2][0] = a.z; m[2][1] = b.z; m[2][2] = c.z;
@@ -81,7 +82,7 @@ namespace cgmath {
             }
         }
 
-        explicit Mat33( const Mat33& A, const Mat33& B ) {
+        CGMATH_CONSTEXPR explicit Mat33( const Mat33& A, const Mat33& B ) : m() {
             for (int i = 0; i < 3; ++i) {
                 m[i][0] =  A.m[i][0] * B.m[0][0] + A.m[i][1] * B.m[1][0] + A.m[i][2] * B.m[2][0];
                 m[i][1] =  A.m[i][0] * B.m[0][1] + A.m[i][1] * B.m[1][1] + A.m[i][2] * B.m[2][1];
@@ -97,25 +98,25 @@ namespace cgmath {
             }
         }
 
-        bool operator==(const Mat33& rhs) const {
+        CGMATH_CONSTEXPR bool operator==(const Mat33& rhs) const {
             for (int i = 0; i < 3; ++i) 
                 for (int j = 0; j < 3; ++j) if (m[i][j] != rhs.m[i][j]) return false;
             return true;
         }
 
-        bool operator!=(const Mat33& rhs) const {
+        CGMATH_CONSTEXPR bool operator!=(const Mat33& rhs) const {
             return !this->operator ==(rhs);
         }
 
-        T* operator[]( int row ) {
+        CGMATH_CONSTEXPR T* operator[]( int row ) {
             return m[row];
         }
 
-        const T* operator[]( int row ) const {
+        CGMATH_CONSTEXPR const T* operator[]( int row ) const {
             return m[row];
         }
 
-        template <typename U> void set(const U *src, bool row_major= true) {
+        template <typename U> CGMATH_CONSTEXPR void set(const U *src, bool row_major= true) {
             if (row_major) {
                 for (int i = 0; i < 3; ++i) 
                     for (int j = 0; j < 3; ++j) m[i][j] = static_cast<float>(src[i*3+j]);
@@ -135,77 +136,87 @@ namespace cgmath {
             }
         }
         
-        void set_column( int column, const Vec3<T>& v ) {
+        CGMATH_CONSTEXPR void set_column( int column, const Vec3<T>& v ) {
             m[0][column] = v.x;
             m[1][column] = v.y;
             m[2][column] = v.z;
         }
 
-        Vec3<T> get_column( int column ) const {
+        CGMATH_CONSTEXPR Vec3<T> get_column( int column ) const {
             return Vec3<T>(m[0][column], m[1][column], m[2][column]);
         }
 
-        void set_row( int row, const Vec3<T>& v ){
+        CGMATH_CONSTEXPR void set_row( int row, const Vec3<T>& v ){
             m[row][0] = v.x;
             m[row][1] = v.y;
             m[row][2] = v.z;
         }
 
-        Vec3<T> get_row( int row ) const {
+        CGMATH_CONSTEXPR Vec3<T> get_row( int row ) const {
             return Vec3<T>(m[row][0], m[row][1], m[row][2]);
         }
 
-        Mat33 operator*( const Mat33& rhs ) const {
+        CGMATH_CONSTEXPR Mat33 operator*( const Mat33& rhs ) const {
             return Mat33(*this, rhs);
         }
 
-        const Mat33& operator*=( const Mat33& rhs ) {
-            return (*this = Mat33(*this, rhs));
+        // Row i of the product only depends on row i of *this, so the
+        // rows are replaced one at a time
+        CGMATH_CONSTEXPR const Mat33& operator*=( const Mat33& rhs ) {
+            if (&rhs == this) return (*this = Mat33(*this, rhs));
+            for (int i = 0; i < 3; ++i) {
+                T r[3];
+                for (int j = 0; j < 3; ++j) {
+                    r[j] = m[i][0] * rhs.m[0][j] + m[i][1] * rhs.m[1][j] + m[i][2] * rhs.m[2][j];
+                }
+                for (int j = 0; j < 3; ++j) m[i][j] = r[j];
+            }
+            return *this;
         }
 
-        const Mat33& operator*=( T k ) {
+        CGMATH_CONSTEXPR const Mat33& operator*=( T k ) {
             for (int i = 0; i < 3; ++i) 
                 for (int j = 0; j < 3; ++j) m[i][j] *= k; 
             return *this;
         }
 
-        const Mat33& operator+=( const Mat33& rhs ) {
+        CGMATH_CONSTEXPR const Mat33& operator+=( const Mat33& rhs ) {
             for (int i = 0; i < 3; ++i) 
                 for (int j = 0; j < 3; ++j) m[i][j] += rhs.m[i][j]; 
             return *this;
         }
 
-        Mat33 operator+( const Mat33& rhs ) const {
+        CGMATH_CONSTEXPR Mat33 operator+( const Mat33& rhs ) const {
             return Mat33(*this) += rhs;
         }
 
-        const Mat33& operator-=( const Mat33& rhs ) {
+        CGMATH_CONSTEXPR const Mat33& operator-=( const Mat33& rhs ) {
             for (int i = 0; i < 3; ++i) 
                 for (int j = 0; j < 3; ++j) m[i][j] -= rhs.m[i][j]; 
             return *this;
         }
 
-        Mat33 operator-( const Mat33& rhs ) const {
+        CGMATH_CONSTEXPR Mat33 operator-( const Mat33& rhs ) const {
             return Mat33(*this) -= rhs;
         }
 
-        Mat33 operator-() const {
+        CGMATH_CONSTEXPR Mat33 operator-() const {
             return Mat33(*this) *= -1;
         }
 
-        Mat33& zero() {
+        CGMATH_CONSTEXPR Mat33& zero() {
             for (int i = 0; i < 3; ++i) 
                 for (int j = 0; j < 3; ++j) m[i][j] = 0;
             return *this;
         }
 
-        Mat33& identity() {
+        CGMATH_CONSTEXPR Mat33& identity() {
             m[0][0] = m[1][1] = m[2][2] = 1;
             m[0][1] = m[0][2] = m[1][0] = m[1][2] = m[2][0] = m[2][1] = 0;
             return *this;
         }
 
-        Mat33& scale(T sx, T sy, T sz) {
+        CGMATH_CONSTEXPR Mat33& scale(T sx, T sy, T sz) {
             for (int i = 0; i < 3; ++i) {
                 m[i][0] *= sx;
                 m[i][1] *= sy;
@@ -224,7 +235,7 @@ namespace cgmath {
             return *this;
         }
 
-        template <typename U> Vec3<U> transform( const Vec3<U>& v ) const {
+        template <typename U> CGMATH_CONSTEXPR Vec3<U> transform( const Vec3<U>& v ) const {
             return Vec3<U>(
                 static_cast<U>(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z),
                 static_cast<U>(m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z),
@@ -237,21 +248,21 @@ namespace cgmath {
     };
 
 
-    template <typename T> Mat33<T> operator*( const Mat33<T>& lhs, T k ) {
+    template <typename T> CGMATH_CONSTEXPR Mat33<T> operator*( const Mat33<T>& lhs, T k ) {
         return Mat33<T>(lhs) *= k;
     }
 
-    template <typename T> Mat33<T> operator*( T k, const Mat33<T>& rhs ) {
+    template <typename T> CGMATH_CONSTEXPR Mat33<T> operator*( T k, const Mat33<T>& rhs ) {
         return Mat33<T>(rhs) *= k;
     }
 
-    template <typename T> T det( const Mat33<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR T det( const Mat33<T>& m ) {
         return m[0][0]*m[1][1]*m[2][2] + m[0][1]*m[1][2]*m[2][0] + 
                m[0][2]*m[1][0]*m[2][1] - m[0][2]*m[1][1]*m[2][0] - 
                m[0][0]*m[1][2]*m[2][1] - m[0][1]*m[1][0]*m[2][2];
     }
 
-    template <typename T> T norm2( const Mat33<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR T norm2( const Mat33<T>& m ) {
         T n2 = 0;
         for (int i = 0; i < 3; ++i) 
             for (int j = 0; j < 3; ++j) n2 += m[i][j] * m[i][j];
@@ -262,7 +273,7 @@ namespace cgmath {
         return sqrt(norm2(m));
     }
 
-    template <typename T> Mat33<T> adjoint( const Mat33<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR Mat33<T> adjoint( const Mat33<T>& m ) {
         return Mat33<T>(
              m[1][1]*m[2][2] - m[1][2]*m[2][1],
             -m[1][0]*m[2][2] + m[1][2]*m[2][0],
@@ -276,7 +287,7 @@ namespace cgmath {
         );
     }
     
-    template <typename T> Mat33<T> transpose( const Mat33<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR Mat33<T> transpose( const Mat33<T>& m ) {
         return Mat33<T>( m[0][0], m[1][0], m[2][0],
                          m[0][1], m[1][1], m[2][1],
                          m[0][2], m[1][2], m[2][2] );
@@ -321,6 +332,9 @@ namespace cgmath {
         return true;
     }
 
+    typedef Mat33<float> Mat33f;
+    typedef Mat33<double> Mat33d;
+
     /*
     template <typename T> std::ostream& operator<<( std::ostream& os, const mat33<T>& m ) {
         for (int i = 0; i < 3; ++i) {
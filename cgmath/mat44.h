@@ -21,29 +21,30 @@
 
 namespace cgmath {
 
-    /// 4 x 4 matrix class (T=float|double)
-    template <typename T> class Mat44 {
+    /// 4 x 4 matrix class (T=float|double). Mat44<float> is 16 byte
+    /// aligned and multiplies on SSE if CGMATH_SSE is set.
+    template <typename T> class alignas(SimdAlignment<T>::value) Mat44 {
     public:
         typedef T value_type;
 
         Mat44() {}
 
-        Mat44( T a00, T a01, T a02, T a03, 
+        CGMATH_CONSTEXPR Mat44( T a00, T a01, T a02, T a03, 
                T a10, T a11, T a12, T a13,
                T a20, T a21, T a22, T a23,
-               T a30, T a31, T a32, T a33) {
+               T a30, T a31, T a32, T a33) : m() {
                m[0][0] = a00; m[0][1] = a01; m[0][2] = a02; m[0][3] = a03;
                m[1][0] = a10; m[1][1] = a11; m[1][2] = a12; m[1][3] = a13;
                m[2][0] = a20; m[2][1] = a21; m[2][2] = a22; m[2][3] = a23;
                m[3][0] = a30; m[3][1] = a31; m[3][2] = a32; m[3][3] = a33;
         }
 
-        template<typename U> Mat44( const Mat44<U>& src ) {
+        template<typename U> CGMATH_CONSTEXPR Mat44( const Mat44<U>& src ) : m() {
             for (int i = 0; i < 4; ++i) 
-                for (int j = 0; j < 4; ++j) m[i][j] = static_cast<T>(src.m[i*4+j]);
+                for (int j = 0; j < 4; ++j) m[i][j] = static_cast<T>(src[i][j]);
         }
 
-        template<typename U> Mat44( const U *src, bool row_major=true ) {
+        template<typename U> CGMATH_CONSTEXPR Mat44( const U *src, bool row_major=true ) : m() {
             if (row_major) {
                 for (int i = 0; i < 4; ++i) 
                     for (int j = 0; j < 4; ++j) m[i][j] = static_cast<T>(src[i*4+j]);
@@ -53,7 +54,7 @@ namespace cgmath {
             }
         }
 
-        Mat44( const Mat44& A, const Mat44& B ) {
+        CGMATH_CONSTEXPR Mat44( const Mat44& A, const Mat44& B ) : m() {
             for (int i = 0; i < 4; ++i) {
                 m[i][0] =  A.m[i][0] * B.m[0][0] + A.m[i][1] * B.m[1][0] + A.m[i][2] * B.m[2][0] + A.m[i][3] * B.m[3][0];
                 m[i][1] =  A.m[i][0] * B.m[0][1] + A.m[i][1] * B.m[1][1] + A.m[i][2] * B.m[2][1] + A.m[i][3] * B.m[3][1];
@@ -62,25 +63,25 @@ namespace cgmath {
             }
         }
 
-        bool operator==( const Mat44& rhs ) const {
+        CGMATH_CONSTEXPR bool operator==( const Mat44& rhs ) const {
             for (int i = 0; i < 4; ++i) 
                 for (int j = 0; j < 4; ++j) if (m[i][j] != rhs.m[i][j]) return false;
             return true;
         }
 
-        bool operator!=( const Mat44& rhs ) const {
+        CGMATH_CONSTEXPR bool operator!=( const Mat44& rhs ) const {
             return !this->operator==(rhs);
         }
 
-        T* operator[]( int row ) {
+        CGMATH_CONSTEXPR T* operator[]( int row ) {
             return m[row];
         }
 
-        const T* operator[](int row) const {
+        CGMATH_CONSTEXPR const T* operator[](int row) const {
             return m[row];
         }
 
-        template <typename U> void set(const U *src, bool row_major= true) {
+        template <typename U> CGMATH_CONSTEXPR void set(const U *src, bool row_major= true) {
             if (row_major) {
                 for (int i = 0; i < 4; ++i) 
                     for (int j = 0; j < 4; ++j) m[i][j] = static_cast<float>(src[i*4+j]);
@@ -100,27 +101,37 @@ namespace cgmath {
             }
         }
 
-        Mat44 operator*( const Mat44& rhs ) const {
+        CGMATH_CONSTEXPR Mat44 operator*( const Mat44& rhs ) const {
             return Mat44(*this, rhs);
         }
 
-        const Mat44& operator*=(const Mat44& rhs) {
-            return (*this = Mat44(*this, rhs));
+        // Row i of the product only depends on row i of *this, so the
+        // rows are replaced one at a time
+        CGMATH_CONSTEXPR const Mat44& operator*=(const Mat44& rhs) {
+            if (&rhs == this) return (*this = Mat44(*this, rhs));
+            for (int i = 0; i < 4; ++i) {
+                T r[4];
+                for (int j = 0; j < 4; ++j) {
+                    r[j] = m[i][0] * rhs.m[0][j] + m[i][1] * rhs.m[1][j] + m[i][2] * rhs.m[2][j] + m[i][3] * rhs.m[3][j];
+                }
+                for (int j = 0; j < 4; ++j) m[i][j] = r[j];
+            }
+            return *this;
         }
 
-        Mat44& zero() {
+        CGMATH_CONSTEXPR Mat44& zero() {
             for (int i = 0; i < 4; ++i) 
                 for (int j = 0; j < 4; ++j) m[i][j] = 0;
             return *this;
         }
 
-        Mat44& identity() {
+        CGMATH_CONSTEXPR Mat44& identity() {
             for (int i = 0; i < 4; ++i) 
                 for (int j = 0; j < 4; ++j) m[i][j] = (i == j)? 1 : 0;
             return *this;
         }
 
-        Mat44& Mat44::scale(T sx, T sy, T sz) {
+        CGMATH_CONSTEXPR Mat44& scale(T sx, T sy, T sz) {
             for (int i = 0; i < 4; ++i) {
                 m[i][0] *= sx;
                 m[i][1] *= sy;
@@ -129,14 +140,14 @@ namespace cgmath {
             return *this;
         }
 
-        Mat44& Mat44::translate(T tx, T ty, T tz) {
+        CGMATH_CONSTEXPR Mat44& translate(T tx, T ty, T tz) {
             for (int i = 0; i < 3; ++i) {
                 m[i][3] += tx * m[i][0] + ty * m[i][1] + tz * m[i][2];
             }
             return *this;
         }
 
-        template <typename U> Vec3<U> transform( const Vec3<U>& v ) {
+        template <typename U> CGMATH_CONSTEXPR Vec3<U> transform( const Vec3<U>& v ) const {
             U x = static_cast<U>(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z);
             U y = static_cast<U>(m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z);
             U z = static_cast<U>(m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
@@ -149,24 +160,92 @@ namespace cgmath {
     };
 
 
-    template <typename T> T Mat44::norm2() const {
+#ifdef CGMATH_SSE
+
+    namespace sse {
+
+        /// Row i of A * B: the rows of B scaled by the entries of row i of
+        /// A, summed in the order of the scalar code
+        inline __m128 mul_row( const float *a, const __m128 *b ) {
+            __m128 r = _mm_mul_ps(_mm_set1_ps(a[0]), b[0]);
+        #ifdef __FMA__
+            r = _mm_fmadd_ps(_mm_set1_ps(a[1]), b[1], r);
+            r = _mm_fmadd_ps(_mm_set1_ps(a[2]), b[2], r);
+            r = _mm_fmadd_ps(_mm_set1_ps(a[3]), b[3], r);
+        #else
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[1]), b[1]));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[2]), b[2]));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[3]), b[3]));
+        #endif
+            return r;
+        }
+
+        /// r = a * b for row-major 4 x 4 matrices; r may be a or b
+        inline void mul44( const float *a, const float *b, float *r ) {
+            __m128 rows[4] = { _mm_load_ps(b), _mm_load_ps(b + 4), _mm_load_ps(b + 8), _mm_load_ps(b + 12) };
+            for (int i = 0; i < 4; ++i) _mm_store_ps(r + 4 * i, mul_row(a + 4 * i, rows));
+        }
+
+    }
+
+    template <> inline CGMATH_CONSTEXPR Mat44<float>::Mat44( const Mat44<float>& A, const Mat44<float>& B ) : m() {
+        if (CGMATH_CONSTANT_EVALUATED()) {
+            for (int i = 0; i < 4; ++i) {
+                for (int j = 0; j < 4; ++j) {
+                    m[i][j] = A.m[i][0] * B.m[0][j] + A.m[i][1] * B.m[1][j] + A.m[i][2] * B.m[2][j] + A.m[i][3] * B.m[3][j];
+                }
+            }
+            return;
+        }
+        sse::mul44(A.m[0], B.m[0], m[0]);
+    }
+
+    template <> inline CGMATH_CONSTEXPR const Mat44<float>& Mat44<float>::operator*=( const Mat44<float>& rhs ) {
+        if (CGMATH_CONSTANT_EVALUATED()) return (*this = Mat44(*this, rhs));
+        sse::mul44(m[0], rhs.m[0], m[0]);
+        return *this;
+    }
+
+#endif
+
+
+    template <typename T> CGMATH_CONSTEXPR T norm2( const Mat44<T>& m ) {
         T n2 = 0;
         for (int i = 0; i < 4; ++i) 
             for (int j = 0; j < 4; ++j) n2 += m[i][j] * m[i][j];
         return n2;
     }
 
-    template <typename T> T Mat44::norm() const {
-        return sqrt(norm2());
+    template <typename T> T norm( const Mat44<T>& m ) {
+        return sqrt(norm2(m));
     }
 
-    template <typename T> Mat44<T> transpose( const Mat44<T>& m ) {
+    template <typename T> CGMATH_CONSTEXPR T det( const Mat44<T>& m ) {
+        T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+        T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    template <typename T> CGMATH_CONSTEXPR Mat44<T> transpose( const Mat44<T>& m ) {
         return Mat44<T>( m[0][0], m[1][0], m[2][0], m[3][0],
                          m[0][1], m[1][1], m[2][1], m[3][1],
                          m[0][2], m[1][2], m[2][2], m[3][2],
                          m[0][3], m[1][3], m[2][3], m[3][3] );
     }
 
+    typedef Mat44<float> Mat44f;
+    typedef Mat44<double> Mat44d;
+
     /*
     template <typename T> std::ostream& operator<<( std::ostream& os, const mat44<T>& m ) {
         for (int i = 0; i < 4; ++i) {
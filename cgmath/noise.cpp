@@ -17,6 +17,9 @@
     675 Mass Ave, Cambridge, MA 02139, USA.
 */
 #include <cgmath/noise.h>
+#include <cgmath/simd.h>
+#include <limits>
+#include <vector>
 
 
 
@@ -32,7 +35,7 @@
 #define LERP(t, a, b) ((a) + (t)*((b)-(a)))
 
 
-static unsigned char perm[] = {151,160,137,91,90,15,
+static unsigned char perlin_perm[] = {151,160,137,91,90,15,
     131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
     190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
     88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166,
@@ -62,8 +65,11 @@ static unsigned char perm[] = {151,160,137,91,90,15,
 
 
 /*
- * Helper functions to compute gradients-dot-residualvectors (1D to 4D)
- * Note that these generate gradients of more than unit length. To make
+ * Gradient tables (1D to 4D). Each context tabulates the gradient vectors
+ * of the original grad() helpers for every entry of its permutation
+ * table, so that a gradient-dot-residual product is a handful of loads and
+ * multiply-adds instead of a chain of branches on the hash bits.
+ * Note that these are gradients of more than unit length. To make
  * a close match with the value range of classic Perlin noise, the final
  * noise values need to be rescaled. To match the RenderMan noise in a
  * statistical sense, the approximate scaling values (empirically
@@ -79,40 +85,364 @@ static unsigned char perm[] = {151,160,137,91,90,15,
  * float SLnoise = (perlin_noise(x,y,z) + 1.0) * 0.5;
  */
 
-static float grad( int hash, float x ) {
-    int h = hash & 15;
-    float grad = 1.0f + (h & 7);  // Gradient value 1.0, 2.0, ..., 8.0
-    if (h&8) grad = -grad;         // and a random sign for the gradient
-    return ( grad * x );           // Multiply the gradient with the distance
+static inline float grad( const float g[][512], int i, float x ) {
+    return g[0][i] * x;
 }
 
 
-static float grad( int hash, float x, float y ) {
-    int h = hash & 7;      // Convert low 3 bits of hash code
-    float u = h<4 ? x : y;  // into 8 simple gradient directions,
-    float v = h<4 ? y : x;  // and compute the dot product with (x,y).
-    return ((h&1)? -u : u) + ((h&2)? -2.0f*v : 2.0f*v);
+static inline float grad( const float g[][512], int i, float x, float y ) {
+    return g[0][i] * x + g[1][i] * y;
 }
 
 
-static float grad( int hash, float x, float y , float z ) {
-    int h = hash & 15;     // Convert low 4 bits of hash code into 12 simple
-    float u = h<8 ? x : y; // gradient directions, and compute dot product.
-    float v = h<4 ? y : h==12||h==14 ? x : z; // Fix repeats at h = 12 to 15
-    return ((h&1)? -u : u) + ((h&2)? -v : v);
+static inline float grad( const float g[][512], int i, float x, float y, float z ) {
+    return g[0][i] * x + g[1][i] * y + g[2][i] * z;
 }
 
 
-static float  grad( int hash, float x, float y, float z, float t ) {
-    int h = hash & 31;      // Convert low 5 bits of hash code into 32 simple
-    float u = h<24 ? x : y; // gradient directions, and compute dot product.
-    float v = h<16 ? y : z;
-    float w = h<8 ? z : t;
-    return ((h&1)? -u : u) + ((h&2)? -v : v) + ((h&4)? -w : w);
+static inline float grad( const float g[][512], int i, float x, float y, float z, float t ) {
+    return g[0][i] * x + g[1][i] * y + g[2][i] * z + g[3][i] * t;
 }
 
 
-float cgmath::noise( float x ) {
+cgmath::NoiseContext::NoiseContext() : m_hash(PERMUTATION), m_seed(0) {
+    init(perlin_perm);
+}
+
+
+cgmath::NoiseContext::NoiseContext( uint32_t seed, Hash hash ) : m_hash(hash), m_seed(seed) {
+    unsigned char p[256];
+    for (int i = 0; i < 256; ++i) {
+        p[i] = static_cast<unsigned char>(i);
+    }
+
+    // Fisher-Yates shuffle, driven by the high bits of a 32-bit LCG
+    uint32_t s = seed;
+    for (int i = 255; i > 0; --i) {
+        s = 1664525u * s + 1013904223u;
+        int j = static_cast<int>((static_cast<uint64_t>(s >> 8) * (i + 1)) >> 24);
+        unsigned char t = p[i];
+        p[i] = p[j];
+        p[j] = t;
+    }
+
+    init(p);
+}
+
+
+// Gradient components of hash value h for 1D to 4D noise, stored like
+// the gradient tables: g[0] for 1D, g[1..2] for 2D, g[3..5] for 3D and
+// g[6..9] for 4D. Only the low five bits of h are used.
+static void gradient_components( int h, float *g ) {
+    float u, v;
+
+    // 1D: gradient value 1.0, 2.0, ..., 8.0 and a random sign
+    u = 1.0f + (h & 7);
+    g[0] = (h & 8)? -u : u;
+
+    // 2D: 8 directions, (+-1,+-2) and (+-2,+-1)
+    u = (h & 1)? -1.0f : 1.0f;
+    v = (h & 2)? -2.0f : 2.0f;
+    g[1] = ((h & 7) < 4)? u : v;
+    g[2] = ((h & 7) < 4)? v : u;
+
+    // 3D: 12 directions to the cube edges, h = 12 to 15 repeat four of them
+    int h3 = h & 15;
+    g[3] = g[4] = g[5] = 0;
+    g[3 + ((h3 < 8)? 0 : 1)] = (h3 & 1)? -1.0f : 1.0f;
+    g[3 + ((h3 < 4)? 1 : (h3 == 12 || h3 == 14)? 0 : 2)] = (h3 & 2)? -1.0f : 1.0f;
+
+    // 4D: 32 directions to the hypercube edges
+    int h4 = h & 31;
+    g[6] = g[7] = g[8] = g[9] = 0;
+    g[6 + ((h4 < 24)? 0 : 1)] = (h4 & 1)? -1.0f : 1.0f;
+    g[6 + ((h4 < 16)? 1 : 2)] = (h4 & 2)? -1.0f : 1.0f;
+    g[6 + ((h4 < 8)? 2 : 3)] = (h4 & 4)? -1.0f : 1.0f;
+}
+
+
+void cgmath::NoiseContext::init( const unsigned char *p ) {
+    for (int i = 0; i < 512; ++i) {
+        m_perm[i] = p[i & 0xff];
+    }
+
+    float g[10];
+    for (int i = 0; i < 512; ++i) {
+        gradient_components(m_perm[i], g);
+        for (int k = 0; k < 10; ++k) m_grad[k][i] = g[k];
+    }
+
+    // INTEGER hashing looks up gradients by hash value
+    for (int h = 0; h < 32; ++h) {
+        gradient_components(h, g);
+        for (int k = 0; k < 10; ++k) m_hash_grad[k][h] = g[k];
+    }
+}
+
+
+// Integer mixing function of the INTEGER lattice hash (lowbias32 by Chris
+// Wellons). Lattice point (i, j, ...) is hashed like the permutation table
+// indexes it, as H(i + H(j + ...)) with H(a) = mix(a ^ seed).
+static inline uint32_t mix( uint32_t x ) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+
+// Lattice cell of point p: corners i[d][0..1] wrapped like pnoise(), to
+// 0..period[d]-1 and by the mask, the offsets f[d][0..1] from them and
+// the fade weights s[d]. Periods of 0, or none, leave the axes unwrapped.
+template <int D> static void lattice_cell( const float *p, const int *period, int mask, 
+                                           int i[][2], float f[][2], float *s )
+{
+    for (int d = 0; d < D; ++d) {
+        int i0 = FASTFLOOR( p[d] );
+        f[d][0] = p[d] - i0;
+        f[d][1] = f[d][0] - 1.0f;
+        s[d] = FADE( f[d][0] );
+        int pd = period? period[d] : 0;
+        i[d][0] = ((pd > 0)? i0 % pd : i0) & mask;
+        i[d][1] = ((pd > 0)? ( i0 + 1 ) % pd : i0 + 1) & mask;
+    }
+}
+
+
+// Hashes the corners of an INTEGER lattice cell from the last axis
+// outwards, so that corner k has bit D-1-d set if it is the upper corner
+// along axis d
+template <int D> static void hash_corners( uint32_t seed, const int i[][2], uint32_t *h ) {
+    h[0] = mix(static_cast<uint32_t>(i[D - 1][0]) ^ seed);
+    h[1] = mix(static_cast<uint32_t>(i[D - 1][1]) ^ seed);
+    for (int d = D - 2; d >= 0; --d) {
+        int m = 1 << (D - 1 - d);
+        for (int k = 0; k < m; ++k) {
+            h[m + k] = mix((static_cast<uint32_t>(i[d][1]) + h[k]) ^ seed);
+            h[k] = mix((static_cast<uint32_t>(i[d][0]) + h[k]) ^ seed);
+        }
+    }
+}
+
+
+// D-dimensional noise over the INTEGER lattice at a cell given by
+// lattice_cell(), evaluated in the same order as noise() and pnoise()
+template <int D> static float hashed_noise( const float g[][32], uint32_t seed, 
+                                            const int i[][2], const float f[][2], const float *s ) 
+{
+    static const float scale[4] = { 0.188f, 0.507f, 0.936f, 0.87f };
+
+    uint32_t h[1 << D];
+    hash_corners<D>(seed, i, h);
+
+    float n[1 << D];
+    for (int k = 0; k < (1 << D); ++k) {
+        int c = h[k] & 31;
+        float v = g[0][c] * f[0][(k >> (D - 1)) & 1];
+        for (int d = 1; d < D; ++d) v += g[d][c] * f[d][(k >> (D - 1 - d)) & 1];
+        n[k] = v;
+    }
+
+    for (int d = D - 1; d >= 0; --d) {
+        for (int k = 0; k < (1 << d); ++k) n[k] = LERP( s[d], n[2 * k], n[2 * k + 1] );
+    }
+    return scale[D - 1] * n[0];
+}
+
+
+// Splits a double coordinate exactly into its 64-bit lattice cell, of
+// which the low 32 bits are kept, and the offset in it rounded to float
+static inline void split_cell( double p, int *cell, float *f ) {
+    int64_t c = static_cast<int64_t>(p);
+    if (p < c) --c;
+    *cell = static_cast<int>(static_cast<uint32_t>(c));
+    *f = static_cast<float>(p - c);
+}
+
+
+// Lattice cell of the double precision point p, not wrapped to periods
+template <int D> static void lattice_cell( const double *p, int mask, int i[][2], float f[][2], float *s ) {
+    for (int d = 0; d < D; ++d) {
+        int c;
+        split_cell(p[d], &c, &f[d][0]);
+        f[d][1] = f[d][0] - 1.0f;
+        s[d] = FADE( f[d][0] );
+        i[d][0] = c & mask;
+        i[d][1] = static_cast<int>(static_cast<uint32_t>(c) + 1) & mask;
+    }
+}
+
+
+template <int D> static float hashed_noise( const float g[][32], uint32_t seed, 
+                                            const float *p, const int *period ) 
+{
+    int i[D][2];
+    float f[D][2], s[D];
+    lattice_cell<D>(p, period, -1, i, f, s);
+    return hashed_noise<D>(g, seed, i, f, s);
+}
+
+
+// Perlin's noise through the permutation table at a cell given by
+// lattice_cell(), the code of pnoise() with the wrapping factored out
+template <int D> static float permuted_noise( const float g[][512], const int *perm,
+                                              const int i[][2], const float f[][2], const float *fade );
+
+template <> float permuted_noise<1>( const float g[][512], const int *,
+                                     const int i[][2], const float f[][2], const float *fade )
+{
+    int ix0 = i[0][0];
+    int ix1 = i[0][1];
+    float fx0 = f[0][0];
+    float fx1 = f[0][1];
+    float s = fade[0];
+    float n0, n1;
+
+    n0 = grad( g, ix0, fx0 );
+    n1 = grad( g, ix1, fx1 );
+    return 0.188f * ( LERP( s, n0, n1 ) );
+}
+
+
+template <> float permuted_noise<2>( const float g[][512], const int *perm,
+                                     const int i[][2], const float f[][2], const float *fade )
+{
+    int ix0 = i[0][0], iy0 = i[1][0];
+    int ix1 = i[0][1], iy1 = i[1][1];
+    float fx0 = f[0][0], fy0 = f[1][0];
+    float fx1 = f[0][1], fy1 = f[1][1];
+    float s = fade[0], t = fade[1];
+    float nx0, nx1, n0, n1;
+
+    nx0 = grad(g, ix0 + perm[iy0], fx0, fy0);
+    nx1 = grad(g, ix0 + perm[iy1], fx0, fy1);
+    n0 = LERP( t, nx0, nx1 );
+
+    nx0 = grad(g, ix1 + perm[iy0], fx1, fy0);
+    nx1 = grad(g, ix1 + perm[iy1], fx1, fy1);
+    n1 = LERP(t, nx0, nx1);
+
+    return 0.507f * ( LERP( s, n0, n1 ) );
+}
+
+
+template <> float permuted_noise<3>( const float g[][512], const int *perm,
+                                     const int i[][2], const float f[][2], const float *fade )
+{
+    int ix0 = i[0][0], iy0 = i[1][0], iz0 = i[2][0];
+    int ix1 = i[0][1], iy1 = i[1][1], iz1 = i[2][1];
+    float fx0 = f[0][0], fy0 = f[1][0], fz0 = f[2][0];
+    float fx1 = f[0][1], fy1 = f[1][1], fz1 = f[2][1];
+    float s = fade[0], t = fade[1], r = fade[2];
+    float nxy0, nxy1, nx0, nx1, n0, n1;
+
+    nxy0 = grad(g, ix0 + perm[iy0 + perm[iz0]], fx0, fy0, fz0);
+    nxy1 = grad(g, ix0 + perm[iy0 + perm[iz1]], fx0, fy0, fz1);
+    nx0 = LERP( r, nxy0, nxy1 );
+
+    nxy0 = grad(g, ix0 + perm[iy1 + perm[iz0]], fx0, fy1, fz0);
+    nxy1 = grad(g, ix0 + perm[iy1 + perm[iz1]], fx0, fy1, fz1);
+    nx1 = LERP( r, nxy0, nxy1 );
+
+    n0 = LERP( t, nx0, nx1 );
+
+    nxy0 = grad(g, ix1 + perm[iy0 + perm[iz0]], fx1, fy0, fz0);
+    nxy1 = grad(g, ix1 + perm[iy0 + perm[iz1]], fx1, fy0, fz1);
+    nx0 = LERP( r, nxy0, nxy1 );
+
+    nxy0 = grad(g, ix1 + perm[iy1 + perm[iz0]], fx1, fy1, fz0);
+    nxy1 = grad(g, ix1 + perm[iy1 + perm[iz1]], fx1, fy1, fz1);
+    nx1 = LERP( r, nxy0, nxy1 );
+
+    n1 = LERP( t, nx0, nx1 );
+    
+    return 0.936f * ( LERP( s, n0, n1 ) );
+}
+
+
+template <> float permuted_noise<4>( const float g[][512], const int *perm,
+                                     const int i[][2], const float f[][2], const float *fade )
+{
+    int ix0 = i[0][0], iy0 = i[1][0], iz0 = i[2][0], iw0 = i[3][0];
+    int ix1 = i[0][1], iy1 = i[1][1], iz1 = i[2][1], iw1 = i[3][1];
+    float fx0 = f[0][0], fy0 = f[1][0], fz0 = f[2][0], fw0 = f[3][0];
+    float fx1 = f[0][1], fy1 = f[1][1], fz1 = f[2][1], fw1 = f[3][1];
+    float s = fade[0], t = fade[1], r = fade[2], q = fade[3];
+    float nxyz0, nxyz1, nxy0, nxy1, nx0, nx1, n0, n1;
+
+    nxyz0 = grad(g, ix0 + perm[iy0 + perm[iz0 + perm[iw0]]], fx0, fy0, fz0, fw0);
+    nxyz1 = grad(g, ix0 + perm[iy0 + perm[iz0 + perm[iw1]]], fx0, fy0, fz0, fw1);
+    nxy0 = LERP( q, nxyz0, nxyz1 );
+        
+    nxyz0 = grad(g, ix0 + perm[iy0 + perm[iz1 + perm[iw0]]], fx0, fy0, fz1, fw0);
+    nxyz1 = grad(g, ix0 + perm[iy0 + perm[iz1 + perm[iw1]]], fx0, fy0, fz1, fw1);
+    nxy1 = LERP( q, nxyz0, nxyz1 );
+        
+    nx0 = LERP ( r, nxy0, nxy1 );
+
+    nxyz0 = grad(g, ix0 + perm[iy1 + perm[iz0 + perm[iw0]]], fx0, fy1, fz0, fw0);
+    nxyz1 = grad(g, ix0 + perm[iy1 + perm[iz0 + perm[iw1]]], fx0, fy1, fz0, fw1);
+    nxy0 = LERP( q, nxyz0, nxyz1 );
+        
+    nxyz0 = grad(g, ix0 + perm[iy1 + perm[iz1 + perm[iw0]]], fx0, fy1, fz1, fw0);
+    nxyz1 = grad(g, ix0 + perm[iy1 + perm[iz1 + perm[iw1]]], fx0, fy1, fz1, fw1);
+    nxy1 = LERP( q, nxyz0, nxyz1 );
+
+    nx1 = LERP ( r, nxy0, nxy1 );
+
+    n0 = LERP( t, nx0, nx1 );
+
+    nxyz0 = grad(g, ix1 + perm[iy0 + perm[iz0 + perm[iw0]]], fx1, fy0, fz0, fw0);
+    nxyz1 = grad(g, ix1 + perm[iy0 + perm[iz0 + perm[iw1]]], fx1, fy0, fz0, fw1);
+    nxy0 = LERP( q, nxyz0, nxyz1 );
+        
+    nxyz0 = grad(g, ix1 + perm[iy0 + perm[iz1 + perm[iw0]]], fx1, fy0, fz1, fw0);
+    nxyz1 = grad(g, ix1 + perm[iy0 + perm[iz1 + perm[iw1]]], fx1, fy0, fz1, fw1);
+    nxy1 = LERP( q, nxyz0, nxyz1 );
+
+    nx0 = LERP ( r, nxy0, nxy1 );
+
+    nxyz0 = grad(g, ix1 + perm[iy1 + perm[iz0 + perm[iw0]]], fx1, fy1, fz0, fw0);
+    nxyz1 = grad(g, ix1 + perm[iy1 + perm[iz0 + perm[iw1]]], fx1, fy1, fz0, fw1);
+    nxy0 = LERP( q, nxyz0, nxyz1 );
+        
+    nxyz0 = grad(g, ix1 + perm[iy1 + perm[iz1 + perm[iw0]]], fx1, fy1, fz1, fw0);
+    nxyz1 = grad(g, ix1 + perm[iy1 + perm[iz1 + perm[iw1]]], fx1, fy1, fz1, fw1);
+    nxy1 = LERP( q, nxyz0, nxyz1 );
+
+    nx1 = LERP ( r, nxy0, nxy1 );
+
+    n1 = LERP( t, nx0, nx1 );
+
+    return 0.87f * ( LERP( s, n0, n1 ) );
+}
+
+
+template <int D> float cgmath::NoiseContext::cell_noise( const int i[][2], const float f[][2], const float *s ) const {
+    if (m_hash == INTEGER) return hashed_noise<D>(m_hash_grad + D * (D - 1) / 2, m_seed, i, f, s);
+    return permuted_noise<D>(m_grad + D * (D - 1) / 2, m_perm, i, f, s);
+}
+
+
+template <int D> float cgmath::NoiseContext::noise64( const double *p ) const {
+    int i[D][2];
+    float f[D][2], s[D];
+    lattice_cell<D>(p, (m_hash == INTEGER)? -1 : 0xff, i, f, s);
+    return cell_noise<D>(i, f, s);
+}
+
+
+const cgmath::NoiseContext& cgmath::default_noise_context() {
+    static const NoiseContext context;
+    return context;
+}
+
+
+float cgmath::NoiseContext::noise( float x ) const {
+    if (m_hash == INTEGER) return hashed_noise<1>(m_hash_grad, m_seed, &x, 0);
+    const float (*g)[512] = m_grad;
     int ix0, ix1;
     float fx0, fx1;
     float s, n0, n1;
@@ -125,13 +455,18 @@ float cgmath::noise( float x ) {
 
     s = FADE( fx0 );
 
-    n0 = grad( perm[ ix0 ], fx0 );
-    n1 = grad( perm[ ix1 ], fx1 );
+    n0 = grad( g, ix0, fx0 );
+    n1 = grad( g, ix1, fx1 );
     return 0.188f * ( LERP( s, n0, n1 ) );
 }
 
 
-float cgmath::noise( float x, float y ) {
+float cgmath::NoiseContext::noise( float x, float y ) const {
+    if (m_hash == INTEGER) {
+        const float p[2] = { x, y };
+        return hashed_noise<2>(m_hash_grad + 1, m_seed, p, 0);
+    }
+    const float (*g)[512] = m_grad + 1;
     int ix0, iy0, ix1, iy1;
     float fx0, fy0, fx1, fy1;
     float s, t, nx0, nx1, n0, n1;
@@ -150,20 +485,25 @@ float cgmath::noise( float x, float y ) {
     t = FADE( fy0 );
     s = FADE( fx0 );
 
-    nx0 = grad(perm[ix0 + perm[iy0]], fx0, fy0);
-    nx1 = grad(perm[ix0 + perm[iy1]], fx0, fy1);
+    nx0 = grad(g, ix0 + m_perm[iy0], fx0, fy0);
+    nx1 = grad(g, ix0 + m_perm[iy1], fx0, fy1);
     n0 = LERP( t, nx0, nx1 );
 
-    nx0 = grad(perm[ix1 + perm[iy0]], fx1, fy0);
-    nx1 = grad(perm[ix1 + perm[iy1]], fx1, fy1);
+    nx0 = grad(g, ix1 + m_perm[iy0], fx1, fy0);
+    nx1 = grad(g, ix1 + m_perm[iy1], fx1, fy1);
     n1 = LERP(t, nx0, nx1);
 
     return 0.507f * ( LERP( s, n0, n1 ) );
 }
 
 
-float cgmath::noise( float x, float y, float z )
+float cgmath::NoiseContext::noise( float x, float y, float z ) const
 {
+    if (m_hash == INTEGER) {
+        const float p[3] = { x, y, z };
+        return hashed_noise<3>(m_hash_grad + 3, m_seed, p, 0);
+    }
+    const float (*g)[512] = m_grad + 3;
     int ix0, iy0, ix1, iy1, iz0, iz1;
     float fx0, fy0, fz0, fx1, fy1, fz1;
     float s, t, r;
@@ -189,22 +529,22 @@ float cgmath::noise( float x, float y, float z )
     t = FADE( fy0 );
     s = FADE( fx0 );
 
-    nxy0 = grad(perm[ix0 + perm[iy0 + perm[iz0]]], fx0, fy0, fz0);
-    nxy1 = grad(perm[ix0 + perm[iy0 + perm[iz1]]], fx0, fy0, fz1);
+    nxy0 = grad(g, ix0 + m_perm[iy0 + m_perm[iz0]], fx0, fy0, fz0);
+    nxy1 = grad(g, ix0 + m_perm[iy0 + m_perm[iz1]], fx0, fy0, fz1);
     nx0 = LERP( r, nxy0, nxy1 );
 
-    nxy0 = grad(perm[ix0 + perm[iy1 + perm[iz0]]], fx0, fy1, fz0);
-    nxy1 = grad(perm[ix0 + perm[iy1 + perm[iz1]]], fx0, fy1, fz1);
+    nxy0 = grad(g, ix0 + m_perm[iy1 + m_perm[iz0]], fx0, fy1, fz0);
+    nxy1 = grad(g, ix0 + m_perm[iy1 + m_perm[iz1]], fx0, fy1, fz1);
     nx1 = LERP( r, nxy0, nxy1 );
 
     n0 = LERP( t, nx0, nx1 );
 
-    nxy0 = grad(perm[ix1 + perm[iy0 + perm[iz0]]], fx1, fy0, fz0);
-    nxy1 = grad(perm[ix1 + perm[iy0 + perm[iz1]]], fx1, fy0, fz1);
+    nxy0 = grad(g, ix1 + m_perm[iy0 + m_perm[iz0]], fx1, fy0, fz0);
+    nxy1 = grad(g, ix1 + m_perm[iy0 + m_perm[iz1]], fx1, fy0, fz1);
     nx0 = LERP( r, nxy0, nxy1 );
 
-    nxy0 = grad(perm[ix1 + perm[iy1 + perm[iz0]]], fx1, fy1, fz0);
-    nxy1 = grad(perm[ix1 + perm[iy1 + perm[iz1]]], fx1, fy1, fz1);
+    nxy0 = grad(g, ix1 + m_perm[iy1 + m_perm[iz0]], fx1, fy1, fz0);
+    nxy1 = grad(g, ix1 + m_perm[iy1 + m_perm[iz1]], fx1, fy1, fz1);
     nx1 = LERP( r, nxy0, nxy1 );
 
     n1 = LERP( t, nx0, nx1 );
@@ -213,8 +553,13 @@ float cgmath::noise( float x, float y, float z )
 }
 
 
-float cgmath::noise( float x, float y, float z, float w )
+float cgmath::NoiseContext::noise( float x, float y, float z, float w ) const
 {
+    if (m_hash == INTEGER) {
+        const float p[4] = { x, y, z, w };
+        return hashed_noise<4>(m_hash_grad + 6, m_seed, p, 0);
+    }
+    const float (*g)[512] = m_grad + 6;
     int ix0, iy0, iz0, iw0, ix1, iy1, iz1, iw1;
     float fx0, fy0, fz0, fw0, fx1, fy1, fz1, fw1;
     float s, t, r, q;
@@ -246,44 +591,44 @@ float cgmath::noise( float x, float y, float z, float w )
     t = FADE( fy0 );
     s = FADE( fx0 );
 
-    nxyz0 = grad(perm[ix0 + perm[iy0 + perm[iz0 + perm[iw0]]]], fx0, fy0, fz0, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy0 + perm[iz0 + perm[iw1]]]], fx0, fy0, fz0, fw1);
+    nxyz0 = grad(g, ix0 + m_perm[iy0 + m_perm[iz0 + m_perm[iw0]]], fx0, fy0, fz0, fw0);
+    nxyz1 = grad(g, ix0 + m_perm[iy0 + m_perm[iz0 + m_perm[iw1]]], fx0, fy0, fz0, fw1);
     nxy0 = LERP( q, nxyz0, nxyz1 );
         
-    nxyz0 = grad(perm[ix0 + perm[iy0 + perm[iz1 + perm[iw0]]]], fx0, fy0, fz1, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy0 + perm[iz1 + perm[iw1]]]], fx0, fy0, fz1, fw1);
+    nxyz0 = grad(g, ix0 + m_perm[iy0 + m_perm[iz1 + m_perm[iw0]]], fx0, fy0, fz1, fw0);
+    nxyz1 = grad(g, ix0 + m_perm[iy0 + m_perm[iz1 + m_perm[iw1]]], fx0, fy0, fz1, fw1);
     nxy1 = LERP( q, nxyz0, nxyz1 );
         
     nx0 = LERP ( r, nxy0, nxy1 );
 
-    nxyz0 = grad(perm[ix0 + perm[iy1 + perm[iz0 + perm[iw0]]]], fx0, fy1, fz0, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy1 + perm[iz0 + perm[iw1]]]], fx0, fy1, fz0, fw1);
+    nxyz0 = grad(g, ix0 + m_perm[iy1 + m_perm[iz0 + m_perm[iw0]]], fx0, fy1, fz0, fw0);
+    nxyz1 = grad(g, ix0 + m_perm[iy1 + m_perm[iz0 + m_perm[iw1]]], fx0, fy1, fz0, fw1);
     nxy0 = LERP( q, nxyz0, nxyz1 );
         
-    nxyz0 = grad(perm[ix0 + perm[iy1 + perm[iz1 + perm[iw0]]]], fx0, fy1, fz1, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy1 + perm[iz1 + perm[iw1]]]], fx0, fy1, fz1, fw1);
+    nxyz0 = grad(g, ix0 + m_perm[iy1 + m_perm[iz1 + m_perm[iw0]]], fx0, fy1, fz1, fw0);
+    nxyz1 = grad(g, ix0 + m_perm[iy1 + m_perm[iz1 + m_perm[iw1]]], fx0, fy1, fz1, fw1);
     nxy1 = LERP( q, nxyz0, nxyz1 );
 
     nx1 = LERP ( r, nxy0, nxy1 );
 
     n0 = LERP( t, nx0, nx1 );
 
-    nxyz0 = grad(perm[ix1 + perm[iy0 + perm[iz0 + perm[iw0]]]], fx1, fy0, fz0, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy0 + perm[iz0 + perm[iw1]]]], fx1, fy0, fz0, fw1);
+    nxyz0 = grad(g, ix1 + m_perm[iy0 + m_perm[iz0 + m_perm[iw0]]], fx1, fy0, fz0, fw0);
+    nxyz1 = grad(g, ix1 + m_perm[iy0 + m_perm[iz0 + m_perm[iw1]]], fx1, fy0, fz0, fw1);
     nxy0 = LERP( q, nxyz0, nxyz1 );
         
-    nxyz0 = grad(perm[ix1 + perm[iy0 + perm[iz1 + perm[iw0]]]], fx1, fy0, fz1, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy0 + perm[iz1 + perm[iw1]]]], fx1, fy0, fz1, fw1);
+    nxyz0 = grad(g, ix1 + m_perm[iy0 + m_perm[iz1 + m_perm[iw0]]], fx1, fy0, fz1, fw0);
+    nxyz1 = grad(g, ix1 + m_perm[iy0 + m_perm[iz1 + m_perm[iw1]]], fx1, fy0, fz1, fw1);
     nxy1 = LERP( q, nxyz0, nxyz1 );
 
     nx0 = LERP ( r, nxy0, nxy1 );
 
-    nxyz0 = grad(perm[ix1 + perm[iy1 + perm[iz0 + perm[iw0]]]], fx1, fy1, fz0, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy1 + perm[iz0 + perm[iw1]]]], fx1, fy1, fz0, fw1);
+    nxyz0 = grad(g, ix1 + m_perm[iy1 + m_perm[iz0 + m_perm[iw0]]], fx1, fy1, fz0, fw0);
+    nxyz1 = grad(g, ix1 + m_perm[iy1 + m_perm[iz0 + m_perm[iw1]]], fx1, fy1, fz0, fw1);
     nxy0 = LERP( q, nxyz0, nxyz1 );
         
-    nxyz0 = grad(perm[ix1 + perm[iy1 + perm[iz1 + perm[iw0]]]], fx1, fy1, fz1, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy1 + perm[iz1 + perm[iw1]]]], fx1, fy1, fz1, fw1);
+    nxyz0 = grad(g, ix1 + m_perm[iy1 + m_perm[iz1 + m_perm[iw0]]], fx1, fy1, fz1, fw0);
+    nxyz1 = grad(g, ix1 + m_perm[iy1 + m_perm[iz1 + m_perm[iw1]]], fx1, fy1, fz1, fw1);
     nxy1 = LERP( q, nxyz0, nxyz1 );
 
     nx1 = LERP ( r, nxy0, nxy1 );
@@ -294,29 +639,164 @@ float cgmath::noise( float x, float y, float z, float w )
 }
 
 
-float cgmath::pnoise( float x, int px ) {
-    int ix0, ix1;
-    float fx0, fx1;
-    float s, n0, n1;
+float cgmath::NoiseContext::pnoise( float x, int px ) const {
+    const float p[1] = { x };
+    const int period[1] = { px };
+    int i[1][2];
+    float f[1][2], s[1];
+    lattice_cell<1>(p, period, (m_hash == INTEGER)? -1 : 0xff, i, f, s);
+    return cell_noise<1>(i, f, s);
+}
 
-    ix0 = FASTFLOOR( x ); // Integer part of x
-    fx0 = x - ix0;       // Fractional part of x
-    fx1 = fx0 - 1.0f;
-    ix1 = (( ix0 + 1 ) % px) & 0xff; // Wrap to 0..px-1 *and* wrap to 0..255
-    ix0 = ( ix0 % px ) & 0xff;      // (because px might be greater than 256)
 
-    s = FADE( fx0 );
+float cgmath::NoiseContext::pnoise( float x, float y, int px, int py ) const {
+    const float p[2] = { x, y };
+    const int period[2] = { px, py };
+    int i[2][2];
+    float f[2][2], s[2];
+    lattice_cell<2>(p, period, (m_hash == INTEGER)? -1 : 0xff, i, f, s);
+    return cell_noise<2>(i, f, s);
+}
 
-    n0 = grad( perm[ ix0 ], fx0 );
-    n1 = grad( perm[ ix1 ], fx1 );
-    return 0.188f * ( LERP( s, n0, n1 ) );
+
+float cgmath::NoiseContext::pnoise( float x, float y, float z, int px, int py, int pz ) const
+{
+    const float p[3] = { x, y, z };
+    const int period[3] = { px, py, pz };
+    int i[3][2];
+    float f[3][2], s[3];
+    lattice_cell<3>(p, period, (m_hash == INTEGER)? -1 : 0xff, i, f, s);
+    return cell_noise<3>(i, f, s);
 }
 
 
-float cgmath::pnoise( float x, float y, int px, int py ) {
+float cgmath::NoiseContext::pnoise( float x, float y, float z, float w, int px, int py, int pz, int pw ) const {
+    const float p[4] = { x, y, z, w };
+    const int period[4] = { px, py, pz, pw };
+    int i[4][2];
+    float f[4][2], s[4];
+    lattice_cell<4>(p, period, (m_hash == INTEGER)? -1 : 0xff, i, f, s);
+    return cell_noise<4>(i, f, s);
+}
+
+
+float cgmath::NoiseContext::noise64( double x ) const {
+    return noise64<1>(&x);
+}
+
+
+float cgmath::NoiseContext::noise64( double x, double y ) const {
+    const double p[2] = { x, y };
+    return noise64<2>(p);
+}
+
+
+float cgmath::NoiseContext::noise64( double x, double y, double z ) const {
+    const double p[3] = { x, y, z };
+    return noise64<3>(p);
+}
+
+
+float cgmath::NoiseContext::noise64( double x, double y, double z, double w ) const {
+    const double p[4] = { x, y, z, w };
+    return noise64<4>(p);
+}
+
+
+//  Noise with analytic derivatives. The lattice corners and the LERP()
+//  sequence are exactly those of noise(), so the value is identical.
+//  Each node of the interpolation carries its partial derivatives along,
+//  using d/dx LERP(s, a, b) = LERP(s, a', b') + s' (b - a); the
+//  derivatives of a corner term are the components of its gradient.
+
+#define DFADE(t) ( 30 * t * t * ( t * ( t - 2 ) + 1 ) )
+
+template <int D> struct GradNode {
+    float v;
+    float d[D];
+};
+
+
+static inline GradNode<2> grad_node( const float g[][512], int i, float x, float y ) {
+    GradNode<2> n;
+    for (int k = 0; k < 2; ++k) n.d[k] = g[k][i];
+    n.v = n.d[0] * x + n.d[1] * y;
+    return n;
+}
+
+
+static inline GradNode<3> grad_node( const float g[][512], int i, float x, float y, float z ) {
+    GradNode<3> n;
+    for (int k = 0; k < 3; ++k) n.d[k] = g[k][i];
+    n.v = n.d[0] * x + n.d[1] * y + n.d[2] * z;
+    return n;
+}
+
+
+static inline GradNode<4> grad_node( const float g[][512], int i, float x, float y, float z, float t ) {
+    GradNode<4> n;
+    for (int k = 0; k < 4; ++k) n.d[k] = g[k][i];
+    n.v = n.d[0] * x + n.d[1] * y + n.d[2] * z + n.d[3] * t;
+    return n;
+}
+
+
+template <int D> 
+static inline GradNode<D> lerp_node( float s, float ds, int axis, const GradNode<D>& a, const GradNode<D>& b ) {
+    GradNode<D> n;
+    n.v = LERP( s, a.v, b.v );
+    for (int k = 0; k < D; ++k) {
+        n.d[k] = LERP( s, a.d[k], b.d[k] );
+        if (k == axis) n.d[k] += ds * ( b.v - a.v );
+    }
+    return n;
+}
+
+
+template <int D> 
+static inline float scale_node( float c, const GradNode<D>& n, float *grad ) {
+    for (int k = 0; k < D; ++k) grad[k] = c * n.d[k];
+    return c * n.v;
+}
+
+
+// noise_grad() over the INTEGER lattice, the corners and interpolation
+// order of hashed_noise()
+template <int D> static float hashed_noise_grad( const float g[][32], uint32_t seed, const float *p, float *grad ) {
+    static const float scale[3] = { 0.507f, 0.936f, 0.87f };
+    int i[D][2];
+    float f[D][2], s[D], ds[D];
+    lattice_cell<D>(p, 0, -1, i, f, s);
+    for (int d = 0; d < D; ++d) ds[d] = DFADE( f[d][0] );
+
+    uint32_t h[1 << D];
+    hash_corners<D>(seed, i, h);
+
+    GradNode<D> n[1 << D];
+    for (int k = 0; k < (1 << D); ++k) {
+        int c = h[k] & 31;
+        for (int d = 0; d < D; ++d) n[k].d[d] = g[d][c];
+        n[k].v = n[k].d[0] * f[0][(k >> (D - 1)) & 1];
+        for (int d = 1; d < D; ++d) n[k].v += n[k].d[d] * f[d][(k >> (D - 1 - d)) & 1];
+    }
+
+    for (int d = D - 1; d >= 0; --d) {
+        for (int k = 0; k < (1 << d); ++k) n[k] = lerp_node( s[d], ds[d], d, n[2 * k], n[2 * k + 1] );
+    }
+    return scale_node( scale[D - 2], n[0], grad );
+}
+
+
+float cgmath::NoiseContext::noise_grad( float x, float y, float *grad ) const {
+    if (m_hash == INTEGER) {
+        const float p[2] = { x, y };
+        return hashed_noise_grad<2>(m_hash_grad + 1, m_seed, p, grad);
+    }
+    const float (*g)[512] = m_grad + 1;
     int ix0, iy0, ix1, iy1;
     float fx0, fy0, fx1, fy1;
-    float s, t, nx0, nx1, n0, n1;
+    float s, t, ds, dt;
+    GradNode<2> nx0, nx1, n0, n1;
 
     ix0 = FASTFLOOR( x ); // Integer part of x
     iy0 = FASTFLOOR( y ); // Integer part of y
@@ -324,32 +804,38 @@ float cgmath::pnoise( float x, float y, int px, int py ) {
     fy0 = y - iy0;        // Fractional part of y
     fx1 = fx0 - 1.0f;
     fy1 = fy0 - 1.0f;
-    ix1 = (( ix0 + 1 ) % px) & 0xff;  // Wrap to 0..px-1 and wrap to 0..255
-    iy1 = (( iy0 + 1 ) % py) & 0xff;  // Wrap to 0..py-1 and wrap to 0..255
-    ix0 = ( ix0 % px ) & 0xff;
-    iy0 = ( iy0 % py ) & 0xff;
-    
+    ix1 = (ix0 + 1) & 0xff;  // Wrap to 0..255
+    iy1 = (iy0 + 1) & 0xff;
+    ix0 = ix0 & 0xff;
+    iy0 = iy0 & 0xff;
+
     t = FADE( fy0 );
     s = FADE( fx0 );
+    dt = DFADE( fy0 );
+    ds = DFADE( fx0 );
 
-    nx0 = grad(perm[ix0 + perm[iy0]], fx0, fy0);
-    nx1 = grad(perm[ix0 + perm[iy1]], fx0, fy1);
-    n0 = LERP( t, nx0, nx1 );
+    nx0 = grad_node(g, ix0 + m_perm[iy0], fx0, fy0);
+    nx1 = grad_node(g, ix0 + m_perm[iy1], fx0, fy1);
+    n0 = lerp_node( t, dt, 1, nx0, nx1 );
 
-    nx0 = grad(perm[ix1 + perm[iy0]], fx1, fy0);
-    nx1 = grad(perm[ix1 + perm[iy1]], fx1, fy1);
-    n1 = LERP(t, nx0, nx1);
+    nx0 = grad_node(g, ix1 + m_perm[iy0], fx1, fy0);
+    nx1 = grad_node(g, ix1 + m_perm[iy1], fx1, fy1);
+    n1 = lerp_node( t, dt, 1, nx0, nx1 );
 
-    return 0.507f * ( LERP( s, n0, n1 ) );
+    return scale_node( 0.507f, lerp_node( s, ds, 0, n0, n1 ), grad );
 }
 
 
-float cgmath::pnoise( float x, float y, float z, int px, int py, int pz )
-{
+float cgmath::NoiseContext::noise_grad( float x, float y, float z, float *grad ) const {
+    if (m_hash == INTEGER) {
+        const float p[3] = { x, y, z };
+        return hashed_noise_grad<3>(m_hash_grad + 3, m_seed, p, grad);
+    }
+    const float (*g)[512] = m_grad + 3;
     int ix0, iy0, ix1, iy1, iz0, iz1;
     float fx0, fy0, fz0, fx1, fy1, fz1;
-    float s, t, r;
-    float nxy0, nxy1, nx0, nx1, n0, n1;
+    float s, t, r, ds, dt, dr;
+    GradNode<3> nxy0, nxy1, nx0, nx1, n0, n1;
 
     ix0 = FASTFLOOR( x ); // Integer part of x
     iy0 = FASTFLOOR( y ); // Integer part of y
@@ -360,46 +846,54 @@ float cgmath::pnoise( float x, float y, float z, int px, int py, int pz )
     fx1 = fx0 - 1.0f;
     fy1 = fy0 - 1.0f;
     fz1 = fz0 - 1.0f;
-    ix1 = (( ix0 + 1 ) % px ) & 0xff; // Wrap to 0..px-1 and wrap to 0..255
-    iy1 = (( iy0 + 1 ) % py ) & 0xff; // Wrap to 0..py-1 and wrap to 0..255
-    iz1 = (( iz0 + 1 ) % pz ) & 0xff; // Wrap to 0..pz-1 and wrap to 0..255
-    ix0 = ( ix0 % px ) & 0xff;
-    iy0 = ( iy0 % py ) & 0xff;
-    iz0 = ( iz0 % pz ) & 0xff;
-    
+    ix1 = ( ix0 + 1 ) & 0xff; // Wrap to 0..255
+    iy1 = ( iy0 + 1 ) & 0xff;
+    iz1 = ( iz0 + 1 ) & 0xff;
+    ix0 = ix0 & 0xff;
+    iy0 = iy0 & 0xff;
+    iz0 = iz0 & 0xff;
+
     r = FADE( fz0 );
     t = FADE( fy0 );
     s = FADE( fx0 );
+    dr = DFADE( fz0 );
+    dt = DFADE( fy0 );
+    ds = DFADE( fx0 );
 
-    nxy0 = grad(perm[ix0 + perm[iy0 + perm[iz0]]], fx0, fy0, fz0);
-    nxy1 = grad(perm[ix0 + perm[iy0 + perm[iz1]]], fx0, fy0, fz1);
-    nx0 = LERP( r, nxy0, nxy1 );
+    nxy0 = grad_node(g, ix0 + m_perm[iy0 + m_perm[iz0]], fx0, fy0, fz0);
+    nxy1 = grad_node(g, ix0 + m_perm[iy0 + m_perm[iz1]], fx0, fy0, fz1);
+    nx0 = lerp_node( r, dr, 2, nxy0, nxy1 );
 
-    nxy0 = grad(perm[ix0 + perm[iy1 + perm[iz0]]], fx0, fy1, fz0);
-    nxy1 = grad(perm[ix0 + perm[iy1 + perm[iz1]]], fx0, fy1, fz1);
-    nx1 = LERP( r, nxy0, nxy1 );
+    nxy0 = grad_node(g, ix0 + m_perm[iy1 + m_perm[iz0]], fx0, fy1, fz0);
+    nxy1 = grad_node(g, ix0 + m_perm[iy1 + m_perm[iz1]], fx0, fy1, fz1);
+    nx1 = lerp_node( r, dr, 2, nxy0, nxy1 );
 
-    n0 = LERP( t, nx0, nx1 );
+    n0 = lerp_node( t, dt, 1, nx0, nx1 );
 
-    nxy0 = grad(perm[ix1 + perm[iy0 + perm[iz0]]], fx1, fy0, fz0);
-    nxy1 = grad(perm[ix1 + perm[iy0 + perm[iz1]]], fx1, fy0, fz1);
-    nx0 = LERP( r, nxy0, nxy1 );
+    nxy0 = grad_node(g, ix1 + m_perm[iy0 + m_perm[iz0]], fx1, fy0, fz0);
+    nxy1 = grad_node(g, ix1 + m_perm[iy0 + m_perm[iz1]], fx1, fy0, fz1);
+    nx0 = lerp_node( r, dr, 2, nxy0, nxy1 );
 
-    nxy0 = grad(perm[ix1 + perm[iy1 + perm[iz0]]], fx1, fy1, fz0);
-    nxy1 = grad(perm[ix1 + perm[iy1 + perm[iz1]]], fx1, fy1, fz1);
-    nx1 = LERP( r, nxy0, nxy1 );
+    nxy0 = grad_node(g, ix1 + m_perm[iy1 + m_perm[iz0]], fx1, fy1, fz0);
+    nxy1 = grad_node(g, ix1 + m_perm[iy1 + m_perm[iz1]], fx1, fy1, fz1);
+    nx1 = lerp_node( r, dr, 2, nxy0, nxy1 );
 
-    n1 = LERP( t, nx0, nx1 );
-    
-    return 0.936f * ( LERP( s, n0, n1 ) );
+    n1 = lerp_node( t, dt, 1, nx0, nx1 );
+
+    return scale_node( 0.936f, lerp_node( s, ds, 0, n0, n1 ), grad );
 }
 
 
-float cgmath::pnoise( float x, float y, float z, float w, int px, int py, int pz, int pw ) {
+float cgmath::NoiseContext::noise_grad( float x, float y, float z, float w, float *grad ) const {
+    if (m_hash == INTEGER) {
+        const float p[4] = { x, y, z, w };
+        return hashed_noise_grad<4>(m_hash_grad + 6, m_seed, p, grad);
+    }
+    const float (*g)[512] = m_grad + 6;
     int ix0, iy0, iz0, iw0, ix1, iy1, iz1, iw1;
     float fx0, fy0, fz0, fw0, fx1, fy1, fz1, fw1;
-    float s, t, r, q;
-    float nxyz0, nxyz1, nxy0, nxy1, nx0, nx1, n0, n1;
+    float s, t, r, q, ds, dt, dr, dq;
+    GradNode<4> nxyz0, nxyz1, nxy0, nxy1, nx0, nx1, n0, n1;
 
     ix0 = FASTFLOOR( x ); // Integer part of x
     iy0 = FASTFLOOR( y ); // Integer part of y
@@ -413,63 +907,1836 @@ float cgmath::pnoise( float x, float y, float z, float w, int px, int py, int pz
     fy1 = fy0 - 1.0f;
     fz1 = fz0 - 1.0f;
     fw1 = fw0 - 1.0f;
-    ix1 = (( ix0 + 1 ) % px ) & 0xff;  // Wrap to 0..px-1 and wrap to 0..255
-    iy1 = (( iy0 + 1 ) % py ) & 0xff;  // Wrap to 0..py-1 and wrap to 0..255
-    iz1 = (( iz0 + 1 ) % pz ) & 0xff;  // Wrap to 0..pz-1 and wrap to 0..255
-    iw1 = (( iw0 + 1 ) % pw ) & 0xff;  // Wrap to 0..pw-1 and wrap to 0..255
-    ix0 = ( ix0 % px ) & 0xff;
-    iy0 = ( iy0 % py ) & 0xff;
-    iz0 = ( iz0 % pz ) & 0xff;
-    iw0 = ( iw0 % pw ) & 0xff;
+    ix1 = ( ix0 + 1 ) & 0xff;  // Wrap to 0..255
+    iy1 = ( iy0 + 1 ) & 0xff;
+    iz1 = ( iz0 + 1 ) & 0xff;
+    iw1 = ( iw0 + 1 ) & 0xff;
+    ix0 = ix0 & 0xff;
+    iy0 = iy0 & 0xff;
+    iz0 = iz0 & 0xff;
+    iw0 = iw0 & 0xff;
 
     q = FADE( fw0 );
     r = FADE( fz0 );
     t = FADE( fy0 );
     s = FADE( fx0 );
+    dq = DFADE( fw0 );
+    dr = DFADE( fz0 );
+    dt = DFADE( fy0 );
+    ds = DFADE( fx0 );
 
-    nxyz0 = grad(perm[ix0 + perm[iy0 + perm[iz0 + perm[iw0]]]], fx0, fy0, fz0, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy0 + perm[iz0 + perm[iw1]]]], fx0, fy0, fz0, fw1);
-    nxy0 = LERP( q, nxyz0, nxyz1 );
-        
-    nxyz0 = grad(perm[ix0 + perm[iy0 + perm[iz1 + perm[iw0]]]], fx0, fy0, fz1, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy0 + perm[iz1 + perm[iw1]]]], fx0, fy0, fz1, fw1);
-    nxy1 = LERP( q, nxyz0, nxyz1 );
-        
-    nx0 = LERP ( r, nxy0, nxy1 );
+    nxyz0 = grad_node(g, ix0 + m_perm[iy0 + m_perm[iz0 + m_perm[iw0]]], fx0, fy0, fz0, fw0);
+    nxyz1 = grad_node(g, ix0 + m_perm[iy0 + m_perm[iz0 + m_perm[iw1]]], fx0, fy0, fz0, fw1);
+    nxy0 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
 
-    nxyz0 = grad(perm[ix0 + perm[iy1 + perm[iz0 + perm[iw0]]]], fx0, fy1, fz0, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy1 + perm[iz0 + perm[iw1]]]], fx0, fy1, fz0, fw1);
-    nxy0 = LERP( q, nxyz0, nxyz1 );
-        
-    nxyz0 = grad(perm[ix0 + perm[iy1 + perm[iz1 + perm[iw0]]]], fx0, fy1, fz1, fw0);
-    nxyz1 = grad(perm[ix0 + perm[iy1 + perm[iz1 + perm[iw1]]]], fx0, fy1, fz1, fw1);
-    nxy1 = LERP( q, nxyz0, nxyz1 );
+    nxyz0 = grad_node(g, ix0 + m_perm[iy0 + m_perm[iz1 + m_perm[iw0]]], fx0, fy0, fz1, fw0);
+    nxyz1 = grad_node(g, ix0 + m_perm[iy0 + m_perm[iz1 + m_perm[iw1]]], fx0, fy0, fz1, fw1);
+    nxy1 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
 
-    nx1 = LERP ( r, nxy0, nxy1 );
+    nx0 = lerp_node( r, dr, 2, nxy0, nxy1 );
 
-    n0 = LERP( t, nx0, nx1 );
+    nxyz0 = grad_node(g, ix0 + m_perm[iy1 + m_perm[iz0 + m_perm[iw0]]], fx0, fy1, fz0, fw0);
+    nxyz1 = grad_node(g, ix0 + m_perm[iy1 + m_perm[iz0 + m_perm[iw1]]], fx0, fy1, fz0, fw1);
+    nxy0 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
 
-    nxyz0 = grad(perm[ix1 + perm[iy0 + perm[iz0 + perm[iw0]]]], fx1, fy0, fz0, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy0 + perm[iz0 + perm[iw1]]]], fx1, fy0, fz0, fw1);
-    nxy0 = LERP( q, nxyz0, nxyz1 );
-        
-    nxyz0 = grad(perm[ix1 + perm[iy0 + perm[iz1 + perm[iw0]]]], fx1, fy0, fz1, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy0 + perm[iz1 + perm[iw1]]]], fx1, fy0, fz1, fw1);
-    nxy1 = LERP( q, nxyz0, nxyz1 );
+    nxyz0 = grad_node(g, ix0 + m_perm[iy1 + m_perm[iz1 + m_perm[iw0]]], fx0, fy1, fz1, fw0);
+    nxyz1 = grad_node(g, ix0 + m_perm[iy1 + m_perm[iz1 + m_perm[iw1]]], fx0, fy1, fz1, fw1);
+    nxy1 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
 
-    nx0 = LERP ( r, nxy0, nxy1 );
+    nx1 = lerp_node( r, dr, 2, nxy0, nxy1 );
 
-    nxyz0 = grad(perm[ix1 + perm[iy1 + perm[iz0 + perm[iw0]]]], fx1, fy1, fz0, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy1 + perm[iz0 + perm[iw1]]]], fx1, fy1, fz0, fw1);
-    nxy0 = LERP( q, nxyz0, nxyz1 );
-        
-    nxyz0 = grad(perm[ix1 + perm[iy1 + perm[iz1 + perm[iw0]]]], fx1, fy1, fz1, fw0);
-    nxyz1 = grad(perm[ix1 + perm[iy1 + perm[iz1 + perm[iw1]]]], fx1, fy1, fz1, fw1);
-    nxy1 = LERP( q, nxyz0, nxyz1 );
+    n0 = lerp_node( t, dt, 1, nx0, nx1 );
 
-    nx1 = LERP ( r, nxy0, nxy1 );
+    nxyz0 = grad_node(g, ix1 + m_perm[iy0 + m_perm[iz0 + m_perm[iw0]]], fx1, fy0, fz0, fw0);
+    nxyz1 = grad_node(g, ix1 + m_perm[iy0 + m_perm[iz0 + m_perm[iw1]]], fx1, fy0, fz0, fw1);
+    nxy0 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
 
-    n1 = LERP( t, nx0, nx1 );
+    nxyz0 = grad_node(g, ix1 + m_perm[iy0 + m_perm[iz1 + m_perm[iw0]]], fx1, fy0, fz1, fw0);
+    nxyz1 = grad_node(g, ix1 + m_perm[iy0 + m_perm[iz1 + m_perm[iw1]]], fx1, fy0, fz1, fw1);
+    nxy1 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
 
-    return 0.87f * ( LERP( s, n0, n1 ) );
+    nx0 = lerp_node( r, dr, 2, nxy0, nxy1 );
+
+    nxyz0 = grad_node(g, ix1 + m_perm[iy1 + m_perm[iz0 + m_perm[iw0]]], fx1, fy1, fz0, fw0);
+    nxyz1 = grad_node(g, ix1 + m_perm[iy1 + m_perm[iz0 + m_perm[iw1]]], fx1, fy1, fz0, fw1);
+    nxy0 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
+
+    nxyz0 = grad_node(g, ix1 + m_perm[iy1 + m_perm[iz1 + m_perm[iw0]]], fx1, fy1, fz1, fw0);
+    nxyz1 = grad_node(g, ix1 + m_perm[iy1 + m_perm[iz1 + m_perm[iw1]]], fx1, fy1, fz1, fw1);
+    nxy1 = lerp_node( q, dq, 3, nxyz0, nxyz1 );
+
+    nx1 = lerp_node( r, dr, 2, nxy0, nxy1 );
+
+    n1 = lerp_node( t, dt, 1, nx0, nx1 );
+
+    return scale_node( 0.87f, lerp_node( s, ds, 0, n0, n1 ), grad );
+}
+
+
+//  Simplex noise. Each corner of the simplex containing the sample point
+//  contributes (r^2 - d^2)^4 (g . d), using the same hashing and
+//  gradients as noise(). In 2D and 3D the lattices are chosen such that
+//  their corners have rational coordinates in texture space, which allows
+//  wrapping them to integer periods (see "Tiling simplex noise and flow
+//  noise in two and three dimensions", Gustavson and McEwan, JCGT 2022):
+//  2D uses a sheared square lattice with corner (i,j) at (i - j/2, j),
+//  3D a body-centered cubic lattice with corner (a,b,c) at
+//  ((b + c - a)/2, (a + c - b)/2, (a + b - c)/2). 4D uses the classic
+//  skewed simplex lattice, which cannot be wrapped to axis aligned periods.
+
+// Falloff radius^2, and output scale (empirically determined) to map
+// the noise to [-1,1]
+#define R2_2D 0.8f
+#define R2_3D 0.5f
+#define R2_4D 0.6f
+#define SCALE_2D 5.29f
+#define SCALE_3D 76.8f
+#define SCALE_4D 27.2f
+
+// Skewing factors of the 4D lattice
+#define F4 0.309016994f // F4 = (sqrt(5.0)-1.0)/4.0
+#define G4 0.138196601f // G4 = (5.0-sqrt(5.0))/20.0
+
+static inline int ifloor( float x ) {
+    int i = static_cast<int>(x);
+    return (x < i)? i - 1 : i;
+}
+
+
+static inline int floor_mod( int a, int p ) {
+    int r = a % p;
+    return (r < 0)? r + p : r;
+}
+
+
+// Wraps corner (i,j) of the 2D lattice to periods px and py (0 = none).
+// The doubled texture coordinates (2i - j, j) are integers, so the
+// wrapped corner is again a lattice corner if py is even; odd py are
+// rounded up.
+static inline void wrap2( int *i, int *j, int px, int py ) {
+    int x = 2 * *i - *j;
+    int y = *j;
+    if (px > 0) x = floor_mod(x, 2 * px);
+    if (py > 0) y = floor_mod(y, py + (py & 1));
+    *i = (x + y) / 2;
+    *j = y;
+}
+
+
+// Wraps corner (a,b,c) of the 3D lattice to periods px, py and pz (0 = none)
+static inline void wrap3( int *a, int *b, int *c, int px, int py, int pz ) {
+    int x = *b + *c - *a;
+    int y = *a + *c - *b;
+    int z = *a + *b - *c;
+    if (px > 0) x = floor_mod(x, 2 * px);
+    if (py > 0) y = floor_mod(y, 2 * py);
+    if (pz > 0) z = floor_mod(z, 2 * pz);
+    *a = (y + z) / 2;
+    *b = (x + z) / 2;
+    *c = (x + y) / 2;
+}
+
+
+static inline float falloff( float t, float d ) {
+    t = (t < 0)? 0 : t;
+    t = t * t;
+    return t * t * d;
+}
+
+
+static float simplex( const int *perm, const float g[][512], float x, float y, int px, int py ) {
+    int i[3], j[3];
+    float n = 0;
+
+    // Lattice coordinates (u,v) = (x + y/2, y) and the simplex containing them
+    float u = x + 0.5f * y;
+    i[0] = ifloor( u );
+    j[0] = ifloor( y );
+    bool lower = ( u - i[0] ) >= ( y - j[0] );
+    i[1] = lower? i[0] + 1 : i[0];
+    j[1] = lower? j[0] : j[0] + 1;
+    i[2] = i[0] + 1;
+    j[2] = j[0] + 1;
+
+    for (int k = 0; k < 3; ++k) {
+        float dx = x - ( i[k] - 0.5f * j[k] );
+        float dy = y - j[k];
+        if (px > 0 || py > 0) wrap2(&i[k], &j[k], px, py);
+        int h = ( i[k] & 0xff ) + perm[j[k] & 0xff];
+        n += falloff( R2_2D - dx * dx - dy * dy, grad(g, h, dx, dy) );
+    }
+    return SCALE_2D * n;
+}
+
+
+static float simplex( const int *perm, const float g[][512], float x, float y, float z, int px, int py, int pz ) {
+    int a[4], b[4], c[4];
+    float n = 0;
+
+    float u = y + z;
+    float v = x + z;
+    float w = x + y;
+    a[0] = ifloor( u );
+    b[0] = ifloor( v );
+    c[0] = ifloor( w );
+    float fu = u - a[0];
+    float fv = v - b[0];
+    float fw = w - c[0];
+
+    // Corners 1 and 2 step along the largest and the two largest of fu, fv, fw
+    int uv = ( fu > fv )? 1 : 0;
+    int vw = ( fv > fw )? 1 : 0;
+    int uw = ( fu > fw )? 1 : 0;
+    a[1] = a[0] + ( uv & uw );
+    b[1] = b[0] + ( (1 - uv) & vw );
+    c[1] = c[0] + ( (1 - uw) & (1 - vw) );
+    a[2] = a[0] + 1 - ( (1 - uv) & (1 - uw) );
+    b[2] = b[0] + 1 - ( uv & (1 - vw) );
+    c[2] = c[0] + 1 - ( uw & vw );
+    a[3] = a[0] + 1;
+    b[3] = b[0] + 1;
+    c[3] = c[0] + 1;
+
+    for (int k = 0; k < 4; ++k) {
+        float dx = x - 0.5f * ( b[k] + c[k] - a[k] );
+        float dy = y - 0.5f * ( a[k] + c[k] - b[k] );
+        float dz = z - 0.5f * ( a[k] + b[k] - c[k] );
+        if (px > 0 || py > 0 || pz > 0) wrap3(&a[k], &b[k], &c[k], px, py, pz);
+        int h = ( a[k] & 0xff ) + perm[( b[k] & 0xff ) + perm[c[k] & 0xff]];
+        n += falloff( R2_3D - dx * dx - dy * dy - dz * dz, grad(g, h, dx, dy, dz) );
+    }
+    return SCALE_3D * n;
+}
+
+
+static float simplex( const int *perm, const float g[][512], float x, float y, float z, float w ) {
+    float n0, n1, n2, n3, n4;
+
+    // Skew the input space to determine which simplex cell we're in
+    float s = ( x + y + z + w ) * F4;
+    int i = ifloor( x + s );
+    int j = ifloor( y + s );
+    int k = ifloor( z + s );
+    int l = ifloor( w + s );
+    float t = ( i + j + k + l ) * G4;
+    float x0 = x - ( i - t );
+    float y0 = y - ( j - t );
+    float z0 = z - ( k - t );
+    float w0 = w - ( l - t );
+
+    // The magnitude ordering of x0, y0, z0 and w0 determines the simplex:
+    // the corners step along the axis of rank 3 first, then rank 2 and 1.
+    int xy = ( x0 > y0 )? 1 : 0;
+    int xz = ( x0 > z0 )? 1 : 0;
+    int xw = ( x0 > w0 )? 1 : 0;
+    int yz = ( y0 > z0 )? 1 : 0;
+    int yw = ( y0 > w0 )? 1 : 0;
+    int zw = ( z0 > w0 )? 1 : 0;
+    int rx = xy + xz + xw;
+    int ry = ( 1 - xy ) + yz + yw;
+    int rz = ( 1 - xz ) + ( 1 - yz ) + zw;
+    int rw = ( 1 - xw ) + ( 1 - yw ) + ( 1 - zw );
+    int i1 = rx >= 3, j1 = ry >= 3, k1 = rz >= 3, l1 = rw >= 3;
+    int i2 = rx >= 2, j2 = ry >= 2, k2 = rz >= 2, l2 = rw >= 2;
+    int i3 = rx >= 1, j3 = ry >= 1, k3 = rz >= 1, l3 = rw >= 1;
+
+    // Offsets of the remaining corners in (x,y,z,w) coords
+    float x1 = x0 - i1 + G4;
+    float y1 = y0 - j1 + G4;
+    float z1 = z0 - k1 + G4;
+    float w1 = w0 - l1 + G4;
+    float x2 = x0 - i2 + 2.0f * G4;
+    float y2 = y0 - j2 + 2.0f * G4;
+    float z2 = z0 - k2 + 2.0f * G4;
+    float w2 = w0 - l2 + 2.0f * G4;
+    float x3 = x0 - i3 + 3.0f * G4;
+    float y3 = y0 - j3 + 3.0f * G4;
+    float z3 = z0 - k3 + 3.0f * G4;
+    float w3 = w0 - l3 + 3.0f * G4;
+    float x4 = x0 - 1.0f + 4.0f * G4;
+    float y4 = y0 - 1.0f + 4.0f * G4;
+    float z4 = z0 - 1.0f + 4.0f * G4;
+    float w4 = w0 - 1.0f + 4.0f * G4;
+
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    int kk = k & 0xff;
+    int ll = l & 0xff;
+
+    n0 = falloff( R2_4D - x0 * x0 - y0 * y0 - z0 * z0 - w0 * w0, 
+                  grad(g, ii + perm[jj + perm[kk + perm[ll]]], x0, y0, z0, w0) );
+    n1 = falloff( R2_4D - x1 * x1 - y1 * y1 - z1 * z1 - w1 * w1, 
+                  grad(g, ii + i1 + perm[jj + j1 + perm[kk + k1 + perm[ll + l1]]], x1, y1, z1, w1) );
+    n2 = falloff( R2_4D - x2 * x2 - y2 * y2 - z2 * z2 - w2 * w2, 
+                  grad(g, ii + i2 + perm[jj + j2 + perm[kk + k2 + perm[ll + l2]]], x2, y2, z2, w2) );
+    n3 = falloff( R2_4D - x3 * x3 - y3 * y3 - z3 * z3 - w3 * w3, 
+                  grad(g, ii + i3 + perm[jj + j3 + perm[kk + k3 + perm[ll + l3]]], x3, y3, z3, w3) );
+    n4 = falloff( R2_4D - x4 * x4 - y4 * y4 - z4 * z4 - w4 * w4, 
+                  grad(g, ii + 1 + perm[jj + 1 + perm[kk + 1 + perm[ll + 1]]], x4, y4, z4, w4) );
+
+    return SCALE_4D * ( n0 + n1 + n2 + n3 + n4 );
+}
+
+
+float cgmath::NoiseContext::snoise( float x, float y ) const {
+    return simplex(m_perm, m_grad + 1, x, y, 0, 0);
+}
+
+
+float cgmath::NoiseContext::snoise( float x, float y, float z ) const {
+    return simplex(m_perm, m_grad + 3, x, y, z, 0, 0, 0);
+}
+
+
+float cgmath::NoiseContext::snoise( float x, float y, float z, float w ) const {
+    return simplex(m_perm, m_grad + 6, x, y, z, w);
+}
+
+
+float cgmath::NoiseContext::psnoise( float x, float y, int px, int py ) const {
+    return simplex(m_perm, m_grad + 1, x, y, px, py);
+}
+
+
+float cgmath::NoiseContext::psnoise( float x, float y, float z, int px, int py, int pz ) const {
+    return simplex(m_perm, m_grad + 3, x, y, z, px, py, pz);
+}
+
+
+float cgmath::noise( float x ) {
+    return default_noise_context().noise(x);
+}
+
+
+float cgmath::noise( float x, float y ) {
+    return default_noise_context().noise(x, y);
+}
+
+
+float cgmath::noise( float x, float y, float z ) {
+    return default_noise_context().noise(x, y, z);
+}
+
+
+float cgmath::noise( float x, float y, float z, float w ) {
+    return default_noise_context().noise(x, y, z, w);
+}
+
+
+float cgmath::pnoise( float x, int px ) {
+    return default_noise_context().pnoise(x, px);
+}
+
+
+float cgmath::pnoise( float x, float y, int px, int py ) {
+    return default_noise_context().pnoise(x, y, px, py);
+}
+
+
+float cgmath::pnoise( float x, float y, float z, int px, int py, int pz ) {
+    return default_noise_context().pnoise(x, y, z, px, py, pz);
+}
+
+
+float cgmath::pnoise( float x, float y, float z, float w, int px, int py, int pz, int pw ) {
+    return default_noise_context().pnoise(x, y, z, w, px, py, pz, pw);
+}
+
+
+float cgmath::noise64( double x ) {
+    return default_noise_context().noise64(x);
+}
+
+
+float cgmath::noise64( double x, double y ) {
+    return default_noise_context().noise64(x, y);
+}
+
+
+float cgmath::noise64( double x, double y, double z ) {
+    return default_noise_context().noise64(x, y, z);
+}
+
+
+float cgmath::noise64( double x, double y, double z, double w ) {
+    return default_noise_context().noise64(x, y, z, w);
+}
+
+float cgmath::noise_grad( float x, float y, float *grad ) {
+    return default_noise_context().noise_grad(x, y, grad);
+}
+
+
+float cgmath::noise_grad( float x, float y, float z, float *grad ) {
+    return default_noise_context().noise_grad(x, y, z, grad);
+}
+
+
+float cgmath::noise_grad( float x, float y, float z, float w, float *grad ) {
+    return default_noise_context().noise_grad(x, y, z, w, grad);
+}
+
+float cgmath::snoise( float x, float y ) {
+    return default_noise_context().snoise(x, y);
+}
+
+
+float cgmath::snoise( float x, float y, float z ) {
+    return default_noise_context().snoise(x, y, z);
+}
+
+
+float cgmath::snoise( float x, float y, float z, float w ) {
+    return default_noise_context().snoise(x, y, z, w);
+}
+
+
+float cgmath::psnoise( float x, float y, int px, int py ) {
+    return default_noise_context().psnoise(x, y, px, py);
+}
+
+
+float cgmath::psnoise( float x, float y, float z, int px, int py, int pz ) {
+    return default_noise_context().psnoise(x, y, z, px, py, pz);
+}
+
+//  Batch evaluation. The kernels below are lane-parallel transcriptions
+//  of the scalar functions above: every arithmetic step is performed in
+//  the same order, so the results are identical to calling noise() or
+//  pnoise() for each point. Instead of gathering the tabulated gradient
+//  components, they derive the gradient from the hash bits with selects,
+//  which yields the same products at the cost of a single gather per
+//  lattice corner. Remainders that do not fill a complete SIMD register
+//  are handed over to the scalar functions.
+
+namespace {
+namespace batch {
+
+    using namespace cgmath::simd;
+
+    inline vfloat fade( vfloat t ) {
+        return mul(mul(mul(t, t), t), add(mul(t, sub(mul(t, splat(6.0f)), splat(15.0f))), splat(10.0f)));
+    }
+
+    inline vfloat lerp( vfloat t, vfloat a, vfloat b ) {
+        return add(a, mul(t, sub(b, a)));
+    }
+
+    inline vint hash( const int *perm, vint a ) {
+        return gather(perm, a);
+    }
+
+    inline vint hash( const int *perm, vint a, vint b ) {
+        return gather(perm, add(a, b));
+    }
+
+    inline vfloat grad( vint hash, vfloat x ) {
+        vint h = bit_and(hash, splat(15));
+        vfloat g = add(splat(1.0f), to_float(bit_and(h, splat(7))));
+        return mul(negate_if(test_bit(h, 8), g), x);
+    }
+
+    inline vfloat grad( vint hash, vfloat x, vfloat y ) {
+        vint h = bit_and(hash, splat(7));
+        vmask m = cmp_lt(h, splat(4));
+        vfloat u = select(m, x, y);
+        vfloat v = select(m, y, x);
+        return add(negate_if(test_bit(h, 1), u), negate_if(test_bit(h, 2), mul(splat(2.0f), v)));
+    }
+
+    inline vfloat grad( vint hash, vfloat x, vfloat y, vfloat z ) {
+        vint h = bit_and(hash, splat(15));
+        vfloat u = select(cmp_lt(h, splat(8)), x, y);
+        vfloat v = select(cmp_lt(h, splat(4)), y, 
+                          select(mask_or(cmp_eq(h, splat(12)), cmp_eq(h, splat(14))), x, z));
+        return add(negate_if(test_bit(h, 1), u), negate_if(test_bit(h, 2), v));
+    }
+
+    inline vfloat grad( vint hash, vfloat x, vfloat y, vfloat z, vfloat t ) {
+        vint h = bit_and(hash, splat(31));
+        vfloat u = select(cmp_lt(h, splat(24)), x, y);
+        vfloat v = select(cmp_lt(h, splat(16)), y, z);
+        vfloat w = select(cmp_lt(h, splat(8)), z, t);
+        return add(add(negate_if(test_bit(h, 1), u), negate_if(test_bit(h, 2), v)), negate_if(test_bit(h, 4), w));
+    }
+
+    // Lattice hash through the permutation table
+    struct PermutationHash {
+        explicit PermutationHash( const int *p ) : perm(p) {}
+
+        vint operator()( vint a ) const { return gather(perm, a); }
+        vint operator()( vint a, vint b ) const { return gather(perm, add(a, b)); }
+
+        // Scalar hash, and the gradient table index of corner hash index a.
+        // Hashes are combined in unsigned arithmetic, like hashed_noise().
+        uint32_t scalar( uint32_t a ) const { return static_cast<uint32_t>(perm[a]); }
+        int index( uint32_t a ) const { return static_cast<int>(a); }
+
+        const int *perm;
+    };
+
+    // Gather-free INTEGER lattice hash, see mix()
+    struct IntegerHash {
+        explicit IntegerHash( uint32_t s ) : seed(splat(static_cast<int>(s))), s(s) {}
+
+        vint operator()( vint a ) const {
+            vint x = bit_xor(a, seed);
+            x = bit_xor(x, shift_right(x, 16));
+            x = mul(x, splat(0x7feb352d));
+            x = bit_xor(x, shift_right(x, 15));
+            x = mul(x, splat(static_cast<int>(0x846ca68bu)));
+            return bit_xor(x, shift_right(x, 16));
+        }
+
+        vint operator()( vint a, vint b ) const { return (*this)(add(a, b)); }
+
+        uint32_t scalar( uint32_t a ) const { return mix(a ^ s); }
+        int index( uint32_t a ) const { return static_cast<int>(scalar(a) & 31); }
+
+        vint seed;
+        uint32_t s;
+    };
+
+    // Wraps a lattice coordinate to 0..255, or not at all with a mask of -1
+    struct Wrap {
+        explicit Wrap( int m = 0xff ) : mask(m) {}
+
+        void operator()( vint i, int, vint *i0, vint *i1 ) const {
+            *i1 = bit_and(add(i, splat(1)), splat(mask));
+            *i0 = bit_and(i, splat(mask));
+        }
+
+        int mask;
+    };
+
+    // Wraps a lattice coordinate to 0..p-1 and 0..255, like pnoise(). 
+    // Periods of 0 only apply the mask.
+    struct PeriodicWrap {
+        explicit PeriodicWrap( const int *period, int m = 0xff ) : p(period), mask(m) {}
+
+        void operator()( vint i, int axis, vint *i0, vint *i1 ) const {
+            int a[width], b[width];
+            int pa = p[axis];
+            store(a, i);
+            for (int k = 0; k < width; ++k) {
+                if (pa > 0) {
+                    b[k] = (( a[k] + 1 ) % pa ) & mask;
+                    a[k] = ( a[k] % pa ) & mask;
+                } else {
+                    b[k] = ( a[k] + 1 ) & mask;
+                    a[k] = a[k] & mask;
+                }
+            }
+            *i0 = load(a);
+            *i1 = load(b);
+        }
+
+        const int *p;
+        int mask;
+    };
+
+    // noise() in the lattice cell with lower corner i and offsets f from it
+    template <typename H, typename W> 
+    inline vfloat noise_cell( const H& hash, vint ix, vfloat fx0, const W& wrap ) {
+        vfloat fx1 = sub(fx0, splat(1.0f));
+        vint ix0, ix1;
+        wrap(ix, 0, &ix0, &ix1);
+
+        vfloat s = fade(fx0);
+
+        vfloat n0 = grad(hash(ix0), fx0);
+        vfloat n1 = grad(hash(ix1), fx1);
+        return mul(splat(0.188f), lerp(s, n0, n1));
+    }
+
+    template <typename H, typename W> inline vfloat noise( const H& hash, vfloat x, const W& wrap ) {
+        vint ix = fast_floor(x);
+        vfloat fx0 = sub(x, to_float(ix));
+        return noise_cell(hash, ix, fx0, wrap);
+    }
+
+    template <typename H, typename W> 
+    inline vfloat noise_cell( const H& hash, vint ix, vfloat fx0, vint iy, vfloat fy0, const W& wrap ) {
+        vfloat fx1 = sub(fx0, splat(1.0f));
+        vfloat fy1 = sub(fy0, splat(1.0f));
+        vint ix0, ix1, iy0, iy1;
+        wrap(ix, 0, &ix0, &ix1);
+        wrap(iy, 1, &iy0, &iy1);
+
+        vfloat t = fade(fy0);
+        vfloat s = fade(fx0);
+
+        vint py0 = hash(iy0);
+        vint py1 = hash(iy1);
+
+        vfloat n0 = lerp(t, grad(hash(ix0, py0), fx0, fy0), grad(hash(ix0, py1), fx0, fy1));
+        vfloat n1 = lerp(t, grad(hash(ix1, py0), fx1, fy0), grad(hash(ix1, py1), fx1, fy1));
+        return mul(splat(0.507f), lerp(s, n0, n1));
+    }
+
+    template <typename H, typename W> inline vfloat noise( const H& hash, vfloat x, vfloat y, const W& wrap ) {
+        vint ix = fast_floor(x);
+        vint iy = fast_floor(y);
+        vfloat fx0 = sub(x, to_float(ix));
+        vfloat fy0 = sub(y, to_float(iy));
+        return noise_cell(hash, ix, fx0, iy, fy0, wrap);
+    }
+
+    template <typename H, typename W> 
+    inline vfloat noise_cell( const H& hash, vint ix, vfloat fx0, vint iy, vfloat fy0, vint iz, vfloat fz0, const W& wrap ) {
+        vfloat fx1 = sub(fx0, splat(1.0f));
+        vfloat fy1 = sub(fy0, splat(1.0f));
+        vfloat fz1 = sub(fz0, splat(1.0f));
+        vint ix0, ix1, iy0, iy1, iz0, iz1;
+        wrap(ix, 0, &ix0, &ix1);
+        wrap(iy, 1, &iy0, &iy1);
+        wrap(iz, 2, &iz0, &iz1);
+
+        vfloat r = fade(fz0);
+        vfloat t = fade(fy0);
+        vfloat s = fade(fx0);
+
+        vint pz0 = hash(iz0);
+        vint pz1 = hash(iz1);
+        vint py00 = hash(iy0, pz0);
+        vint py01 = hash(iy0, pz1);
+        vint py10 = hash(iy1, pz0);
+        vint py11 = hash(iy1, pz1);
+
+        vfloat nx0 = lerp(r, grad(hash(ix0, py00), fx0, fy0, fz0), grad(hash(ix0, py01), fx0, fy0, fz1));
+        vfloat nx1 = lerp(r, grad(hash(ix0, py10), fx0, fy1, fz0), grad(hash(ix0, py11), fx0, fy1, fz1));
+        vfloat n0 = lerp(t, nx0, nx1);
+
+        nx0 = lerp(r, grad(hash(ix1, py00), fx1, fy0, fz0), grad(hash(ix1, py01), fx1, fy0, fz1));
+        nx1 = lerp(r, grad(hash(ix1, py10), fx1, fy1, fz0), grad(hash(ix1, py11), fx1, fy1, fz1));
+        vfloat n1 = lerp(t, nx0, nx1);
+
+        return mul(splat(0.936f), lerp(s, n0, n1));
+    }
+
+    template <typename H, typename W> inline vfloat noise( const H& hash, vfloat x, vfloat y, vfloat z, const W& wrap ) {
+        vint ix = fast_floor(x);
+        vint iy = fast_floor(y);
+        vint iz = fast_floor(z);
+        vfloat fx0 = sub(x, to_float(ix));
+        vfloat fy0 = sub(y, to_float(iy));
+        vfloat fz0 = sub(z, to_float(iz));
+        return noise_cell(hash, ix, fx0, iy, fy0, iz, fz0, wrap);
+    }
+
+    template <typename H, typename W> 
+    inline vfloat noise_cell( const H& hash, vint ix, vfloat fx0, vint iy, vfloat fy0, vint iz, vfloat fz0, vint iw, vfloat fw0, const W& wrap ) {
+        vfloat fx1 = sub(fx0, splat(1.0f));
+        vfloat fy1 = sub(fy0, splat(1.0f));
+        vfloat fz1 = sub(fz0, splat(1.0f));
+        vfloat fw1 = sub(fw0, splat(1.0f));
+        vint ix0, ix1, iy0, iy1, iz0, iz1, iw0, iw1;
+        wrap(ix, 0, &ix0, &ix1);
+        wrap(iy, 1, &iy0, &iy1);
+        wrap(iz, 2, &iz0, &iz1);
+        wrap(iw, 3, &iw0, &iw1);
+
+        vfloat q = fade(fw0);
+        vfloat r = fade(fz0);
+        vfloat t = fade(fy0);
+        vfloat s = fade(fx0);
+
+        vint pw0 = hash(iw0);
+        vint pw1 = hash(iw1);
+        vint pz00 = hash(iz0, pw0);
+        vint pz01 = hash(iz0, pw1);
+        vint pz10 = hash(iz1, pw0);
+        vint pz11 = hash(iz1, pw1);
+        vint py[2][4] = {
+            { hash(iy0, pz00), hash(iy0, pz01), hash(iy0, pz10), hash(iy0, pz11) },
+            { hash(iy1, pz00), hash(iy1, pz01), hash(iy1, pz10), hash(iy1, pz11) }
+        };
+        vint px[2] = { ix0, ix1 };
+        vfloat fx[2] = { fx0, fx1 };
+        vfloat fy[2] = { fy0, fy1 };
+
+        vfloat n[2];
+        for (int i = 0; i < 2; ++i) {
+            vfloat nx[2];
+            for (int j = 0; j < 2; ++j) {
+                const vint *h = py[j];
+                vfloat nxy0 = lerp(q, grad(hash(px[i], h[0]), fx[i], fy[j], fz0, fw0), 
+                                      grad(hash(px[i], h[1]), fx[i], fy[j], fz0, fw1));
+                vfloat nxy1 = lerp(q, grad(hash(px[i], h[2]), fx[i], fy[j], fz1, fw0), 
+                                      grad(hash(px[i], h[3]), fx[i], fy[j], fz1, fw1));
+                nx[j] = lerp(r, nxy0, nxy1);
+            }
+            n[i] = lerp(t, nx[0], nx[1]);
+        }
+
+        return mul(splat(0.87f), lerp(s, n[0], n[1]));
+    }
+
+    template <typename H, typename W> inline vfloat noise( const H& hash, vfloat x, vfloat y, vfloat z, vfloat w, const W& wrap ) {
+        vint ix = fast_floor(x);
+        vint iy = fast_floor(y);
+        vint iz = fast_floor(z);
+        vint iw = fast_floor(w);
+        vfloat fx0 = sub(x, to_float(ix));
+        vfloat fy0 = sub(y, to_float(iy));
+        vfloat fz0 = sub(z, to_float(iz));
+        vfloat fw0 = sub(w, to_float(iw));
+        return noise_cell(hash, ix, fx0, iy, fy0, iz, fz0, iw, fw0, wrap);
+    }
+
+    // Evaluates noise() over all complete registers of n points and
+    // returns the number of points done
+    template <typename H, typename W> 
+    size_t eval( const H& hash, const W& wrap, const float *xs, float *out, size_t n ) {
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            store(out + i, noise(hash, load(xs + i), wrap));
+        }
+        return i;
+    }
+
+    template <typename H, typename W> 
+    size_t eval( const H& hash, const W& wrap, const float *xs, const float *ys, float *out, size_t n ) {
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            store(out + i, noise(hash, load(xs + i), load(ys + i), wrap));
+        }
+        return i;
+    }
+
+    template <typename H, typename W> 
+    size_t eval( const H& hash, const W& wrap, const float *xs, const float *ys, const float *zs, 
+                 float *out, size_t n ) 
+    {
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            store(out + i, noise(hash, load(xs + i), load(ys + i), load(zs + i), wrap));
+        }
+        return i;
+    }
+
+    template <typename H, typename W> 
+    size_t eval( const H& hash, const W& wrap, const float *xs, const float *ys, const float *zs, 
+                 const float *ws, float *out, size_t n ) 
+    {
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            store(out + i, noise(hash, load(xs + i), load(ys + i), load(zs + i), load(ws + i), wrap));
+        }
+        return i;
+    }
+
+    // Evaluates noise() at double precision points over all complete
+    // registers of n points and returns the number of points done. The
+    // coordinates are split into cells and offsets lane by lane, the
+    // noise itself runs in float.
+    template <typename H, typename W> 
+    size_t eval64( const H& hash, const W& wrap, int dims, const double *const *c, float *out, size_t n ) {
+        int cell[4][width];
+        float frac[4][width];
+        vint vi[4];
+        vfloat vf[4];
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            for (int d = 0; d < dims; ++d) {
+                for (int k = 0; k < width; ++k) split_cell(c[d][i + k], &cell[d][k], &frac[d][k]);
+                vi[d] = load(cell[d]);
+                vf[d] = load(frac[d]);
+            }
+            vfloat r;
+            switch (dims) {
+                case 1: r = noise_cell(hash, vi[0], vf[0], wrap); break;
+                case 2: r = noise_cell(hash, vi[0], vf[0], vi[1], vf[1], wrap); break;
+                case 3: r = noise_cell(hash, vi[0], vf[0], vi[1], vf[1], vi[2], vf[2], wrap); break;
+                default: r = noise_cell(hash, vi[0], vf[0], vi[1], vf[1], vi[2], vf[2], vi[3], vf[3], wrap); break;
+            }
+            store(out + i, r);
+        }
+        return i;
+    }
+
+    inline vint step( vmask m ) {
+        return select(m, splat(1), splat(0));
+    }
+
+    inline vfloat falloff( vfloat t, vfloat d ) {
+        t = select(cmp_lt(t, splat(0.0f)), splat(0.0f), t);
+        t = mul(t, t);
+        return mul(mul(t, t), d);
+    }
+
+    // Simplex lattice corners are hashed as they are
+    struct SimplexWrap {
+        void operator()( vint *, vint * ) const {}
+        void operator()( vint *, vint *, vint * ) const {}
+    };
+
+    // Wraps simplex lattice corners to periods, like psnoise()
+    struct PeriodicSimplexWrap {
+        explicit PeriodicSimplexWrap( const int *period ) : p(period) {}
+
+        void operator()( vint *i, vint *j ) const {
+            int a[width], b[width];
+            store(a, *i);
+            store(b, *j);
+            for (int k = 0; k < width; ++k) wrap2(&a[k], &b[k], p[0], p[1]);
+            *i = load(a);
+            *j = load(b);
+        }
+
+        void operator()( vint *i, vint *j, vint *l ) const {
+            int a[width], b[width], c[width];
+            store(a, *i);
+            store(b, *j);
+            store(c, *l);
+            for (int k = 0; k < width; ++k) wrap3(&a[k], &b[k], &c[k], p[0], p[1], p[2]);
+            *i = load(a);
+            *j = load(b);
+            *l = load(c);
+        }
+
+        const int *p;
+    };
+
+    template <typename W> 
+    inline vfloat corner( const int *perm, vint i, vint j, vfloat x, vfloat y, const W& wrap ) {
+        vfloat dx = sub(x, sub(to_float(i), mul(splat(0.5f), to_float(j))));
+        vfloat dy = sub(y, to_float(j));
+        wrap(&i, &j);
+        vint h = hash(perm, bit_and(i, splat(0xff)), hash(perm, bit_and(j, splat(0xff))));
+        vfloat t = sub(sub(splat(R2_2D), mul(dx, dx)), mul(dy, dy));
+        return falloff(t, grad(h, dx, dy));
+    }
+
+    template <typename W> 
+    inline vfloat simplex( const int *perm, vfloat x, vfloat y, const W& wrap ) {
+        vfloat u = add(x, mul(splat(0.5f), y));
+        vint i0 = floor_int(u);
+        vint j0 = floor_int(y);
+        vmask upper = cmp_lt(sub(u, to_float(i0)), sub(y, to_float(j0)));
+        vint i1 = add(i0, select(upper, splat(0), splat(1)));
+        vint j1 = add(j0, step(upper));
+        vint i2 = add(i0, splat(1));
+        vint j2 = add(j0, splat(1));
+
+        vfloat n = splat(0.0f);
+        n = add(n, corner(perm, i0, j0, x, y, wrap));
+        n = add(n, corner(perm, i1, j1, x, y, wrap));
+        n = add(n, corner(perm, i2, j2, x, y, wrap));
+        return mul(splat(SCALE_2D), n);
+    }
+
+    template <typename W> 
+    inline vfloat corner( const int *perm, vint a, vint b, vint c, vfloat x, vfloat y, vfloat z, const W& wrap ) {
+        vfloat dx = sub(x, mul(splat(0.5f), to_float(sub(add(b, c), a))));
+        vfloat dy = sub(y, mul(splat(0.5f), to_float(sub(add(a, c), b))));
+        vfloat dz = sub(z, mul(splat(0.5f), to_float(sub(add(a, b), c))));
+        wrap(&a, &b, &c);
+        vint h = hash(perm, bit_and(a, splat(0xff)), 
+                      hash(perm, bit_and(b, splat(0xff)), hash(perm, bit_and(c, splat(0xff)))));
+        vfloat t = sub(sub(sub(splat(R2_3D), mul(dx, dx)), mul(dy, dy)), mul(dz, dz));
+        return falloff(t, grad(h, dx, dy, dz));
+    }
+
+    template <typename W> 
+    inline vfloat simplex( const int *perm, vfloat x, vfloat y, vfloat z, const W& wrap ) {
+        vfloat u = add(y, z);
+        vfloat v = add(x, z);
+        vfloat w = add(x, y);
+        vint a0 = floor_int(u);
+        vint b0 = floor_int(v);
+        vint c0 = floor_int(w);
+        vfloat fu = sub(u, to_float(a0));
+        vfloat fv = sub(v, to_float(b0));
+        vfloat fw = sub(w, to_float(c0));
+
+        vint one = splat(1);
+        vint uv = step(cmp_lt(fv, fu));
+        vint vw = step(cmp_lt(fw, fv));
+        vint uw = step(cmp_lt(fw, fu));
+        vint nuv = sub(one, uv);
+        vint nvw = sub(one, vw);
+        vint nuw = sub(one, uw);
+        vint a1 = add(a0, bit_and(uv, uw));
+        vint b1 = add(b0, bit_and(nuv, vw));
+        vint c1 = add(c0, bit_and(nuw, nvw));
+        vint a2 = sub(add(a0, one), bit_and(nuv, nuw));
+        vint b2 = sub(add(b0, one), bit_and(uv, nvw));
+        vint c2 = sub(add(c0, one), bit_and(uw, vw));
+
+        vfloat n = splat(0.0f);
+        n = add(n, corner(perm, a0, b0, c0, x, y, z, wrap));
+        n = add(n, corner(perm, a1, b1, c1, x, y, z, wrap));
+        n = add(n, corner(perm, a2, b2, c2, x, y, z, wrap));
+        n = add(n, corner(perm, add(a0, one), add(b0, one), add(c0, one), x, y, z, wrap));
+        return mul(splat(SCALE_3D), n);
+    }
+
+    inline vfloat corner( const int *perm, vint i, vint j, vint k, vint l, 
+                          vfloat x, vfloat y, vfloat z, vfloat w ) 
+    {
+        vint h = hash(perm, i, hash(perm, j, hash(perm, k, hash(perm, l))));
+        vfloat t = sub(sub(sub(sub(splat(R2_4D), mul(x, x)), mul(y, y)), mul(z, z)), mul(w, w));
+        return falloff(t, grad(h, x, y, z, w));
+    }
+
+    inline vfloat simplex( const int *perm, vfloat x, vfloat y, vfloat z, vfloat w ) {
+        vfloat s = mul(add(add(add(x, y), z), w), splat(F4));
+        vint i = floor_int(add(x, s));
+        vint j = floor_int(add(y, s));
+        vint k = floor_int(add(z, s));
+        vint l = floor_int(add(w, s));
+        vfloat t = mul(to_float(add(add(add(i, j), k), l)), splat(G4));
+        vfloat x0 = sub(x, sub(to_float(i), t));
+        vfloat y0 = sub(y, sub(to_float(j), t));
+        vfloat z0 = sub(z, sub(to_float(k), t));
+        vfloat w0 = sub(w, sub(to_float(l), t));
+
+        vint one = splat(1);
+        vint xy = step(cmp_lt(y0, x0));
+        vint xz = step(cmp_lt(z0, x0));
+        vint xw = step(cmp_lt(w0, x0));
+        vint yz = step(cmp_lt(z0, y0));
+        vint yw = step(cmp_lt(w0, y0));
+        vint zw = step(cmp_lt(w0, z0));
+        vint r[4] = {
+            add(add(xy, xz), xw),
+            add(add(sub(one, xy), yz), yw),
+            add(add(sub(one, xz), sub(one, yz)), zw),
+            add(add(sub(one, xw), sub(one, yw)), sub(one, zw))
+        };
+
+        vint ii = bit_and(i, splat(0xff));
+        vint jj = bit_and(j, splat(0xff));
+        vint kk = bit_and(k, splat(0xff));
+        vint ll = bit_and(l, splat(0xff));
+        vfloat n = corner(perm, ii, jj, kk, ll, x0, y0, z0, w0);
+        for (int c = 1; c <= 3; ++c) {
+            // corner c steps along the axes of rank 4 - c and above
+            vint o = splat(3 - c);
+            vint i1 = step(cmp_lt(o, r[0]));
+            vint j1 = step(cmp_lt(o, r[1]));
+            vint k1 = step(cmp_lt(o, r[2]));
+            vint l1 = step(cmp_lt(o, r[3]));
+            vfloat cg = splat(c * G4);
+            n = add(n, corner(perm, add(ii, i1), add(jj, j1), add(kk, k1), add(ll, l1),
+                              add(sub(x0, to_float(i1)), cg), add(sub(y0, to_float(j1)), cg), 
+                              add(sub(z0, to_float(k1)), cg), add(sub(w0, to_float(l1)), cg)));
+        }
+        vfloat one_f = splat(1.0f);
+        vfloat cg = splat(4.0f * G4);
+        n = add(n, corner(perm, add(ii, one), add(jj, one), add(kk, one), add(ll, one),
+                          add(sub(x0, one_f), cg), add(sub(y0, one_f), cg), 
+                          add(sub(z0, one_f), cg), add(sub(w0, one_f), cg)));
+        return mul(splat(SCALE_4D), n);
+    }
+
+}
+}
+
+
+void cgmath::NoiseContext::noise_batch( const float *xs, float *out, size_t n ) const {
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::Wrap(-1), xs, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::Wrap(), xs, out, n);
+    for (; i < n; ++i) out[i] = noise(xs[i]);
+}
+
+
+void cgmath::NoiseContext::noise_batch( const float *xs, const float *ys, float *out, size_t n ) const {
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::Wrap(-1), xs, ys, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::Wrap(), xs, ys, out, n);
+    for (; i < n; ++i) out[i] = noise(xs[i], ys[i]);
+}
+
+
+void cgmath::NoiseContext::noise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const {
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::Wrap(-1), xs, ys, zs, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::Wrap(), xs, ys, zs, out, n);
+    for (; i < n; ++i) out[i] = noise(xs[i], ys[i], zs[i]);
+}
+
+
+void cgmath::NoiseContext::noise_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n ) const {
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::Wrap(-1), xs, ys, zs, ws, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::Wrap(), xs, ys, zs, ws, out, n);
+    for (; i < n; ++i) out[i] = noise(xs[i], ys[i], zs[i], ws[i]);
+}
+
+
+void cgmath::NoiseContext::noise64_batch( const double *xs, float *out, size_t n ) const {
+    const double *c[1] = { xs };
+    size_t i = (m_hash == INTEGER)? batch::eval64(batch::IntegerHash(m_seed), batch::Wrap(-1), 1, c, out, n)
+                                  : batch::eval64(batch::PermutationHash(m_perm), batch::Wrap(), 1, c, out, n);
+    for (; i < n; ++i) out[i] = noise64(xs[i]);
+}
+
+
+void cgmath::NoiseContext::noise64_batch( const double *xs, const double *ys, float *out, size_t n ) const {
+    const double *c[2] = { xs, ys };
+    size_t i = (m_hash == INTEGER)? batch::eval64(batch::IntegerHash(m_seed), batch::Wrap(-1), 2, c, out, n)
+                                  : batch::eval64(batch::PermutationHash(m_perm), batch::Wrap(), 2, c, out, n);
+    for (; i < n; ++i) out[i] = noise64(xs[i], ys[i]);
+}
+
+
+void cgmath::NoiseContext::noise64_batch( const double *xs, const double *ys, const double *zs, 
+                                          float *out, size_t n ) const 
+{
+    const double *c[3] = { xs, ys, zs };
+    size_t i = (m_hash == INTEGER)? batch::eval64(batch::IntegerHash(m_seed), batch::Wrap(-1), 3, c, out, n)
+                                  : batch::eval64(batch::PermutationHash(m_perm), batch::Wrap(), 3, c, out, n);
+    for (; i < n; ++i) out[i] = noise64(xs[i], ys[i], zs[i]);
+}
+
+
+void cgmath::NoiseContext::noise64_batch( const double *xs, const double *ys, const double *zs, const double *ws,
+                                          float *out, size_t n ) const 
+{
+    const double *c[4] = { xs, ys, zs, ws };
+    size_t i = (m_hash == INTEGER)? batch::eval64(batch::IntegerHash(m_seed), batch::Wrap(-1), 4, c, out, n)
+                                  : batch::eval64(batch::PermutationHash(m_perm), batch::Wrap(), 4, c, out, n);
+    for (; i < n; ++i) out[i] = noise64(xs[i], ys[i], zs[i], ws[i]);
+}
+
+
+void cgmath::NoiseContext::pnoise_batch( const float *xs, int px, float *out, size_t n ) const {
+    const int p[1] = { px };
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::PeriodicWrap(p, -1), xs, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::PeriodicWrap(p), xs, out, n);
+    for (; i < n; ++i) out[i] = pnoise(xs[i], px);
+}
+
+
+void cgmath::NoiseContext::pnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n ) const {
+    const int p[2] = { px, py };
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::PeriodicWrap(p, -1), xs, ys, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::PeriodicWrap(p), xs, ys, out, n);
+    for (; i < n; ++i) out[i] = pnoise(xs[i], ys[i], px, py);
+}
+
+
+void cgmath::NoiseContext::pnoise_batch( const float *xs, const float *ys, const float *zs, 
+                           int px, int py, int pz, float *out, size_t n ) const 
+{
+    const int p[3] = { px, py, pz };
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::PeriodicWrap(p, -1), xs, ys, zs, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::PeriodicWrap(p), xs, ys, zs, out, n);
+    for (; i < n; ++i) out[i] = pnoise(xs[i], ys[i], zs[i], px, py, pz);
+}
+
+
+void cgmath::NoiseContext::pnoise_batch( const float *xs, const float *ys, const float *zs, const float *ws,
+                           int px, int py, int pz, int pw, float *out, size_t n ) const 
+{
+    const int p[4] = { px, py, pz, pw };
+    size_t i = (m_hash == INTEGER)? batch::eval(batch::IntegerHash(m_seed), batch::PeriodicWrap(p, -1), xs, ys, zs, ws, out, n)
+                                  : batch::eval(batch::PermutationHash(m_perm), batch::PeriodicWrap(p), xs, ys, zs, ws, out, n);
+    for (; i < n; ++i) out[i] = pnoise(xs[i], ys[i], zs[i], ws[i], px, py, pz, pw);
+}
+
+
+void cgmath::NoiseContext::snoise_batch( const float *xs, const float *ys, float *out, size_t n ) const {
+    size_t i = 0;
+    for (; i + batch::width <= n; i += batch::width) {
+        batch::store(out + i, batch::simplex(m_perm, batch::load(xs + i), batch::load(ys + i), batch::SimplexWrap()));
+    }
+    for (; i < n; ++i) out[i] = snoise(xs[i], ys[i]);
+}
+
+
+void cgmath::NoiseContext::snoise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const {
+    size_t i = 0;
+    for (; i + batch::width <= n; i += batch::width) {
+        batch::store(out + i, batch::simplex(m_perm, batch::load(xs + i), batch::load(ys + i), 
+                                             batch::load(zs + i), batch::SimplexWrap()));
+    }
+    for (; i < n; ++i) out[i] = snoise(xs[i], ys[i], zs[i]);
+}
+
+
+void cgmath::NoiseContext::snoise_batch( const float *xs, const float *ys, const float *zs, const float *ws, 
+                                         float *out, size_t n ) const 
+{
+    size_t i = 0;
+    for (; i + batch::width <= n; i += batch::width) {
+        batch::store(out + i, batch::simplex(m_perm, batch::load(xs + i), batch::load(ys + i), 
+                                             batch::load(zs + i), batch::load(ws + i)));
+    }
+    for (; i < n; ++i) out[i] = snoise(xs[i], ys[i], zs[i], ws[i]);
+}
+
+
+void cgmath::NoiseContext::psnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n ) const {
+    const int p[2] = { px, py };
+    size_t i = 0;
+    for (; i + batch::width <= n; i += batch::width) {
+        batch::store(out + i, batch::simplex(m_perm, batch::load(xs + i), batch::load(ys + i), 
+                                             batch::PeriodicSimplexWrap(p)));
+    }
+    for (; i < n; ++i) out[i] = psnoise(xs[i], ys[i], px, py);
+}
+
+
+void cgmath::NoiseContext::psnoise_batch( const float *xs, const float *ys, const float *zs, 
+                                          int px, int py, int pz, float *out, size_t n ) const 
+{
+    const int p[3] = { px, py, pz };
+    size_t i = 0;
+    for (; i + batch::width <= n; i += batch::width) {
+        batch::store(out + i, batch::simplex(m_perm, batch::load(xs + i), batch::load(ys + i), 
+                                             batch::load(zs + i), batch::PeriodicSimplexWrap(p)));
+    }
+    for (; i < n; ++i) out[i] = psnoise(xs[i], ys[i], zs[i], px, py, pz);
+}
+
+
+//  PeriodicNoise runs the batch kernels with the lattice wrapped by a
+//  floor modulo, and the scalar functions above with the same wrapping.
+
+namespace {
+namespace periodic {
+
+    using namespace batch;
+
+    // Wraps a lattice coordinate to 0..p-1 with a floor modulo, then
+    // applies the mask. Power-of-two periods are a mask, the quotient of
+    // other periods comes from the float reciprocal. Its rounding error is
+    // below one for coordinates under 2^23 periods, so a single correction
+    // step makes the result exact. Periods of 0 only apply the mask.
+    struct ModuloWrap {
+        ModuloWrap( const int *period, const float *inverse, int m ) : p(period), inv(inverse), mask(m) {}
+
+        void operator()( vint i, int axis, vint *i0, vint *i1 ) const {
+            int pa = p[axis];
+            if (pa <= 0) {
+                *i1 = bit_and(add(i, splat(1)), splat(mask));
+                *i0 = bit_and(i, splat(mask));
+                return;
+            }
+            vint vp = splat(pa);
+            vint r;
+            if ((pa & (pa - 1)) == 0) {
+                r = bit_and(i, splat(pa - 1));
+            } else {
+                r = sub(i, mul(floor_int(mul(to_float(i), splat(inv[axis]))), vp));
+                r = select(cmp_lt(r, splat(0)), add(r, vp), r);
+                r = select(cmp_lt(r, vp), r, sub(r, vp));
+            }
+            vint r1 = add(r, splat(1));
+            *i1 = bit_and(select(cmp_lt(r1, vp), r1, splat(0)), splat(mask));
+            *i0 = bit_and(r, splat(mask));
+        }
+
+        const int *p;
+        const float *inv;
+        int mask;
+    };
+
+
+    template <typename H> inline vfloat noise( const H& hash, const ModuloWrap& wrap, int dims, const vfloat *v ) {
+        switch (dims) {
+            case 1: return batch::noise(hash, v[0], wrap);
+            case 2: return batch::noise(hash, v[0], v[1], wrap);
+            case 3: return batch::noise(hash, v[0], v[1], v[2], wrap);
+            default: return batch::noise(hash, v[0], v[1], v[2], v[3], wrap);
+        }
+    }
+
+
+    // Evaluates all complete registers of n points and returns the number
+    // of points done
+    template <typename H> size_t eval( const H& hash, const ModuloWrap& wrap, int dims, 
+                                       const float *const *c, float *out, size_t n ) 
+    {
+        vfloat v[4];
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            for (int d = 0; d < dims; ++d) v[d] = load(c[d] + i);
+            store(out + i, noise(hash, wrap, dims, v));
+        }
+        return i;
+    }
+
+}
+}
+
+
+cgmath::PeriodicNoise::PeriodicNoise( int px, int py, int pz, int pw, const NoiseContext *context ) 
+    : m_context(context? context : &default_noise_context())
+{
+    const int p[4] = { px, py, pz, pw };
+    for (int k = 0; k < 4; ++k) {
+        m_period[k] = (p[k] > 0)? p[k] : 0;
+        m_inverse[k] = (p[k] > 0)? 1.0f / p[k] : 0;
+    }
+}
+
+
+template <int D> float cgmath::PeriodicNoise::eval( const float *p ) const {
+    const NoiseContext& ctx = *m_context;
+    int mask = (ctx.m_hash == NoiseContext::INTEGER)? -1 : 0xff;
+    int i[D][2];
+    float f[D][2], s[D];
+
+    for (int d = 0; d < D; ++d) {
+        int i0 = FASTFLOOR( p[d] );
+        f[d][0] = p[d] - i0;
+        f[d][1] = f[d][0] - 1.0f;
+        s[d] = FADE( f[d][0] );
+
+        int pd = m_period[d];
+        if (pd > 0) {
+            // floor modulo, as in periodic::ModuloWrap
+            int r;
+            if ((pd & (pd - 1)) == 0) {
+                r = i0 & (pd - 1);
+            } else {
+                float t = i0 * m_inverse[d];
+                int q = static_cast<int>(t);
+                if (t < q) --q;
+                r = i0 - q * pd;
+                if (r < 0) r += pd; else if (r >= pd) r -= pd;
+            }
+            i[d][0] = r & mask;
+            i[d][1] = ((r + 1 < pd)? r + 1 : 0) & mask;
+        } else {
+            i[d][0] = i0 & mask;
+            i[d][1] = ( i0 + 1 ) & mask;
+        }
+    }
+
+    return ctx.cell_noise<D>(i, f, s);
+}
+
+
+template <int D> void cgmath::PeriodicNoise::eval( const float *const *c, float *out, size_t n ) const {
+    const NoiseContext& ctx = *m_context;
+    size_t i = (ctx.m_hash == NoiseContext::INTEGER)
+        ? periodic::eval(batch::IntegerHash(ctx.m_seed), periodic::ModuloWrap(m_period, m_inverse, -1), D, c, out, n)
+        : periodic::eval(batch::PermutationHash(ctx.m_perm), periodic::ModuloWrap(m_period, m_inverse, 0xff), D, c, out, n);
+    for (; i < n; ++i) {
+        float p[D];
+        for (int d = 0; d < D; ++d) p[d] = c[d][i];
+        out[i] = eval<D>(p);
+    }
+}
+
+
+float cgmath::PeriodicNoise::operator()( float x ) const {
+    return eval<1>(&x);
+}
+
+
+float cgmath::PeriodicNoise::operator()( float x, float y ) const {
+    const float p[2] = { x, y };
+    return eval<2>(p);
+}
+
+
+float cgmath::PeriodicNoise::operator()( float x, float y, float z ) const {
+    const float p[3] = { x, y, z };
+    return eval<3>(p);
+}
+
+
+float cgmath::PeriodicNoise::operator()( float x, float y, float z, float w ) const {
+    const float p[4] = { x, y, z, w };
+    return eval<4>(p);
+}
+
+
+void cgmath::PeriodicNoise::eval_batch( const float *xs, float *out, size_t n ) const {
+    const float *c[1] = { xs };
+    eval<1>(c, out, n);
+}
+
+
+void cgmath::PeriodicNoise::eval_batch( const float *xs, const float *ys, float *out, size_t n ) const {
+    const float *c[2] = { xs, ys };
+    eval<2>(c, out, n);
+}
+
+
+void cgmath::PeriodicNoise::eval_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const {
+    const float *c[3] = { xs, ys, zs };
+    eval<3>(c, out, n);
+}
+
+
+void cgmath::PeriodicNoise::eval_batch( const float *xs, const float *ys, const float *zs, const float *ws, 
+                                        float *out, size_t n ) const 
+{
+    const float *c[4] = { xs, ys, zs, ws };
+    eval<4>(c, out, n);
+}
+
+
+//  Span evaluation along rows of a regular grid. The y (and z) lattice
+//  cell, its hashes and fade weights are fixed for the whole row, and the
+//  gradients of the current x cell are kept until a sample crosses into
+//  the next cell. Runs of samples that stay inside one cell are evaluated
+//  a SIMD register at a time with the cached gradients broadcast. All
+//  arithmetic is performed in the same order as in noise() and pnoise().
+
+namespace {
+namespace span {
+
+    using namespace batch;
+
+    // Lattice of a row: hash H, gradient tables g (offset to the dimension,
+    // indexed by H::index()), periods (0 = none) and the wrap mask
+    template <typename H> struct Lattice {
+        Lattice( const H& h, const float *const *g, const int *period, int mask ) 
+            : hash(h), g(g), period(period), mask(mask) {}
+
+        int wrap( int i, int axis ) const {
+            int p = period? period[axis] : 0;
+            return (p > 0)? ( i % p ) & mask : i & mask;
+        }
+
+        H hash;
+        const float *const *g;
+        const int *period;
+        int mask;
+    };
+
+
+    // Row of 2D noise at fixed y
+    template <typename H> class Row2 {
+    public:
+        Row2( const Lattice<H>& l, float y ) : m_l(l), m_y(y) {
+            int iy0 = FASTFLOOR( y );
+            m_fy0 = y - iy0;
+            m_fy1 = m_fy0 - 1.0f;
+            m_t = FADE( m_fy0 );
+            m_py[0] = l.hash.scalar(l.wrap(iy0, 1));
+            m_py[1] = l.hash.scalar(l.wrap(iy0 + 1, 1));
+            load(0);
+        }
+
+        // Corner k = 2 * (x bit) + (y bit)
+        void load( int ix ) {
+            int ixw[2] = { m_l.wrap(ix, 0), m_l.wrap(ix + 1, 0) };
+            float fy[2] = { m_fy0, m_fy1 };
+            for (int k = 0; k < 4; ++k) {
+                int h = m_l.hash.index(static_cast<uint32_t>(ixw[k >> 1]) + m_py[k & 1]);
+                m_gx[k] = m_l.g[0][h];
+                m_cy[k] = m_l.g[1][h] * fy[k & 1];
+            }
+            m_ix = ix;
+        }
+
+        int cell() const {
+            return m_ix;
+        }
+
+        float eval( float x ) {
+            int ix = FASTFLOOR( x );
+            if (ix != m_ix) load(ix);
+            float fx0 = x - ix;
+            float fx1 = fx0 - 1.0f;
+            float s = FADE( fx0 );
+            float n0 = LERP( m_t, m_gx[0] * fx0 + m_cy[0], m_gx[1] * fx0 + m_cy[1] );
+            float n1 = LERP( m_t, m_gx[2] * fx1 + m_cy[2], m_gx[3] * fx1 + m_cy[3] );
+            return 0.507f * ( LERP( s, n0, n1 ) );
+        }
+
+        // Evaluates samples in arbitrary cells
+        vfloat eval_any( vfloat x ) const {
+            return m_l.period? noise(m_l.hash, x, splat(m_y), PeriodicWrap(m_l.period, m_l.mask)) 
+                             : noise(m_l.hash, x, splat(m_y), Wrap(m_l.mask));
+        }
+
+        // Evaluates samples that all lie in the current cell
+        vfloat eval( vfloat x ) const {
+            vfloat fx0 = sub(x, splat(static_cast<float>(m_ix)));
+            vfloat fx1 = sub(fx0, splat(1.0f));
+            vfloat s = fade(fx0);
+            vfloat t = splat(m_t);
+            vfloat n0 = lerp(t, add(mul(splat(m_gx[0]), fx0), splat(m_cy[0])), 
+                                add(mul(splat(m_gx[1]), fx0), splat(m_cy[1])));
+            vfloat n1 = lerp(t, add(mul(splat(m_gx[2]), fx1), splat(m_cy[2])), 
+                                add(mul(splat(m_gx[3]), fx1), splat(m_cy[3])));
+            return mul(splat(0.507f), lerp(s, n0, n1));
+        }
+
+    private:
+        Lattice<H> m_l;
+        float m_y;
+        uint32_t m_py[2];
+        float m_fy0, m_fy1, m_t;
+        int m_ix;
+        float m_gx[4], m_cy[4];
+    };
+
+
+    // Row of 3D noise at fixed y and z
+    template <typename H> class Row3 {
+    public:
+        Row3( const Lattice<H>& l, float y, float z ) : m_l(l), m_y(y), m_z(z) {
+            int iy0 = FASTFLOOR( y );
+            int iz0 = FASTFLOOR( z );
+            m_fy[0] = y - iy0;
+            m_fz[0] = z - iz0;
+            m_fy[1] = m_fy[0] - 1.0f;
+            m_fz[1] = m_fz[0] - 1.0f;
+            m_r = FADE( m_fz[0] );
+            m_t = FADE( m_fy[0] );
+            int iyw[2] = { l.wrap(iy0, 1), l.wrap(iy0 + 1, 1) };
+            int izw[2] = { l.wrap(iz0, 2), l.wrap(iz0 + 1, 2) };
+            for (int k = 0; k < 4; ++k) {
+                m_pyz[k] = l.hash.scalar(static_cast<uint32_t>(iyw[k >> 1]) + l.hash.scalar(izw[k & 1]));
+            }
+            load(0);
+        }
+
+        // Corner k = 4 * (x bit) + 2 * (y bit) + (z bit)
+        void load( int ix ) {
+            int ixw[2] = { m_l.wrap(ix, 0), m_l.wrap(ix + 1, 0) };
+            for (int k = 0; k < 8; ++k) {
+                int h = m_l.hash.index(static_cast<uint32_t>(ixw[k >> 2]) + m_pyz[k & 3]);
+                m_gx[k] = m_l.g[0][h];
+                m_cy[k] = m_l.g[1][h] * m_fy[(k >> 1) & 1];
+                m_cz[k] = m_l.g[2][h] * m_fz[k & 1];
+            }
+            m_ix = ix;
+        }
+
+        int cell() const {
+            return m_ix;
+        }
+
+        float eval( float x ) {
+            int ix = FASTFLOOR( x );
+            if (ix != m_ix) load(ix);
+            float fx[2];
+            fx[0] = x - ix;
+            fx[1] = fx[0] - 1.0f;
+            float s = FADE( fx[0] );
+            float n[2];
+            for (int i = 0; i < 2; ++i) {
+                const float *gx = m_gx + 4 * i, *cy = m_cy + 4 * i, *cz = m_cz + 4 * i;
+                float nx0 = LERP( m_r, gx[0] * fx[i] + cy[0] + cz[0], gx[1] * fx[i] + cy[1] + cz[1] );
+                float nx1 = LERP( m_r, gx[2] * fx[i] + cy[2] + cz[2], gx[3] * fx[i] + cy[3] + cz[3] );
+                n[i] = LERP( m_t, nx0, nx1 );
+            }
+            return 0.936f * ( LERP( s, n[0], n[1] ) );
+        }
+
+        vfloat eval_any( vfloat x ) const {
+            return m_l.period? noise(m_l.hash, x, splat(m_y), splat(m_z), PeriodicWrap(m_l.period, m_l.mask)) 
+                             : noise(m_l.hash, x, splat(m_y), splat(m_z), Wrap(m_l.mask));
+        }
+
+        vfloat eval( vfloat x ) const {
+            vfloat fx[2];
+            fx[0] = sub(x, splat(static_cast<float>(m_ix)));
+            fx[1] = sub(fx[0], splat(1.0f));
+            vfloat s = fade(fx[0]);
+            vfloat r = splat(m_r);
+            vfloat t = splat(m_t);
+            vfloat n[2];
+            for (int i = 0; i < 2; ++i) {
+                vfloat c[4];
+                for (int k = 0; k < 4; ++k) {
+                    int j = 4 * i + k;
+                    c[k] = add(add(mul(splat(m_gx[j]), fx[i]), splat(m_cy[j])), splat(m_cz[j]));
+                }
+                n[i] = lerp(t, lerp(r, c[0], c[1]), lerp(r, c[2], c[3]));
+            }
+            return mul(splat(0.936f), lerp(s, n[0], n[1]));
+        }
+
+    private:
+        Lattice<H> m_l;
+        float m_y, m_z;
+        uint32_t m_pyz[4];
+        float m_fy[2], m_fz[2], m_r, m_t;
+        int m_ix;
+        float m_gx[8], m_cy[8], m_cz[8];
+    };
+
+
+    // out[i] = row(x + i * dx). Sample positions are monotonic, so a
+    // register of samples lies in one cell iff its first and last do.
+    // Registers that straddle cells go through the batch kernels, which
+    // are faster than updating the cached cell for almost every sample.
+    template <typename R> void eval( R row, float x, float dx, float *out, size_t n ) {
+        int lane[width];
+        for (int k = 0; k < width; ++k) lane[k] = k;
+        vint lanes = load(lane);
+
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            float xa = x + i * dx;
+            float xb = x + (i + width - 1) * dx;
+            int a = FASTFLOOR( xa );
+            int b = FASTFLOOR( xb );
+            vfloat xs = add(splat(x), mul(to_float(add(lanes, splat(static_cast<int>(i)))), splat(dx)));
+            if (a == b) {
+                if (a != row.cell()) row.load(a);
+                store(out + i, row.eval(xs));
+            } else {
+                store(out + i, row.eval_any(xs));
+            }
+        }
+        for (; i < n; ++i) out[i] = row.eval(x + i * dx);
+    }
+
+    template <typename H> void eval( const Lattice<H>& l, float x, float y, float dx, float *out, size_t n ) {
+        eval(Row2<H>(l, y), x, dx, out, n);
+    }
+
+    template <typename H> void eval( const Lattice<H>& l, float x, float y, float z, float dx, float *out, size_t n ) {
+        eval(Row3<H>(l, y, z), x, dx, out, n);
+    }
+
+}
+}
+
+
+void cgmath::NoiseContext::noise_span( float x, float y, float dx, float *out, size_t n ) const {
+    if (m_hash == INTEGER) {
+        const float *g[2] = { m_hash_grad[1], m_hash_grad[2] };
+        span::Lattice<batch::IntegerHash> l(batch::IntegerHash(m_seed), g, 0, -1);
+        span::eval(l, x, y, dx, out, n);
+    } else {
+        const float *g[2] = { m_grad[1], m_grad[2] };
+        span::Lattice<batch::PermutationHash> l(batch::PermutationHash(m_perm), g, 0, 0xff);
+        span::eval(l, x, y, dx, out, n);
+    }
+}
+
+
+void cgmath::NoiseContext::noise_span( float x, float y, float z, float dx, float *out, size_t n ) const {
+    if (m_hash == INTEGER) {
+        const float *g[3] = { m_hash_grad[3], m_hash_grad[4], m_hash_grad[5] };
+        span::Lattice<batch::IntegerHash> l(batch::IntegerHash(m_seed), g, 0, -1);
+        span::eval(l, x, y, z, dx, out, n);
+    } else {
+        const float *g[3] = { m_grad[3], m_grad[4], m_grad[5] };
+        span::Lattice<batch::PermutationHash> l(batch::PermutationHash(m_perm), g, 0, 0xff);
+        span::eval(l, x, y, z, dx, out, n);
+    }
+}
+
+
+void cgmath::NoiseContext::pnoise_span( float x, float y, float dx, int px, int py, float *out, size_t n ) const {
+    const int p[2] = { px, py };
+    if (m_hash == INTEGER) {
+        const float *g[2] = { m_hash_grad[1], m_hash_grad[2] };
+        span::Lattice<batch::IntegerHash> l(batch::IntegerHash(m_seed), g, p, -1);
+        span::eval(l, x, y, dx, out, n);
+    } else {
+        const float *g[2] = { m_grad[1], m_grad[2] };
+        span::Lattice<batch::PermutationHash> l(batch::PermutationHash(m_perm), g, p, 0xff);
+        span::eval(l, x, y, dx, out, n);
+    }
+}
+
+
+void cgmath::NoiseContext::pnoise_span( float x, float y, float z, float dx, 
+                                        int px, int py, int pz, float *out, size_t n ) const 
+{
+    const int p[3] = { px, py, pz };
+    if (m_hash == INTEGER) {
+        const float *g[3] = { m_hash_grad[3], m_hash_grad[4], m_hash_grad[5] };
+        span::Lattice<batch::IntegerHash> l(batch::IntegerHash(m_seed), g, p, -1);
+        span::eval(l, x, y, z, dx, out, n);
+    } else {
+        const float *g[3] = { m_grad[3], m_grad[4], m_grad[5] };
+        span::Lattice<batch::PermutationHash> l(batch::PermutationHash(m_perm), g, p, 0xff);
+        span::eval(l, x, y, z, dx, out, n);
+    }
+}
+
+
+namespace {
+namespace unorm {
+
+    using namespace cgmath::simd;
+
+    // round(clamp((v + 1) / 2, 0, 1) * max) with the remap and the rounding
+    // offset folded into one multiply-add, (v + 1) * max / 2 + 0.5
+    template <typename T> inline vint quantize( vfloat v ) {
+        const float h = 0.5f * std::numeric_limits<T>::max();
+        vfloat t = add(mul(v, splat(h)), splat(h + 0.5f));
+        return trunc_int(min(max(t, splat(0.0f)), splat(2 * h)));
+    }
+
+
+    template <typename T> void convert( const float *src, T *dst, size_t n ) {
+        size_t i = 0;
+        for (; i + width <= n; i += width) store(dst + i, quantize<T>(load(src + i)));
+        if (i < n) {
+            // pad the tail, so that it goes through the same operations
+            float a[width];
+            T b[width];
+            for (int k = 0; k < width; ++k) a[k] = (i + k < n)? src[i + k] : 0;
+            store(b, quantize<T>(load(a)));
+            for (size_t k = 0; i + k < n; ++k) dst[i + k] = b[k];
+        }
+    }
+
+
+    // Rows of 2D noise (depth = 0) or 3D noise, p = 0 selects noise_span()
+    template <typename T> void fill( const cgmath::NoiseContext& ctx, T *dst, int width, int height, int depth,
+                                     float x0, float y0, float z0, float dx, float dy, float dz, const int *p )
+    {
+        bool planar = depth == 0;
+        if (planar) depth = 1;
+        if ((width <= 0) || (height <= 0) || (depth <= 0)) return;
+        std::vector<float> row(width);
+        for (int k = 0; k < depth; ++k) {
+            float z = z0 + k * dz;
+            for (int j = 0; j < height; ++j) {
+                float y = y0 + j * dy;
+                if (planar) {
+                    if (p) ctx.pnoise_span(x0, y, dx, p[0], p[1], &row[0], width); else ctx.noise_span(x0, y, dx, &row[0], width);
+                } else {
+                    if (p) ctx.pnoise_span(x0, y, z, dx, p[0], p[1], p[2], &row[0], width); else ctx.noise_span(x0, y, z, dx, &row[0], width);
+                }
+                convert(&row[0], dst + (static_cast<size_t>(k) * height + j) * width, width);
+            }
+        }
+    }
+
+}
+}
+
+
+void cgmath::NoiseContext::noise_fill( uint8_t *dst, int width, int height, 
+                                       float x0, float y0, float dx, float dy ) const 
+{
+    unorm::fill(*this, dst, width, height, 0, x0, y0, 0, dx, dy, 0, 0);
+}
+
+
+void cgmath::NoiseContext::noise_fill( uint16_t *dst, int width, int height, 
+                                       float x0, float y0, float dx, float dy ) const 
+{
+    unorm::fill(*this, dst, width, height, 0, x0, y0, 0, dx, dy, 0, 0);
+}
+
+
+void cgmath::NoiseContext::noise_fill( uint8_t *dst, int width, int height, int depth,
+                                       float x0, float y0, float z0, float dx, float dy, float dz ) const 
+{
+    if (depth > 0) unorm::fill(*this, dst, width, height, depth, x0, y0, z0, dx, dy, dz, 0);
+}
+
+
+void cgmath::NoiseContext::noise_fill( uint16_t *dst, int width, int height, int depth,
+                                       float x0, float y0, float z0, float dx, float dy, float dz ) const 
+{
+    if (depth > 0) unorm::fill(*this, dst, width, height, depth, x0, y0, z0, dx, dy, dz, 0);
+}
+
+
+void cgmath::NoiseContext::pnoise_fill( uint8_t *dst, int width, int height, 
+                                        float x0, float y0, float dx, float dy, int px, int py ) const 
+{
+    const int p[2] = { px, py };
+    unorm::fill(*this, dst, width, height, 0, x0, y0, 0, dx, dy, 0, p);
+}
+
+
+void cgmath::NoiseContext::pnoise_fill( uint16_t *dst, int width, int height, 
+                                        float x0, float y0, float dx, float dy, int px, int py ) const 
+{
+    const int p[2] = { px, py };
+    unorm::fill(*this, dst, width, height, 0, x0, y0, 0, dx, dy, 0, p);
+}
+
+
+void cgmath::NoiseContext::pnoise_fill( uint8_t *dst, int width, int height, int depth,
+                                        float x0, float y0, float z0, float dx, float dy, float dz, 
+                                        int px, int py, int pz ) const 
+{
+    const int p[3] = { px, py, pz };
+    if (depth > 0) unorm::fill(*this, dst, width, height, depth, x0, y0, z0, dx, dy, dz, p);
+}
+
+
+void cgmath::NoiseContext::pnoise_fill( uint16_t *dst, int width, int height, int depth,
+                                        float x0, float y0, float z0, float dx, float dy, float dz, 
+                                        int px, int py, int pz ) const 
+{
+    const int p[3] = { px, py, pz };
+    if (depth > 0) unorm::fill(*this, dst, width, height, depth, x0, y0, z0, dx, dy, dz, p);
+}
+
+
+void cgmath::noise_batch( const float *xs, float *out, size_t n ) {
+    default_noise_context().noise_batch(xs, out, n);
+}
+
+
+void cgmath::noise_batch( const float *xs, const float *ys, float *out, size_t n ) {
+    default_noise_context().noise_batch(xs, ys, out, n);
+}
+
+
+void cgmath::noise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) {
+    default_noise_context().noise_batch(xs, ys, zs, out, n);
+}
+
+
+void cgmath::noise_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n ) {
+    default_noise_context().noise_batch(xs, ys, zs, ws, out, n);
+}
+
+
+void cgmath::noise64_batch( const double *xs, float *out, size_t n ) {
+    default_noise_context().noise64_batch(xs, out, n);
+}
+
+
+void cgmath::noise64_batch( const double *xs, const double *ys, float *out, size_t n ) {
+    default_noise_context().noise64_batch(xs, ys, out, n);
+}
+
+
+void cgmath::noise64_batch( const double *xs, const double *ys, const double *zs, float *out, size_t n ) {
+    default_noise_context().noise64_batch(xs, ys, zs, out, n);
+}
+
+
+void cgmath::noise64_batch( const double *xs, const double *ys, const double *zs, const double *ws, 
+                            float *out, size_t n ) 
+{
+    default_noise_context().noise64_batch(xs, ys, zs, ws, out, n);
+}
+
+
+void cgmath::pnoise_batch( const float *xs, int px, float *out, size_t n ) {
+    default_noise_context().pnoise_batch(xs, px, out, n);
+}
+
+
+void cgmath::pnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n ) {
+    default_noise_context().pnoise_batch(xs, ys, px, py, out, n);
+}
+
+
+void cgmath::pnoise_batch( const float *xs, const float *ys, const float *zs, 
+                           int px, int py, int pz, float *out, size_t n ) 
+{
+    default_noise_context().pnoise_batch(xs, ys, zs, px, py, pz, out, n);
+}
+
+
+void cgmath::pnoise_batch( const float *xs, const float *ys, const float *zs, const float *ws,
+                           int px, int py, int pz, int pw, float *out, size_t n ) 
+{
+    default_noise_context().pnoise_batch(xs, ys, zs, ws, px, py, pz, pw, out, n);
+}
+
+
+void cgmath::snoise_batch( const float *xs, const float *ys, float *out, size_t n ) {
+    default_noise_context().snoise_batch(xs, ys, out, n);
+}
+
+
+void cgmath::snoise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) {
+    default_noise_context().snoise_batch(xs, ys, zs, out, n);
+}
+
+
+void cgmath::snoise_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n ) {
+    default_noise_context().snoise_batch(xs, ys, zs, ws, out, n);
+}
+
+
+void cgmath::psnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n ) {
+    default_noise_context().psnoise_batch(xs, ys, px, py, out, n);
+}
+
+
+void cgmath::psnoise_batch( const float *xs, const float *ys, const float *zs, 
+                            int px, int py, int pz, float *out, size_t n ) 
+{
+    default_noise_context().psnoise_batch(xs, ys, zs, px, py, pz, out, n);
+}
+
+
+void cgmath::noise_span( float x, float y, float dx, float *out, size_t n ) {
+    default_noise_context().noise_span(x, y, dx, out, n);
+}
+
+
+void cgmath::noise_span( float x, float y, float z, float dx, float *out, size_t n ) {
+    default_noise_context().noise_span(x, y, z, dx, out, n);
+}
+
+
+void cgmath::pnoise_span( float x, float y, float dx, int px, int py, float *out, size_t n ) {
+    default_noise_context().pnoise_span(x, y, dx, px, py, out, n);
+}
+
+
+void cgmath::pnoise_span( float x, float y, float z, float dx, int px, int py, int pz, float *out, size_t n ) {
+    default_noise_context().pnoise_span(x, y, z, dx, px, py, pz, out, n);
+}
+
+
+void cgmath::noise_fill( uint8_t *dst, int width, int height, float x0, float y0, float dx, float dy ) {
+    default_noise_context().noise_fill(dst, width, height, x0, y0, dx, dy);
+}
+
+
+void cgmath::noise_fill( uint16_t *dst, int width, int height, float x0, float y0, float dx, float dy ) {
+    default_noise_context().noise_fill(dst, width, height, x0, y0, dx, dy);
+}
+
+
+void cgmath::noise_fill( uint8_t *dst, int width, int height, int depth,
+                         float x0, float y0, float z0, float dx, float dy, float dz ) 
+{
+    default_noise_context().noise_fill(dst, width, height, depth, x0, y0, z0, dx, dy, dz);
+}
+
+
+void cgmath::noise_fill( uint16_t *dst, int width, int height, int depth,
+                         float x0, float y0, float z0, float dx, float dy, float dz ) 
+{
+    default_noise_context().noise_fill(dst, width, height, depth, x0, y0, z0, dx, dy, dz);
+}
+
+
+void cgmath::pnoise_fill( uint8_t *dst, int width, int height, float x0, float y0, float dx, float dy,
+                          int px, int py ) 
+{
+    default_noise_context().pnoise_fill(dst, width, height, x0, y0, dx, dy, px, py);
+}
+
+
+void cgmath::pnoise_fill( uint16_t *dst, int width, int height, float x0, float y0, float dx, float dy,
+                          int px, int py ) 
+{
+    default_noise_context().pnoise_fill(dst, width, height, x0, y0, dx, dy, px, py);
+}
+
+
+void cgmath::pnoise_fill( uint8_t *dst, int width, int height, int depth,
+                          float x0, float y0, float z0, float dx, float dy, float dz, int px, int py, int pz ) 
+{
+    default_noise_context().pnoise_fill(dst, width, height, depth, x0, y0, z0, dx, dy, dz, px, py, pz);
+}
+
+
+void cgmath::pnoise_fill( uint16_t *dst, int width, int height, int depth,
+                          float x0, float y0, float z0, float dx, float dy, float dz, int px, int py, int pz ) 
+{
+    default_noise_context().pnoise_fill(dst, width, height, depth, x0, y0, z0, dx, dy, dz, px, py, pz);
+}
+
+
+void cgmath::to_unorm( const float *src, uint8_t *dst, size_t n ) {
+    unorm::convert(src, dst, n);
+}
+
+
+void cgmath::to_unorm( const float *src, uint16_t *dst, size_t n ) {
+    unorm::convert(src, dst, n);
 }
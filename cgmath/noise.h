@@ -4,17 +4,290 @@
 */
 #pragma once
 
+#include <cgmath/types.h>
+#include <cstddef>
+
 namespace cgmath {
 
+    /// Permutation and gradient tables of one noise field. Contexts created
+    /// with different seeds give independent noise fields; the default
+    /// constructed context uses Ken Perlin's reference permutation and
+    /// reproduces the free functions below. A context is 22 KB and read-only
+    /// after construction, so it may be shared between threads.
+    ///
+    /// With INTEGER hashing, noise(), pnoise() and noise_grad() and their
+    /// batch and span versions hash the 32-bit lattice coordinates with an
+    /// integer mixing function instead of looking them up in the
+    /// permutation table. The noise field then does not repeat every 256
+    /// units, pnoise() accepts any period (0 leaves an axis unwrapped) and
+    /// the SIMD kernels need no gathers. Simplex noise always uses the
+    /// permutation.
+    class NoiseContext {
+    public:
+        enum Hash {
+            PERMUTATION,    ///< Perlin's permutation table, repeats every 256 units
+            INTEGER         ///< integer mixing function of the lattice coordinates
+        };
+
+        NoiseContext();
+        explicit NoiseContext( uint32_t seed, Hash hash = PERMUTATION );
+
+        Hash hash() const {
+            return m_hash;
+        }
+
+        float noise( float x ) const;
+        float noise( float x, float y ) const;
+        float noise( float x, float y, float z ) const;
+        float noise( float x, float y, float z, float w ) const;
+
+        float pnoise( float x, int px ) const;
+        float pnoise( float x, float y, int px, int py ) const;
+        float pnoise( float x, float y, float z, int px, int py, int pz ) const;
+        float pnoise( float x, float y, float z, float w, int px, int py, int pz, int pw ) const;
+
+        float noise64( double x ) const;
+        float noise64( double x, double y ) const;
+        float noise64( double x, double y, double z ) const;
+        float noise64( double x, double y, double z, double w ) const;
+
+        float noise_grad( float x, float y, float *grad ) const;
+        float noise_grad( float x, float y, float z, float *grad ) const;
+        float noise_grad( float x, float y, float z, float w, float *grad ) const;
+
+        float snoise( float x, float y ) const;
+        float snoise( float x, float y, float z ) const;
+        float snoise( float x, float y, float z, float w ) const;
+
+        float psnoise( float x, float y, int px, int py ) const;
+        float psnoise( float x, float y, float z, int px, int py, int pz ) const;
+
+        void noise_batch( const float *xs, float *out, size_t n ) const;
+        void noise_batch( const float *xs, const float *ys, float *out, size_t n ) const;
+        void noise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const;
+        void noise_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n ) const;
+
+        void noise64_batch( const double *xs, float *out, size_t n ) const;
+        void noise64_batch( const double *xs, const double *ys, float *out, size_t n ) const;
+        void noise64_batch( const double *xs, const double *ys, const double *zs, float *out, size_t n ) const;
+        void noise64_batch( const double *xs, const double *ys, const double *zs, const double *ws, 
+                            float *out, size_t n ) const;
+
+        void pnoise_batch( const float *xs, int px, float *out, size_t n ) const;
+        void pnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n ) const;
+        void pnoise_batch( const float *xs, const float *ys, const float *zs,
+                           int px, int py, int pz, float *out, size_t n ) const;
+        void pnoise_batch( const float *xs, const float *ys, const float *zs, const float *ws,
+                           int px, int py, int pz, int pw, float *out, size_t n ) const;
+
+        void snoise_batch( const float *xs, const float *ys, float *out, size_t n ) const;
+        void snoise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const;
+        void snoise_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n ) const;
+
+        void psnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n ) const;
+        void psnoise_batch( const float *xs, const float *ys, const float *zs,
+                            int px, int py, int pz, float *out, size_t n ) const;
+
+        void noise_span( float x, float y, float dx, float *out, size_t n ) const;
+        void noise_span( float x, float y, float z, float dx, float *out, size_t n ) const;
+
+        void pnoise_span( float x, float y, float dx, int px, int py, float *out, size_t n ) const;
+        void pnoise_span( float x, float y, float z, float dx, int px, int py, int pz, float *out, size_t n ) const;
+
+        void noise_fill( uint8_t *dst, int width, int height, float x0, float y0, float dx, float dy ) const;
+        void noise_fill( uint16_t *dst, int width, int height, float x0, float y0, float dx, float dy ) const;
+        void noise_fill( uint8_t *dst, int width, int height, int depth,
+                         float x0, float y0, float z0, float dx, float dy, float dz ) const;
+        void noise_fill( uint16_t *dst, int width, int height, int depth,
+                         float x0, float y0, float z0, float dx, float dy, float dz ) const;
+
+        void pnoise_fill( uint8_t *dst, int width, int height, float x0, float y0, float dx, float dy,
+                          int px, int py ) const;
+        void pnoise_fill( uint16_t *dst, int width, int height, float x0, float y0, float dx, float dy,
+                          int px, int py ) const;
+        void pnoise_fill( uint8_t *dst, int width, int height, int depth,
+                          float x0, float y0, float z0, float dx, float dy, float dz, int px, int py, int pz ) const;
+        void pnoise_fill( uint16_t *dst, int width, int height, int depth,
+                          float x0, float y0, float z0, float dx, float dy, float dz, int px, int py, int pz ) const;
+
+        /// Permutation table: two copies of a permutation of 0..255
+        const int* perm() const {
+            return m_perm;
+        }
+
+        /// Component axis of the gradient vectors of dim-dimensional noise,
+        /// indexed like perm(): the gradient at hash index i is the
+        /// gradient of hash value perm()[i].
+        const float* gradient( int dim, int axis ) const {
+            return m_grad[dim * (dim - 1) / 2 + axis];
+        }
+
+    private:
+        friend class PeriodicNoise;
+
+        void init( const unsigned char *p );
+
+        template <int D> float cell_noise( const int i[][2], const float f[][2], const float *s ) const;
+        template <int D> float noise64( const double *p ) const;
+
+        Hash m_hash;
+        uint32_t m_seed;
+        int m_perm[512];
+        float m_grad[10][512];
+        float m_hash_grad[10][32];
+    };
+
+    /// Context used by the free noise functions
+    const NoiseContext& default_noise_context();
+
+    /// Periodic noise for a fixed set of periods, for repeated evaluation
+    /// like baking tileable textures. The wrapping is prepared once: lattice
+    /// coordinates of power-of-two periods are masked and other periods are
+    /// divided through a float reciprocal, in SIMD registers for batches, so
+    /// no sample pays for an integer division. A period of 0 leaves an axis
+    /// unwrapped. Scalar and batch results are identical.
+    ///
+    /// pnoise() wraps with the remainder of an integer division and so
+    /// does not tile across negative coordinates. PeriodicNoise wraps with a
+    /// floor modulo instead, which tiles everywhere and is equal to pnoise()
+    /// wherever the lattice coordinates are non-negative.
+    class PeriodicNoise {
+    public:
+        explicit PeriodicNoise( int px, int py = 0, int pz = 0, int pw = 0, const NoiseContext *context = 0 );
+
+        float operator()( float x ) const;
+        float operator()( float x, float y ) const;
+        float operator()( float x, float y, float z ) const;
+        float operator()( float x, float y, float z, float w ) const;
+
+        void eval_batch( const float *xs, float *out, size_t n ) const;
+        void eval_batch( const float *xs, const float *ys, float *out, size_t n ) const;
+        void eval_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const;
+        void eval_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n ) const;
+
+        int period( int axis ) const {
+            return m_period[axis];
+        }
+
+    private:
+        template <int D> float eval( const float *p ) const;
+        template <int D> void eval( const float *const *c, float *out, size_t n ) const;
+
+        int m_period[4];
+        float m_inverse[4];
+        const NoiseContext *m_context;
+    };
+
     float noise( float x );
     float noise( float x, float y );
     float noise( float x, float y, float z );
     float noise( float x, float y, float z, float w );
-    
+
     float pnoise( float x, int px );
     float pnoise( float x, float y, int px, int py );
     float pnoise( float x, float y, float z, int px, int py, int pz);
     float pnoise( float x, float y, float z, float w, int px, int py, int pz, int pw );
 
-}
+    // Noise at double precision coordinates, for points far from the origin
+    // where float coordinates have few or no fractional bits left. Each
+    // coordinate is split exactly into a 64-bit lattice cell and the float
+    // offset in it, and the noise is then evaluated in float like noise(),
+    // which it equals at coordinates that are exact floats. Only the low 32
+    // bits of a cell are hashed, so INTEGER noise repeats every 2^32 units.
+    float noise64( double x );
+    float noise64( double x, double y );
+    float noise64( double x, double y, double z );
+    float noise64( double x, double y, double z, double w );
+
+    void noise64_batch( const double *xs, float *out, size_t n );
+    void noise64_batch( const double *xs, const double *ys, float *out, size_t n );
+    void noise64_batch( const double *xs, const double *ys, const double *zs, float *out, size_t n );
+    void noise64_batch( const double *xs, const double *ys, const double *zs, const double *ws, float *out, size_t n );
+
+    // Return the same value as noise() and store its exact partial
+    // derivatives in grad[0], grad[1], ... (one per dimension). They are
+    // computed from the same lattice corners in a single pass, which costs
+    // between two and three noise() calls instead of the D+1 or 2D+1 calls
+    // of finite differences.
+    float noise_grad( float x, float y, float *grad );
+    float noise_grad( float x, float y, float z, float *grad );
+    float noise_grad( float x, float y, float z, float w, float *grad );
 
+    // Batch versions of the above, evaluating out[i] = noise(xs[i], ...) for
+    // n points given as separate coordinate arrays. Results are identical to
+    // the single point functions.
+    void noise_batch( const float *xs, float *out, size_t n );
+    void noise_batch( const float *xs, const float *ys, float *out, size_t n );
+    void noise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n );
+    void noise_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n );
+
+    void pnoise_batch( const float *xs, int px, float *out, size_t n );
+    void pnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n );
+    void pnoise_batch( const float *xs, const float *ys, const float *zs,
+                       int px, int py, int pz, float *out, size_t n );
+    void pnoise_batch( const float *xs, const float *ys, const float *zs, const float *ws,
+                       int px, int py, int pz, int pw, float *out, size_t n );
+
+    // Simplex noise in the range [-1,1]. Only D+1 lattice corners are
+    // visited per sample instead of the 2^D of noise(), 5 instead of 16 in
+    // 4D. The lattices of the 2D and 3D versions can be wrapped: psnoise()
+    // tiles with integer periods like pnoise(), except that in 2D py has to
+    // be even and odd py are rounded up to the next even period. A period
+    // of 0 disables wrapping along that axis. There is no
+    // periodic 4D version, since the 4D simplex lattice cannot be wrapped
+    // to axis aligned periods.
+    float snoise( float x, float y );
+    float snoise( float x, float y, float z );
+    float snoise( float x, float y, float z, float w );
+
+    float psnoise( float x, float y, int px, int py );
+    float psnoise( float x, float y, float z, int px, int py, int pz );
+
+    void snoise_batch( const float *xs, const float *ys, float *out, size_t n );
+    void snoise_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n );
+    void snoise_batch( const float *xs, const float *ys, const float *zs, const float *ws, float *out, size_t n );
+
+    void psnoise_batch( const float *xs, const float *ys, int px, int py, float *out, size_t n );
+    void psnoise_batch( const float *xs, const float *ys, const float *zs,
+                        int px, int py, int pz, float *out, size_t n );
+
+    // Evaluate a row of a regular grid, out[i] = noise(x + i * dx, y, ...)
+    // for i = 0..n-1, with results identical to the single point functions.
+    // The hashes and fade weights of the fixed axes are computed once per
+    // row and the lattice is only re-hashed when a sample enters a new
+    // cell, which makes spans much cheaper than noise_batch() whenever
+    // several samples fall into each cell.
+    void noise_span( float x, float y, float dx, float *out, size_t n );
+    void noise_span( float x, float y, float z, float dx, float *out, size_t n );
+
+    void pnoise_span( float x, float y, float dx, int px, int py, float *out, size_t n );
+    void pnoise_span( float x, float y, float z, float dx, int px, int py, int pz, float *out, size_t n );
+
+    // Fill a width x height image with pixel (i,j) = noise(x0 + i * dx,
+    // y0 + j * dy), or a width x height x depth volume (x fastest), as 8 or
+    // 16 bit unsigned normalized texels. Each row is evaluated with the span
+    // functions into a row buffer and converted by to_unorm() right away,
+    // so no float copy of the image is ever made.
+    void noise_fill( uint8_t *dst, int width, int height, float x0, float y0, float dx, float dy );
+    void noise_fill( uint16_t *dst, int width, int height, float x0, float y0, float dx, float dy );
+    void noise_fill( uint8_t *dst, int width, int height, int depth,
+                     float x0, float y0, float z0, float dx, float dy, float dz );
+    void noise_fill( uint16_t *dst, int width, int height, int depth,
+                     float x0, float y0, float z0, float dx, float dy, float dz );
+
+    void pnoise_fill( uint8_t *dst, int width, int height, float x0, float y0, float dx, float dy,
+                      int px, int py );
+    void pnoise_fill( uint16_t *dst, int width, int height, float x0, float y0, float dx, float dy,
+                      int px, int py );
+    void pnoise_fill( uint8_t *dst, int width, int height, int depth,
+                      float x0, float y0, float z0, float dx, float dy, float dz, int px, int py, int pz );
+    void pnoise_fill( uint16_t *dst, int width, int height, int depth,
+                      float x0, float y0, float z0, float dx, float dy, float dz, int px, int py, int pz );
+
+    // Map noise values from [-1,1] to [0,1], clamp and round to the nearest
+    // unsigned normalized integer: dst[i] = round(clamp((src[i] + 1) / 2, 0, 1) * 255)
+    // and * 65535 respectively. Values outside [-1,1] saturate.
+    void to_unorm( const float *src, uint8_t *dst, size_t n );
+    void to_unorm( const float *src, uint16_t *dst, size_t n );
+
+}
@@ -0,0 +1,450 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/noise_graph.h>
+#include <cgmath/parallel.h>
+#include <cgmath/simd.h>
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+
+namespace {
+
+    using cgmath::NoiseGraph;
+    using namespace cgmath::simd;
+
+    // Operations of compiled programs. Operands are registers, or inputs
+    // if negative (-1 - axis).
+    enum Code {
+        C_CONST,    // dst = k0
+        C_ADD,      // dst = a + b
+        C_MUL,      // dst = a * b
+        C_REMAP,    // dst = a * k0 + k1
+        C_MADD,     // dst = a * k0 + b
+        C_NOISE2,   // dst = noise(a, b)
+        C_NOISE3,   // dst = noise(a, b, c)
+        C_INPUT     // no code, value of input axis k0
+    };
+
+
+    // Value of the program in SSA form, args refer to earlier values
+    struct Value {
+        Code code;
+        int a, b, c;
+        float k0, k1;
+    };
+
+
+    // Expands a graph into values. Each value is numbered by its operation
+    // and arguments, so that identical subexpressions, like a node that is
+    // reached through several warps with the same coordinates, are
+    // computed only once. Values with constant arguments are folded.
+    class Compiler {
+    public:
+        Compiler( const NoiseGraph& g, const cgmath::NoiseContext& ctx ) : m_graph(g), m_ctx(ctx) {
+            for (int k = 0; k < 3; ++k) {
+                Value v = { C_INPUT, -1, -1, -1, static_cast<float>(k), 0 };
+                m_input[k] = emit(v);
+            }
+        }
+
+        int compile( NoiseGraph::Node n ) {
+            return compile(n, m_input);
+        }
+
+        std::vector<Value> values;
+
+    private:
+        int compile( NoiseGraph::Node n, const int *in ) {
+            std::tuple<int, int, int, int> key(n, in[0], in[1], in[2]);
+            std::map< std::tuple<int, int, int, int>, int >::const_iterator it = m_compiled.find(key);
+            if (it != m_compiled.end()) return it->second;
+
+            const NoiseGraph::NodeData& d = m_graph.node(n);
+            int r = -1;
+            switch (d.op) {
+                case NoiseGraph::INPUT:
+                    r = in[d.arg[0]];
+                    break;
+
+                case NoiseGraph::CONSTANT:
+                    r = constant(d.k[0]);
+                    break;
+
+                case NoiseGraph::ADD:
+                case NoiseGraph::MUL: {
+                    int a = compile(d.arg[0], in);
+                    int b = compile(d.arg[1], in);
+                    r = (d.op == NoiseGraph::ADD)? add(a, b) : mul(a, b);
+                    break;
+                }
+
+                case NoiseGraph::REMAP:
+                    r = remap(compile(d.arg[0], in), d.k[0], d.k[1]);
+                    break;
+
+                case NoiseGraph::NOISE2:
+                    r = op(C_NOISE2, compile(d.arg[0], in), compile(d.arg[1], in));
+                    break;
+
+                case NoiseGraph::NOISE3:
+                    r = op(C_NOISE3, compile(d.arg[0], in), compile(d.arg[1], in), compile(d.arg[2], in));
+                    break;
+
+                case NoiseGraph::FBM2:
+                case NoiseGraph::FBM3: {
+                    bool three = d.op == NoiseGraph::FBM3;
+                    int x = compile(d.arg[0], in);
+                    int y = compile(d.arg[1], in);
+                    int z = three? compile(d.arg[2], in) : -1;
+                    float freq = 1;
+                    float amp = 1;
+                    for (int k = 0; k < d.octaves; ++k) {
+                        int sx = (k == 0)? x : remap(x, freq, 0);
+                        int sy = (k == 0)? y : remap(y, freq, 0);
+                        int v = three? op(C_NOISE3, sx, sy, (k == 0)? z : remap(z, freq, 0)) : op(C_NOISE2, sx, sy);
+                        r = (k == 0)? v : madd(v, amp, r);
+                        freq *= d.k[0];
+                        amp *= d.k[1];
+                    }
+                    if (r < 0) r = constant(0);
+                    break;
+                }
+
+                case NoiseGraph::WARP: {
+                    int w[3] = { compile(d.arg[1], in), compile(d.arg[2], in),
+                                 (d.arg[3] >= 0)? compile(d.arg[3], in) : in[2] };
+                    r = compile(d.arg[0], w);
+                    break;
+                }
+            }
+            m_compiled[key] = r;
+            return r;
+        }
+
+        bool is_constant( int v ) const {
+            return values[v].code == C_CONST;
+        }
+
+        float k( int v ) const {
+            return values[v].k0;
+        }
+
+        int constant( float c ) {
+            Value v = { C_CONST, -1, -1, -1, c, 0 };
+            return emit(v);
+        }
+
+        int add( int a, int b ) {
+            if (is_constant(a) && is_constant(b)) return constant(k(a) + k(b));
+            if (is_constant(a)) std::swap(a, b);
+            if (is_constant(b)) return remap(a, 1, k(b));
+            return op(C_ADD, std::min(a, b), std::max(a, b));
+        }
+
+        int mul( int a, int b ) {
+            if (is_constant(a) && is_constant(b)) return constant(k(a) * k(b));
+            if (is_constant(a)) std::swap(a, b);
+            if (is_constant(b)) return remap(a, k(b), 0);
+            return op(C_MUL, std::min(a, b), std::max(a, b));
+        }
+
+        int remap( int a, float s, float o ) {
+            if (is_constant(a)) return constant(k(a) * s + o);
+            Value v = { C_REMAP, a, -1, -1, s, o };
+            return emit(v);
+        }
+
+        int madd( int a, float s, int b ) {
+            if (is_constant(b)) return remap(a, s, k(b));
+            if (is_constant(a)) return add(constant(k(a) * s), b);
+            Value v = { C_MADD, a, b, -1, s, 0 };
+            return emit(v);
+        }
+
+        int op( Code code, int a, int b, int c = -1 ) {
+            if (is_constant(a) && is_constant(b) && ((c < 0) || is_constant(c))) {
+                return constant((c < 0)? m_ctx.noise(k(a), k(b)) : m_ctx.noise(k(a), k(b), k(c)));
+            }
+            Value v = { code, a, b, c, 0, 0 };
+            return emit(v);
+        }
+
+        int emit( const Value& v ) {
+            std::tuple<int, int, int, int, float, float> key(v.code, v.a, v.b, v.c, v.k0, v.k1);
+            std::map< std::tuple<int, int, int, int, float, float>, int >::const_iterator it = m_numbers.find(key);
+            if (it != m_numbers.end()) return it->second;
+            values.push_back(v);
+            int n = static_cast<int>(values.size()) - 1;
+            m_numbers[key] = n;
+            return n;
+        }
+
+        const NoiseGraph& m_graph;
+        const cgmath::NoiseContext& m_ctx;
+        int m_input[3];
+        std::map< std::tuple<int, int, int, int>, int > m_compiled;
+        std::map< std::tuple<int, int, int, int, float, float>, int > m_numbers;
+    };
+
+
+    // d[i] = f(a[i], b[i]) in lanes, with the tail padded to a register
+    template <typename F> void apply( float *d, const float *a, const float *b, int m, F f ) {
+        int i = 0;
+        for (; i + width <= m; i += width) store(d + i, f(load(a + i), load(b + i)));
+        if (i < m) {
+            float p[width], q[width], r[width];
+            for (int k = 0; k < width; ++k) {
+                p[k] = (i + k < m)? a[i + k] : 0;
+                q[k] = (i + k < m)? b[i + k] : 0;
+            }
+            store(r, f(load(p), load(q)));
+            std::copy(r, r + (m - i), d + i);
+        }
+    }
+
+}
+
+
+cgmath::NoiseGraph::NoiseGraph() {
+    for (int k = 0; k < 3; ++k) {
+        Node n = push(INPUT);
+        m_nodes[n].arg[0] = k;
+    }
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::push( Op op, Node a, Node b, Node c, Node d ) {
+    NodeData n;
+    n.op = op;
+    n.arg[0] = a;
+    n.arg[1] = b;
+    n.arg[2] = c;
+    n.arg[3] = d;
+    n.k[0] = n.k[1] = n.k[2] = 0;
+    n.octaves = 0;
+    m_nodes.push_back(n);
+    return static_cast<Node>(m_nodes.size()) - 1;
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::constant( float c ) {
+    Node n = push(CONSTANT);
+    m_nodes[n].k[0] = c;
+    return n;
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::add( Node a, Node b ) {
+    return push(ADD, a, b);
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::mul( Node a, Node b ) {
+    return push(MUL, a, b);
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::remap( Node a, float scale, float offset ) {
+    Node n = push(REMAP, a);
+    m_nodes[n].k[0] = scale;
+    m_nodes[n].k[1] = offset;
+    return n;
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::noise( Node x, Node y ) {
+    return push(NOISE2, x, y);
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::noise( Node x, Node y, Node z ) {
+    return push(NOISE3, x, y, z);
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::fbm( Node x, Node y, int octaves, float lacunarity, float gain ) {
+    Node n = push(FBM2, x, y);
+    m_nodes[n].k[0] = lacunarity;
+    m_nodes[n].k[1] = gain;
+    m_nodes[n].octaves = octaves;
+    return n;
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::fbm( Node x, Node y, Node z, int octaves, float lacunarity, float gain ) {
+    Node n = push(FBM3, x, y, z);
+    m_nodes[n].k[0] = lacunarity;
+    m_nodes[n].k[1] = gain;
+    m_nodes[n].octaves = octaves;
+    return n;
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::warp( Node a, Node wx, Node wy ) {
+    return push(WARP, a, wx, wy);
+}
+
+
+cgmath::NoiseGraph::Node cgmath::NoiseGraph::warp( Node a, Node wx, Node wy, Node wz ) {
+    return push(WARP, a, wx, wy, wz);
+}
+
+
+cgmath::NoiseProgram::NoiseProgram( const NoiseGraph& g, NoiseGraph::Node out, const NoiseContext *context )
+    : m_registers(0), m_out(-1), m_context(context? context : &default_noise_context())
+{
+    Compiler c(g, *m_context);
+    int result = c.compile(out);
+    const std::vector<Value>& v = c.values;
+    int n = static_cast<int>(v.size());
+
+    // Values the result depends on, and the last value using each
+    std::vector<bool> live(n, false);
+    std::vector<int> last(n, -1);
+    live[result] = true;
+    last[result] = n;
+    for (int i = n - 1; i >= 0; --i) {
+        if (!live[i]) continue;
+        const int args[3] = { v[i].a, v[i].b, v[i].c };
+        for (int k = 0; k < 3; ++k) {
+            if (args[k] < 0) continue;
+            live[args[k]] = true;
+            last[args[k]] = std::max(last[args[k]], i);
+        }
+    }
+
+    // Linear scan register allocation. The destination is allocated before
+    // the arguments are released, so that no instruction writes a register
+    // it reads.
+    std::vector<int> reg(n, -1);
+    std::vector<int> free;
+    for (int i = 0; i < n; ++i) {
+        if (!live[i]) continue;
+        if (v[i].code == C_INPUT) {
+            reg[i] = -1 - static_cast<int>(v[i].k0);
+            continue;
+        }
+        if (free.empty()) {
+            reg[i] = m_registers++;
+        } else {
+            reg[i] = free.back();
+            free.pop_back();
+        }
+
+        Instr in = { v[i].code, reg[i], -1, -1, -1, v[i].k0, v[i].k1 };
+        const int args[3] = { v[i].a, v[i].b, v[i].c };
+        int *ops[3] = { &in.a, &in.b, &in.c };
+        for (int k = 0; k < 3; ++k) {
+            if (args[k] < 0) continue;
+            *ops[k] = reg[args[k]];
+            if ((last[args[k]] == i) && (reg[args[k]] >= 0) &&
+                (std::find(free.begin(), free.end(), reg[args[k]]) == free.end()))
+            {
+                free.push_back(reg[args[k]]);
+            }
+        }
+        m_code.push_back(in);
+    }
+    m_out = reg[result];
+}
+
+
+void cgmath::NoiseProgram::run( const float *xs, const float *ys, const float *zs, float *out,
+                                int m, float *regs ) const
+{
+    const float *in[3] = { xs, ys, zs };
+    for (size_t i = 0; i < m_code.size(); ++i) {
+        const Instr& c = m_code[i];
+        float *d = regs + c.dst * TILE;
+        const float *a = (c.a < 0)? in[-1 - c.a] : regs + c.a * TILE;
+        const float *b = (c.b < 0)? in[-1 - c.b] : regs + c.b * TILE;
+        const float *z = (c.c < 0)? in[-1 - c.c] : regs + c.c * TILE;
+        vfloat k0 = splat(c.k0);
+        vfloat k1 = splat(c.k1);
+
+        switch (c.op) {
+            case C_CONST:
+                std::fill(d, d + m, c.k0);
+                break;
+            case C_ADD:
+                apply(d, a, b, m, []( vfloat p, vfloat q ) { return add(p, q); });
+                break;
+            case C_MUL:
+                apply(d, a, b, m, []( vfloat p, vfloat q ) { return mul(p, q); });
+                break;
+            case C_REMAP:
+                apply(d, a, a, m, [&]( vfloat p, vfloat ) { return add(mul(p, k0), k1); });
+                break;
+            case C_MADD:
+                apply(d, a, b, m, [&]( vfloat p, vfloat q ) { return add(mul(p, k0), q); });
+                break;
+            case C_NOISE2:
+                m_context->noise_batch(a, b, d, m);
+                break;
+            case C_NOISE3:
+                m_context->noise_batch(a, b, z, d, m);
+                break;
+        }
+    }
+
+    const float *r = (m_out < 0)? in[-1 - m_out] : regs + m_out * TILE;
+    std::copy(r, r + m, out);
+}
+
+
+float cgmath::NoiseProgram::operator()( float x, float y, float z ) const {
+    float r;
+    eval_batch(&x, &y, &z, &r, 1);
+    return r;
+}
+
+
+void cgmath::NoiseProgram::eval_batch( const float *xs, const float *ys, const float *zs,
+                                       float *out, size_t n ) const
+{
+    // small programs keep their registers on the stack
+    const int STACK = 16;
+    float stack[STACK * TILE];
+    std::vector<float> heap;
+    float *regs = stack;
+    if (m_registers > STACK) {
+        heap.resize(static_cast<size_t>(m_registers) * TILE);
+        regs = &heap[0];
+    }
+
+    float zero[TILE];
+    if (!zs) std::fill(zero, zero + TILE, 0.0f);
+
+    for (size_t i = 0; i < n; i += TILE) {
+        int m = static_cast<int>(std::min<size_t>(TILE, n - i));
+        run(xs + i, ys + i, zs? zs + i : zero, out + i, m, regs);
+    }
+}
+
+
+void cgmath::NoiseProgram::fill( float *dst, int width, int height,
+                                 float x0, float y0, float dx, float dy, float z ) const
+{
+    if (width <= 0) return;
+    parallel_for(height, [&]( int j ) {
+        std::vector<float> xs(width), ys(width, y0 + j * dy), zs(width, z);
+        for (int i = 0; i < width; ++i) xs[i] = x0 + i * dx;
+        eval_batch(&xs[0], &ys[0], &zs[0], dst + static_cast<size_t>(j) * width, width);
+    });
+}
@@ -0,0 +1,139 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/noise.h>
+#include <cstddef>
+#include <vector>
+
+namespace cgmath {
+
+    /// Expression graph of noise functions and arithmetic, built node by
+    /// node and compiled into a NoiseProgram. Nodes are handles into the
+    /// graph; x(), y() and z() are the sample coordinates. A domain warp
+    /// like noise(x + 4 * noise(x, y), y) is written as
+    ///
+    ///     NoiseGraph g;
+    ///     NoiseGraph::Node n = g.noise(g.x(), g.y());
+    ///     NoiseGraph::Node w = g.warp(n, g.add(g.x(), g.remap(n, 4)), g.y());
+    ///
+    /// where warp() evaluates its first argument at displaced coordinates.
+    class NoiseGraph {
+    public:
+        typedef int Node;
+
+        enum Op { INPUT, CONSTANT, ADD, MUL, REMAP, NOISE2, NOISE3, FBM2, FBM3, WARP };
+
+        struct NodeData {
+            Op op;
+            Node arg[4];
+            float k[3];     ///< constant, remap scale and offset, fbm lacunarity and gain
+            int octaves;
+        };
+
+        NoiseGraph();
+
+        Node x() const { return 0; }
+        Node y() const { return 1; }
+        Node z() const { return 2; }
+
+        Node constant( float c );
+        Node add( Node a, Node b );
+        Node mul( Node a, Node b );
+
+        /// a * scale + offset, e.g. remap(n, 0.5f, 0.5f) maps [-1,1] to [0,1]
+        Node remap( Node a, float scale, float offset = 0 );
+
+        Node noise( Node x, Node y );
+        Node noise( Node x, Node y, Node z );
+
+        /// Sum of noise(x * l^i, y * l^i) * g^i for i = 0..octaves-1
+        Node fbm( Node x, Node y, int octaves, float lacunarity = 2, float gain = 0.5f );
+        Node fbm( Node x, Node y, Node z, int octaves, float lacunarity = 2, float gain = 0.5f );
+
+        /// a evaluated at (wx, wy, z) or (wx, wy, wz) instead of (x, y, z)
+        Node warp( Node a, Node wx, Node wy );
+        Node warp( Node a, Node wx, Node wy, Node wz );
+
+        const NodeData& node( Node n ) const {
+            return m_nodes[n];
+        }
+
+        size_t size() const {
+            return m_nodes.size();
+        }
+
+    private:
+        Node push( Op op, Node a = -1, Node b = -1, Node c = -1, Node d = -1 );
+
+        std::vector<NodeData> m_nodes;
+    };
+
+
+    /// Compiled form of a node of a NoiseGraph.
+    ///
+    /// Compilation expands fbm and warp nodes, merges identical
+    /// subexpressions (also across warps), folds constants and assigns the
+    /// remaining values to a small set of registers of TILE samples each.
+    /// Evaluation then runs the whole program tile by tile with the batch
+    /// noise kernels, so the intermediate values of a graph stay in the
+    /// cache and memory is only touched to read the coordinates and write
+    /// the result. Results are identical to evaluating the graph node by
+    /// node with the single point functions. A program is read-only and
+    /// may be shared between threads.
+    class NoiseProgram {
+    public:
+        enum { TILE = 64 };
+
+        NoiseProgram( const NoiseGraph& g, NoiseGraph::Node out, const NoiseContext *context = 0 );
+
+        float operator()( float x, float y, float z = 0 ) const;
+
+        /// out[i] = (*this)(xs[i], ys[i], zs[i]), with z = 0 if zs is 0
+        void eval_batch( const float *xs, const float *ys, const float *zs, float *out, size_t n ) const;
+
+        /// Fills a width x height row-major image, sampling pixel (i,j) at
+        /// (x0 + i * dx, y0 + j * dy, z). Rows are computed in parallel.
+        void fill( float *dst, int width, int height,
+                   float x0, float y0, float dx, float dy, float z = 0 ) const;
+
+        size_t instructions() const {
+            return m_code.size();
+        }
+
+        int registers() const {
+            return m_registers;
+        }
+
+    private:
+        struct Instr {
+            int op;
+            int dst;
+            int a, b, c;
+            float k0, k1;
+        };
+
+        void run( const float *xs, const float *ys, const float *zs, float *out, int m, float *regs ) const;
+
+        std::vector<Instr> m_code;
+        int m_registers;
+        int m_out;
+        const NoiseContext *m_context;
+    };
+
+}
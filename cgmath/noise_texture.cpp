@@ -0,0 +1,349 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/noise_texture.h>
+#include <cgmath/fractal.h>
+#include <cgmath/noise.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+    // Cache file layout: a 64 byte header followed by the texels as
+    // native floats, x fastest. The version has to be bumped whenever the
+    // file layout or the output of the noise functions changes.
+    const char MAGIC[4] = { 'C', 'G', 'N', 'T' };
+    const uint32_t VERSION = 1;
+    const uint32_t ENDIAN_TAG = 0x01020304;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t endian;
+        int32_t width;
+        int32_t height;
+        int32_t depth;
+        int32_t px;
+        int32_t py;
+        int32_t pz;
+        int32_t octaves;
+        uint32_t seed;
+        uint32_t reserved[5];
+    };
+
+
+    size_t texel_count( const cgmath::NoiseTextureParams& p ) {
+        return static_cast<size_t>(p.width) * p.height * p.depth;
+    }
+
+
+    bool valid_params( const cgmath::NoiseTextureParams& p ) {
+        return (p.width > 0) && (p.height > 0) && (p.depth > 0) &&
+               (p.px > 0) && (p.py > 0) && (p.pz > 0) && (p.octaves > 0);
+    }
+
+
+    // Maps a file read-only into memory, returns 0 on failure
+    void* map_file( const char *path, size_t *size ) {
+    #ifdef WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return 0;
+        LARGE_INTEGER li;
+        if (!GetFileSizeEx(file, &li) || (li.QuadPart == 0)) {
+            CloseHandle(file);
+            return 0;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (!mapping) return 0;
+        void *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        *size = static_cast<size_t>(li.QuadPart);
+        return p;
+    #else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return 0;
+        struct stat st;
+        if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+            close(fd);
+            return 0;
+        }
+        void *p = mmap(0, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return 0;
+        *size = static_cast<size_t>(st.st_size);
+        return p;
+    #endif
+    }
+
+
+    // Creates a temporary file next to path, named uniquely for this
+    // writer, and opens it for writing; returns 0 on failure
+    FILE* create_temp( const char *path, std::string& tmp ) {
+    #ifdef WIN32
+        char suffix[48];
+        std::sprintf(suffix, ".%lu.%lu.tmp", static_cast<unsigned long>(GetCurrentProcessId()),
+                     static_cast<unsigned long>(GetCurrentThreadId()));
+        tmp = std::string(path) + suffix;
+        return std::fopen(tmp.c_str(), "wb");
+    #else
+        tmp = std::string(path) + ".XXXXXX";
+        int fd = mkstemp(&tmp[0]);
+        if (fd < 0) return 0;
+        fchmod(fd, 0644);       // mkstemp creates the file readable by the owner only
+        FILE *f = fdopen(fd, "wb");
+        if (!f) {
+            close(fd);
+            std::remove(tmp.c_str());
+        }
+        return f;
+    #endif
+    }
+
+
+    void unmap_file( void *p, size_t size ) {
+    #ifdef WIN32
+        (void)size;
+        UnmapViewOfFile(p);
+    #else
+        munmap(p, size);
+    #endif
+    }
+
+
+    inline int wrap( int i, int n ) {
+        i %= n;
+        return (i < 0)? i + n : i;
+    }
+
+
+    // Texel indices and weights of a linear (taps = 2) or Catmull-Rom
+    // (taps = 4) filter along one axis. Axes of size 1 collapse to one tap.
+    int filter_taps( float x, int period, int n, int taps, int *idx, float *w ) {
+        if (n == 1) {
+            idx[0] = 0;
+            w[0] = 1;
+            return 1;
+        }
+
+        float u = x * n / period;
+        float fu = std::floor(u);
+        float t = u - fu;
+        int i = static_cast<int>(fu);
+
+        if (taps == 2) {
+            idx[0] = wrap(i, n);
+            idx[1] = wrap(i + 1, n);
+            w[0] = 1 - t;
+            w[1] = t;
+        } else {
+            for (int k = 0; k < 4; ++k) idx[k] = wrap(i - 1 + k, n);
+            w[0] = 0.5f * t * ((2 - t) * t - 1);
+            w[1] = 0.5f * (t * t * (3 * t - 5) + 2);
+            w[2] = 0.5f * t * ((4 - 3 * t) * t + 1);
+            w[3] = 0.5f * (t - 1) * t * t;
+        }
+        return taps;
+    }
+
+
+    float filter( const cgmath::NoiseTextureParams& p, const float *data,
+                  float x, float y, float z, int taps )
+    {
+        int ix[4], iy[4], iz[4];
+        float wx[4], wy[4], wz[4];
+        int nx = filter_taps(x, p.px, p.width, taps, ix, wx);
+        int ny = filter_taps(y, p.py, p.height, taps, iy, wy);
+        int nz = filter_taps(z, p.pz, p.depth, taps, iz, wz);
+
+        float sum = 0;
+        for (int k = 0; k < nz; ++k) {
+            for (int j = 0; j < ny; ++j) {
+                const float *row = data + (static_cast<size_t>(iz[k]) * p.height + iy[j]) * p.width;
+                float s = 0;
+                for (int i = 0; i < nx; ++i) s += wx[i] * row[ix[i]];
+                sum += wz[k] * wy[j] * s;
+            }
+        }
+        return sum;
+    }
+
+}
+
+
+cgmath::NoiseTexture::NoiseTexture() : m_data(0), m_map(0), m_map_size(0) {
+}
+
+
+cgmath::NoiseTexture::~NoiseTexture() {
+    clear();
+}
+
+
+void cgmath::NoiseTexture::clear() {
+    if (m_map) {
+        unmap_file(m_map, m_map_size);
+        m_map = 0;
+        m_map_size = 0;
+    }
+    std::vector<float>().swap(m_buffer);
+    m_data = 0;
+}
+
+
+void cgmath::NoiseTexture::bake( const NoiseTextureParams& p ) {
+    clear();
+    if (!valid_params(p)) return;
+
+    NoiseContext context(p.seed);
+    FractalNoise f(FractalNoise::FBM, p.octaves, 2, 0.5f);
+    f.context = &context;
+    f.px = p.px;
+    f.py = p.py;
+    f.pz = p.pz;
+
+    m_buffer.resize(texel_count(p));
+    float dx = static_cast<float>(p.px) / p.width;
+    float dy = static_cast<float>(p.py) / p.height;
+    if (p.depth == 1) {
+        f.fill(&m_buffer[0], p.width, p.height, 0, 0, dx, dy);
+    } else {
+        float dz = static_cast<float>(p.pz) / p.depth;
+        f.fill(&m_buffer[0], p.width, p.height, p.depth, 0, 0, 0, dx, dy, dz);
+    }
+
+    m_params = p;
+    m_data = &m_buffer[0];
+}
+
+
+bool cgmath::NoiseTexture::load( const char *path ) {
+    clear();
+
+    size_t size = 0;
+    void *map = map_file(path, &size);
+    if (!map) return false;
+
+    Header h;
+    NoiseTextureParams p;
+    bool ok = size >= sizeof(Header);
+    if (ok) {
+        std::memcpy(&h, map, sizeof(Header));
+        p.width = h.width;
+        p.height = h.height;
+        p.depth = h.depth;
+        p.px = h.px;
+        p.py = h.py;
+        p.pz = h.pz;
+        p.octaves = h.octaves;
+        p.seed = h.seed;
+        ok = (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0) && (h.version == VERSION) &&
+             (h.endian == ENDIAN_TAG) && valid_params(p) &&
+             (size >= sizeof(Header) + texel_count(p) * sizeof(float));
+    }
+    if (!ok) {
+        unmap_file(map, size);
+        return false;
+    }
+
+    m_params = p;
+    m_map = map;
+    m_map_size = size;
+    m_data = reinterpret_cast<const float*>(static_cast<const char*>(map) + sizeof(Header));
+    return true;
+}
+
+
+bool cgmath::NoiseTexture::save( const char *path ) const {
+    if (empty()) return false;
+
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.endian = ENDIAN_TAG;
+    h.width = m_params.width;
+    h.height = m_params.height;
+    h.depth = m_params.depth;
+    h.px = m_params.px;
+    h.py = m_params.py;
+    h.pz = m_params.pz;
+    h.octaves = m_params.octaves;
+    h.seed = m_params.seed;
+
+    // Write to a temporary file of our own first, so that neither a
+    // concurrent nor an interrupted writer leaves a truncated file under
+    // the final name
+    std::string tmp;
+    FILE *f = create_temp(path, tmp);
+    if (!f) return false;
+    size_t n = texel_count(m_params);
+    bool ok = (std::fwrite(&h, sizeof(h), 1, f) == 1) &&
+              (std::fwrite(m_data, sizeof(float), n, f) == n);
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok) {
+    #ifdef WIN32
+        ok = MoveFileExA(tmp.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+    #else
+        ok = std::rename(tmp.c_str(), path) == 0;
+    #endif
+    }
+    if (!ok) std::remove(tmp.c_str());
+    return ok;
+}
+
+
+bool cgmath::NoiseTexture::load_or_bake( const char *path, const NoiseTextureParams& p ) {
+    if (load(path) && (m_params == p)) return true;
+    bake(p);
+    return save(path);
+}
+
+
+float cgmath::NoiseTexture::sample( float x, float y ) const {
+    return filter(m_params, m_data, x, y, 0, 2);
+}
+
+
+float cgmath::NoiseTexture::sample( float x, float y, float z ) const {
+    return filter(m_params, m_data, x, y, z, 2);
+}
+
+
+float cgmath::NoiseTexture::sample_cubic( float x, float y ) const {
+    return filter(m_params, m_data, x, y, 0, 4);
+}
+
+
+float cgmath::NoiseTexture::sample_cubic( float x, float y, float z ) const {
+    return filter(m_params, m_data, x, y, z, 4);
+}
@@ -0,0 +1,112 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/types.h>
+#include <cstddef>
+#include <vector>
+
+namespace cgmath {
+
+    /// Parameters of a baked noise texture
+    struct NoiseTextureParams {
+        NoiseTextureParams( int w = 64, int h = 64, int d = 1 )
+            : width(w), height(h), depth(d), px(4), py(4), pz(4), octaves(4), seed(0) { }
+
+        bool operator==( const NoiseTextureParams& p ) const {
+            return (width == p.width) && (height == p.height) && (depth == p.depth) &&
+                   (px == p.px) && (py == p.py) && (pz == p.pz) &&
+                   (octaves == p.octaves) && (seed == p.seed);
+        }
+
+        int width;      ///< resolution in texels
+        int height;
+        int depth;      ///< 1 for 2D textures
+        int px;         ///< period of the first octave in lattice units, the texture spans one period
+        int py;
+        int pz;
+        int octaves;
+        uint32_t seed;  ///< seed of the NoiseContext
+    };
+
+
+    /// Tileable fBm texture, baked from pnoise() once and cached on disk.
+    ///
+    /// Texel (i,j,k) holds the fractal sum at (i * px / width, j * py / height,
+    /// k * pz / depth) of octaves with lacunarity 2 and gain 1/2, so the
+    /// texture tiles seamlessly. Cache files are mapped into memory, so
+    /// loading costs a few page faults and no copy. A texture is read-only
+    /// once baked or loaded and may be sampled from several threads.
+    class NoiseTexture {
+    public:
+        NoiseTexture();
+        ~NoiseTexture();
+
+        /// Bakes the texture into memory
+        void bake( const NoiseTextureParams& p );
+
+        /// Maps a cache file written by save(). Fails if the file is
+        /// missing, truncated or written by a different version.
+        bool load( const char *path );
+
+        /// Writes the texture to a temporary file and renames it to path,
+        /// so several processes may save or load_or_bake the same file.
+        bool save( const char *path ) const;
+
+        /// Maps the cache file if it holds a texture with parameters p,
+        /// otherwise bakes the texture and (re)writes the file. Only
+        /// returns false if the file could not be written; the texture is
+        /// usable in any case.
+        bool load_or_bake( const char *path, const NoiseTextureParams& p );
+
+        void clear();
+
+        bool empty() const {
+            return m_data == 0;
+        }
+
+        const NoiseTextureParams& params() const {
+            return m_params;
+        }
+
+        /// Texel data, x fastest
+        const float* data() const {
+            return m_data;
+        }
+
+        /// Trilinear lookup at a point given in noise lattice coordinates,
+        /// with wrap-around. The 2D versions sample layer 0.
+        float sample( float x, float y ) const;
+        float sample( float x, float y, float z ) const;
+
+        /// Tricubic (Catmull-Rom) lookup, otherwise like sample()
+        float sample_cubic( float x, float y ) const;
+        float sample_cubic( float x, float y, float z ) const;
+
+    private:
+        NoiseTexture( const NoiseTexture& );
+        NoiseTexture& operator=( const NoiseTexture& );
+
+        NoiseTextureParams m_params;
+        const float *m_data;
+        std::vector<float> m_buffer;
+        void *m_map;
+        size_t m_map_size;
+    };
+
+}
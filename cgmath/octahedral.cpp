@@ -0,0 +1,194 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/octahedral.h>
+#include <cgmath/simd.h>
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+
+using namespace cgmath::simd;
+
+
+namespace {
+
+    using cgmath::Vec2;
+    using cgmath::Vec3f;
+
+    // The lane functions below follow the scalar ones in octahedral.h
+    // operation by operation, so the results are bit for bit the same.
+    // util.h's min and max pick their second argument on ties, like the
+    // simd.h ones.
+
+    vfloat absolute( vfloat a ) {
+        return negate_if(cmp_lt(a, splat(0.0f)), a);
+    }
+
+    void project( vfloat x, vfloat y, vfloat z, vfloat& px, vfloat& py ) {
+        vfloat zero = splat(0.0f);
+        vfloat one = splat(1.0f);
+        vfloat s = div(one, max(add(add(absolute(x), absolute(y)), absolute(z)), splat(FLT_MIN)));
+        px = mul(x, s);
+        py = mul(y, s);
+        vfloat fx = sub(one, absolute(py));
+        vfloat fy = sub(one, absolute(px));
+        vmask lower = cmp_lt(z, zero);
+        px = select(lower, negate_if(cmp_lt(px, zero), fx), px);
+        py = select(lower, negate_if(cmp_lt(py, zero), fy), py);
+    }
+
+    void unproject( vfloat px, vfloat py, vfloat& x, vfloat& y, vfloat& z ) {
+        vfloat zero = splat(0.0f);
+        z = sub(sub(splat(1.0f), absolute(px)), absolute(py));
+        vfloat t = max(sub(zero, z), zero);     // -z and 0 - z differ only in the sign of zero
+        x = sub(px, negate_if(cmp_lt(px, zero), t));
+        y = sub(py, negate_if(cmp_lt(py, zero), t));
+    }
+
+    vfloat dot( vfloat ax, vfloat ay, vfloat az, vfloat bx, vfloat by, vfloat bz ) {
+        return add(add(mul(ax, bx), mul(ay, by)), mul(az, bz));
+    }
+
+    template <typename S> vfloat dequantize( vint q ) {
+        return max(splat(-1.0f), mul(to_float(q), splat(1.0f / std::numeric_limits<S>::max())));
+    }
+
+    template <typename S> void quantize( vfloat x, vfloat y, vfloat z, vint& qx, vint& qy ) {
+        vfloat m = splat(static_cast<float>(std::numeric_limits<S>::max()));
+        vfloat px, py;
+        project(x, y, z, px, py);
+        qx = floor_int(add(mul(px, m), splat(0.5f)));
+        qy = floor_int(add(mul(py, m), splat(0.5f)));
+    }
+
+    template <typename S> void quantize_precise( vfloat x, vfloat y, vfloat z, vint& qx, vint& qy ) {
+        const int m = std::numeric_limits<S>::max();
+        vfloat fm = splat(static_cast<float>(m));
+        vint lo = splat(-m);
+        vint hi = splat(m);
+        vfloat px, py;
+        project(x, y, z, px, py);
+        vint x0 = floor_int(mul(px, fm));
+        vint y0 = floor_int(mul(py, fm));
+        x0 = select(cmp_lt(x0, lo), lo, x0);
+        y0 = select(cmp_lt(y0, lo), lo, y0);
+        vfloat best_err = splat(0.0f);
+        for (int k = 0; k < 4; ++k) {
+            vint cx = add(x0, splat(k & 1));
+            vint cy = add(y0, splat(k >> 1));
+            cx = select(cmp_lt(hi, cx), hi, cx);
+            cy = select(cmp_lt(hi, cy), hi, cy);
+            vfloat ux, uy, uz;
+            unproject(dequantize<S>(cx), dequantize<S>(cy), ux, uy, uz);
+            vfloat c0 = sub(mul(y, uz), mul(z, uy));
+            vfloat c1 = sub(mul(z, ux), mul(x, uz));
+            vfloat c2 = sub(mul(x, uy), mul(y, ux));
+            vfloat err = div(dot(c0, c1, c2, c0, c1, c2), dot(ux, uy, uz, ux, uy, uz));
+            if (k == 0) {
+                qx = cx;
+                qy = cy;
+                best_err = err;
+            } else {
+                vmask better = cmp_lt(err, best_err);
+                qx = select(better, cx, qx);
+                qy = select(better, cy, qy);
+                best_err = select(better, err, best_err);
+            }
+        }
+    }
+
+    // The normals are transposed into lanes a register at a time, the
+    // tail padded with (0,0,1)
+    template <typename S, bool PRECISE> void encode( const Vec3f *src, Vec2<S> *dst, size_t n ) {
+        float x[width], y[width], z[width];
+        int qx[width], qy[width];
+        for (size_t i = 0; i < n; i += width) {
+            size_t m = std::min<size_t>(width, n - i);
+            for (size_t j = 0; j < m; ++j) {
+                x[j] = src[i + j].x;
+                y[j] = src[i + j].y;
+                z[j] = src[i + j].z;
+            }
+            for (size_t j = m; j < width; ++j) {
+                x[j] = y[j] = 0;
+                z[j] = 1;
+            }
+            vint vx, vy;
+            if (PRECISE) {
+                quantize_precise<S>(load(x), load(y), load(z), vx, vy);
+            } else {
+                quantize<S>(load(x), load(y), load(z), vx, vy);
+            }
+            store(qx, vx);
+            store(qy, vy);
+            for (size_t j = 0; j < m; ++j) {
+                dst[i + j] = Vec2<S>(static_cast<S>(qx[j]), static_cast<S>(qy[j]));
+            }
+        }
+    }
+
+    template <typename S> void decode( const Vec2<S> *src, Vec3f *dst, size_t n ) {
+        int qx[width], qy[width];
+        float x[width], y[width], z[width];
+        for (size_t i = 0; i < n; i += width) {
+            size_t m = std::min<size_t>(width, n - i);
+            for (size_t j = 0; j < m; ++j) {
+                qx[j] = src[i + j].x;
+                qy[j] = src[i + j].y;
+            }
+            for (size_t j = m; j < width; ++j) qx[j] = qy[j] = 0;
+            vfloat ux, uy, uz;
+            unproject(dequantize<S>(load(qx)), dequantize<S>(load(qy)), ux, uy, uz);
+            vfloat s = div(splat(1.0f), cgmath::simd::sqrt(dot(ux, uy, uz, ux, uy, uz)));
+            store(x, mul(ux, s));
+            store(y, mul(uy, s));
+            store(z, mul(uz, s));
+            for (size_t j = 0; j < m; ++j) dst[i + j] = Vec3f(x[j], y[j], z[j]);
+        }
+    }
+
+}
+
+
+void cgmath::oct_encode( const Vec3f *src, Oct16 *dst, size_t n ) {
+    encode<int16_t, false>(src, dst, n);
+}
+
+
+void cgmath::oct_encode( const Vec3f *src, Oct8 *dst, size_t n ) {
+    encode<int8_t, false>(src, dst, n);
+}
+
+
+void cgmath::oct_encode_precise( const Vec3f *src, Oct16 *dst, size_t n ) {
+    encode<int16_t, true>(src, dst, n);
+}
+
+
+void cgmath::oct_encode_precise( const Vec3f *src, Oct8 *dst, size_t n ) {
+    encode<int8_t, true>(src, dst, n);
+}
+
+
+void cgmath::oct_decode( const Oct16 *src, Vec3f *dst, size_t n ) {
+    decode(src, dst, n);
+}
+
+
+void cgmath::oct_decode( const Oct8 *src, Vec3f *dst, size_t n ) {
+    decode(src, dst, n);
+}
@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/types.h>
+#include <cgmath/util.h>
+#include <cgmath/vec2.h>
+#include <cgmath/vec3.h>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace cgmath {
+
+    /// Octahedral unit normals in two snorm components, 4 and 2 bytes
+    /// instead of the 12 of a Vec3f. The largest angle between a unit
+    /// normal and its decoded encoding, over 2*10^7 random normals, is
+    ///
+    ///                 fast        precise
+    ///     Oct16       0.0037 deg  0.0025 deg
+    ///     Oct8        0.96 deg    0.64 deg
+    ///
+    /// The fast encoders round to the nearest grid point, the precise ones
+    /// pick whichever of the four surrounding grid points decodes closest
+    /// to the normal, at two (batch) to four (scalar) times the cost.
+    typedef Vec2<int16_t> Oct16;
+    typedef Vec2<int8_t> Oct8;
+
+    /// Octahedral projection of a direction to [-1,1]^2: the direction is
+    /// scaled onto the octahedron |x| + |y| + |z| = 1, and the lower half
+    /// folded over the upper one. The zero vector maps to (0,0).
+    inline Vec2f oct_project( const Vec3f& n ) {
+        float s = 1 / max(abs(n.x) + abs(n.y) + abs(n.z), FLT_MIN);
+        float px = n.x * s;
+        float py = n.y * s;
+        if (n.z < 0) {
+            float fx = 1 - abs(py);
+            float fy = 1 - abs(px);
+            px = (px < 0)? -fx : fx;
+            py = (py < 0)? -fy : fy;
+        }
+        return Vec2f(px, py);
+    }
+
+    /// Inverse of oct_project, a point on the octahedron; not normalized
+    inline Vec3f oct_unproject( const Vec2f& p ) {
+        float z = 1 - abs(p.x) - abs(p.y);
+        float t = max(-z, 0.0f);
+        return Vec3f(p.x - ((p.x < 0)? -t : t), p.y - ((p.y < 0)? -t : t), z);
+    }
+
+    /// Projection scaled to the snorm range and rounded to nearest
+    template <typename S> Vec2<S> oct_quantize( const Vec3f& n ) {
+        const float m = std::numeric_limits<S>::max();
+        Vec2f p = oct_project(n);
+        return Vec2<S>(static_cast<S>(std::floor(p.x * m + 0.5f)),
+                       static_cast<S>(std::floor(p.y * m + 0.5f)));
+    }
+
+    /// Snorm to [-1,1]^2, with -max - 1 clamped to -1 like graphics APIs do
+    template <typename S> Vec2f oct_dequantize( const Vec2<S>& q ) {
+        const float k = 1.0f / std::numeric_limits<S>::max();
+        return Vec2f(max(-1.0f, q.x * k), max(-1.0f, q.y * k));
+    }
+
+    /// Of the grid points around the scaled projection, the one whose
+    /// decoded direction has the smallest angle to n. The angles are
+    /// compared by their squared sine, which unlike the cosine still
+    /// resolves the small differences between the Oct16 candidates.
+    template <typename S> Vec2<S> oct_quantize_precise( const Vec3f& n ) {
+        const int m = std::numeric_limits<S>::max();
+        Vec2f p = oct_project(n);
+        int x0 = max(static_cast<int>(std::floor(p.x * m)), -m);
+        int y0 = max(static_cast<int>(std::floor(p.y * m)), -m);
+        Vec2<S> best;
+        float best_err = 0;
+        for (int k = 0; k < 4; ++k) {
+            Vec2<S> q(static_cast<S>(min(x0 + (k & 1), m)), static_cast<S>(min(y0 + (k >> 1), m)));
+            Vec3f u = oct_unproject(oct_dequantize(q));
+            Vec3f c = cross(n, u);
+            float err = dot(c, c) / dot(u, u);
+            if ((k == 0) || (err < best_err)) {
+                best = q;
+                best_err = err;
+            }
+        }
+        return best;
+    }
+
+    /// Encodes a unit normal; longer vectors work the same, as their direction
+    template <typename T> Oct16 oct_encode16( const Vec3<T>& n ) {
+        return oct_quantize<int16_t>(Vec3f(n));
+    }
+
+    template <typename T> Oct8 oct_encode8( const Vec3<T>& n ) {
+        return oct_quantize<int8_t>(Vec3f(n));
+    }
+
+    template <typename T> Oct16 oct_encode16_precise( const Vec3<T>& n ) {
+        return oct_quantize_precise<int16_t>(Vec3f(n));
+    }
+
+    template <typename T> Oct8 oct_encode8_precise( const Vec3<T>& n ) {
+        return oct_quantize_precise<int8_t>(Vec3f(n));
+    }
+
+    /// Decodes to a unit normal, computed in float
+    template <typename T = float> Vec3<T> oct_decode( const Oct16& e ) {
+        return Vec3<T>(normalize(oct_unproject(oct_dequantize(e))));
+    }
+
+    template <typename T = float> Vec3<T> oct_decode( const Oct8& e ) {
+        return Vec3<T>(normalize(oct_unproject(oct_dequantize(e))));
+    }
+
+    /// Batch encoding and decoding of n normals, a SIMD register at a time
+    /// (see simd.h). Results are identical to the functions above.
+    void oct_encode( const Vec3f *src, Oct16 *dst, size_t n );
+    void oct_encode( const Vec3f *src, Oct8 *dst, size_t n );
+    void oct_encode_precise( const Vec3f *src, Oct16 *dst, size_t n );
+    void oct_encode_precise( const Vec3f *src, Oct8 *dst, size_t n );
+    void oct_decode( const Oct16 *src, Vec3f *dst, size_t n );
+    void oct_decode( const Oct8 *src, Vec3f *dst, size_t n );
+
+}
@@ -0,0 +1,384 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#if !defined(CGMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define CGMATH_PACKET_SSE
+#include <emmintrin.h>
+#endif
+#if !defined(CGMATH_NO_SIMD) && defined(__AVX__)
+#define CGMATH_PACKET_AVX
+#include <immintrin.h>
+#endif
+
+#include <cgmath/vec2.h>
+#include <cgmath/vec3.h>
+#include <cgmath/vec4.h>
+#include <cgmath/vec_array.h>
+#include <cmath>
+
+namespace cgmath {
+
+    //
+    // Packets of 4 and 8 floats that behave like a float in every lane, so
+    // Vec3<Float4> runs the scalar vector code of vec3.h on 4 vectors at
+    // once. Comparisons give lane masks, which pick lanes with select()
+    // instead of branching. Float4 uses SSE2 and Float8 AVX, otherwise
+    // they fall back to plain arrays; CGMATH_NO_SIMD forces the fallback.
+    // Every operation is the same IEEE operation as the scalar one.
+    //
+
+    /// Lane mask of 4 comparisons
+    class Bool4 {
+    public:
+        enum { width = 4 };
+
+        Bool4() {}
+
+#ifdef CGMATH_PACKET_SSE
+        Bool4( bool b ) : m(_mm_castsi128_ps(_mm_set1_epi32(b? -1 : 0))) {}
+        explicit Bool4( __m128 a ) : m(a) {}
+
+        int bits() const { return _mm_movemask_ps(m); }
+
+        friend Bool4 operator&( Bool4 a, Bool4 b ) { return Bool4(_mm_and_ps(a.m, b.m)); }
+        friend Bool4 operator|( Bool4 a, Bool4 b ) { return Bool4(_mm_or_ps(a.m, b.m)); }
+        friend Bool4 operator^( Bool4 a, Bool4 b ) { return Bool4(_mm_xor_ps(a.m, b.m)); }
+        friend Bool4 operator!( Bool4 a ) { return a ^ Bool4(true); }
+
+        __m128 m;
+#else
+        Bool4( bool b ) { for (int i = 0; i < 4; ++i) m[i] = b; }
+
+        int bits() const { return m[0] | (m[1] << 1) | (m[2] << 2) | (m[3] << 3); }
+
+        friend Bool4 operator&( Bool4 a, Bool4 b ) { for (int i = 0; i < 4; ++i) a.m[i] = a.m[i] && b.m[i]; return a; }
+        friend Bool4 operator|( Bool4 a, Bool4 b ) { for (int i = 0; i < 4; ++i) a.m[i] = a.m[i] || b.m[i]; return a; }
+        friend Bool4 operator^( Bool4 a, Bool4 b ) { for (int i = 0; i < 4; ++i) a.m[i] = a.m[i] != b.m[i]; return a; }
+        friend Bool4 operator!( Bool4 a ) { for (int i = 0; i < 4; ++i) a.m[i] = !a.m[i]; return a; }
+
+        bool m[4];
+#endif
+
+        bool operator[]( int i ) const { return ((bits() >> i) & 1) != 0; }
+
+        friend bool any( Bool4 a ) { return a.bits() != 0; }
+        friend bool all( Bool4 a ) { return a.bits() == 15; }
+    };
+
+
+    /// 4 float lanes
+    class Float4 {
+    public:
+        enum { width = 4 };
+        typedef float scalar_type;
+        typedef Bool4 mask_type;
+
+        Float4() {}
+
+#ifdef CGMATH_PACKET_SSE
+        Float4( float a ) : m(_mm_set1_ps(a)) {}
+        Float4( float a, float b, float c, float d ) : m(_mm_setr_ps(a, b, c, d)) {}
+        explicit Float4( __m128 a ) : m(a) {}
+
+        /// Loads src[0..3]
+        static Float4 load( const float *src ) { return Float4(_mm_loadu_ps(src)); }
+        void get( float *dst ) const { _mm_storeu_ps(dst, m); }
+
+        friend Float4 operator+( Float4 a, Float4 b ) { return Float4(_mm_add_ps(a.m, b.m)); }
+        friend Float4 operator-( Float4 a, Float4 b ) { return Float4(_mm_sub_ps(a.m, b.m)); }
+        friend Float4 operator*( Float4 a, Float4 b ) { return Float4(_mm_mul_ps(a.m, b.m)); }
+        friend Float4 operator/( Float4 a, Float4 b ) { return Float4(_mm_div_ps(a.m, b.m)); }
+        friend Float4 operator-( Float4 a ) { return Float4(_mm_xor_ps(a.m, _mm_set1_ps(-0.0f))); }
+
+        friend Bool4 operator<( Float4 a, Float4 b ) { return Bool4(_mm_cmplt_ps(a.m, b.m)); }
+        friend Bool4 operator<=( Float4 a, Float4 b ) { return Bool4(_mm_cmple_ps(a.m, b.m)); }
+        friend Bool4 operator>( Float4 a, Float4 b ) { return Bool4(_mm_cmpgt_ps(a.m, b.m)); }
+        friend Bool4 operator>=( Float4 a, Float4 b ) { return Bool4(_mm_cmpge_ps(a.m, b.m)); }
+        friend Bool4 operator==( Float4 a, Float4 b ) { return Bool4(_mm_cmpeq_ps(a.m, b.m)); }
+        friend Bool4 operator!=( Float4 a, Float4 b ) { return Bool4(_mm_cmpneq_ps(a.m, b.m)); }
+
+        /// Lanes of a where m is set, of b elsewhere
+        friend Float4 select( Bool4 m, Float4 a, Float4 b ) {
+            return Float4(_mm_or_ps(_mm_and_ps(m.m, a.m), _mm_andnot_ps(m.m, b.m)));
+        }
+
+        friend Float4 sqrt( Float4 a ) { return Float4(_mm_sqrt_ps(a.m)); }
+        friend Float4 abs( Float4 a ) { return Float4(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.m)); }
+
+        __m128 m;
+#else
+        Float4( float a ) { for (int i = 0; i < 4; ++i) m[i] = a; }
+        Float4( float a, float b, float c, float d ) { m[0] = a; m[1] = b; m[2] = c; m[3] = d; }
+
+        /// Loads src[0..3]
+        static Float4 load( const float *src ) { return Float4(src[0], src[1], src[2], src[3]); }
+        void get( float *dst ) const { for (int i = 0; i < 4; ++i) dst[i] = m[i]; }
+
+        friend Float4 operator+( Float4 a, Float4 b ) { for (int i = 0; i < 4; ++i) a.m[i] += b.m[i]; return a; }
+        friend Float4 operator-( Float4 a, Float4 b ) { for (int i = 0; i < 4; ++i) a.m[i] -= b.m[i]; return a; }
+        friend Float4 operator*( Float4 a, Float4 b ) { for (int i = 0; i < 4; ++i) a.m[i] *= b.m[i]; return a; }
+        friend Float4 operator/( Float4 a, Float4 b ) { for (int i = 0; i < 4; ++i) a.m[i] /= b.m[i]; return a; }
+        friend Float4 operator-( Float4 a ) { for (int i = 0; i < 4; ++i) a.m[i] = -a.m[i]; return a; }
+
+        friend Bool4 operator<( Float4 a, Float4 b ) { Bool4 r; for (int i = 0; i < 4; ++i) r.m[i] = a.m[i] < b.m[i]; return r; }
+        friend Bool4 operator<=( Float4 a, Float4 b ) { Bool4 r; for (int i = 0; i < 4; ++i) r.m[i] = a.m[i] <= b.m[i]; return r; }
+        friend Bool4 operator>( Float4 a, Float4 b ) { Bool4 r; for (int i = 0; i < 4; ++i) r.m[i] = a.m[i] > b.m[i]; return r; }
+        friend Bool4 operator>=( Float4 a, Float4 b ) { Bool4 r; for (int i = 0; i < 4; ++i) r.m[i] = a.m[i] >= b.m[i]; return r; }
+        friend Bool4 operator==( Float4 a, Float4 b ) { Bool4 r; for (int i = 0; i < 4; ++i) r.m[i] = a.m[i] == b.m[i]; return r; }
+        friend Bool4 operator!=( Float4 a, Float4 b ) { Bool4 r; for (int i = 0; i < 4; ++i) r.m[i] = a.m[i] != b.m[i]; return r; }
+
+        /// Lanes of a where m is set, of b elsewhere
+        friend Float4 select( Bool4 m, Float4 a, Float4 b ) { for (int i = 0; i < 4; ++i) if (!m.m[i]) a.m[i] = b.m[i]; return a; }
+
+        friend Float4 sqrt( Float4 a ) { for (int i = 0; i < 4; ++i) a.m[i] = std::sqrt(a.m[i]); return a; }
+        friend Float4 abs( Float4 a ) { for (int i = 0; i < 4; ++i) a.m[i] = std::fabs(a.m[i]); return a; }
+
+        float m[4];
+#endif
+
+        float operator[]( int i ) const { float t[4]; get(t); return t[i]; }
+
+        Float4& operator+=( Float4 b ) { return *this = *this + b; }
+        Float4& operator-=( Float4 b ) { return *this = *this - b; }
+        Float4& operator*=( Float4 b ) { return *this = *this * b; }
+        Float4& operator/=( Float4 b ) { return *this = *this / b; }
+
+        friend Float4 min( Float4 a, Float4 b ) { return select(a < b, a, b); }
+        friend Float4 max( Float4 a, Float4 b ) { return select(a > b, a, b); }
+        friend Float4 clamp( Float4 x, Float4 a, Float4 b ) { return select(x < a, a, select(x > b, b, x)); }
+    };
+
+
+    /// Lane mask of 8 comparisons
+    class Bool8 {
+    public:
+        enum { width = 8 };
+
+        Bool8() {}
+
+#ifdef CGMATH_PACKET_AVX
+        Bool8( bool b ) : m(_mm256_castsi256_ps(_mm256_set1_epi32(b? -1 : 0))) {}
+        explicit Bool8( __m256 a ) : m(a) {}
+
+        int bits() const { return _mm256_movemask_ps(m); }
+
+        friend Bool8 operator&( Bool8 a, Bool8 b ) { return Bool8(_mm256_and_ps(a.m, b.m)); }
+        friend Bool8 operator|( Bool8 a, Bool8 b ) { return Bool8(_mm256_or_ps(a.m, b.m)); }
+        friend Bool8 operator^( Bool8 a, Bool8 b ) { return Bool8(_mm256_xor_ps(a.m, b.m)); }
+        friend Bool8 operator!( Bool8 a ) { return a ^ Bool8(true); }
+
+        __m256 m;
+#else
+        Bool8( bool b ) : lo(b), hi(b) {}
+        Bool8( Bool4 l, Bool4 h ) : lo(l), hi(h) {}
+
+        int bits() const { return lo.bits() | (hi.bits() << 4); }
+
+        friend Bool8 operator&( Bool8 a, Bool8 b ) { return Bool8(a.lo & b.lo, a.hi & b.hi); }
+        friend Bool8 operator|( Bool8 a, Bool8 b ) { return Bool8(a.lo | b.lo, a.hi | b.hi); }
+        friend Bool8 operator^( Bool8 a, Bool8 b ) { return Bool8(a.lo ^ b.lo, a.hi ^ b.hi); }
+        friend Bool8 operator!( Bool8 a ) { return Bool8(!a.lo, !a.hi); }
+
+        Bool4 lo, hi;
+#endif
+
+        bool operator[]( int i ) const { return ((bits() >> i) & 1) != 0; }
+
+        friend bool any( Bool8 a ) { return a.bits() != 0; }
+        friend bool all( Bool8 a ) { return a.bits() == 255; }
+    };
+
+
+    /// 8 float lanes
+    class Float8 {
+    public:
+        enum { width = 8 };
+        typedef float scalar_type;
+        typedef Bool8 mask_type;
+
+        Float8() {}
+
+#ifdef CGMATH_PACKET_AVX
+        Float8( float a ) : m(_mm256_set1_ps(a)) {}
+        Float8( float a, float b, float c, float d, float e, float f, float g, float h )
+            : m(_mm256_setr_ps(a, b, c, d, e, f, g, h)) {}
+        explicit Float8( __m256 a ) : m(a) {}
+
+        /// Loads src[0..7]
+        static Float8 load( const float *src ) { return Float8(_mm256_loadu_ps(src)); }
+        void get( float *dst ) const { _mm256_storeu_ps(dst, m); }
+
+        friend Float8 operator+( Float8 a, Float8 b ) { return Float8(_mm256_add_ps(a.m, b.m)); }
+        friend Float8 operator-( Float8 a, Float8 b ) { return Float8(_mm256_sub_ps(a.m, b.m)); }
+        friend Float8 operator*( Float8 a, Float8 b ) { return Float8(_mm256_mul_ps(a.m, b.m)); }
+        friend Float8 operator/( Float8 a, Float8 b ) { return Float8(_mm256_div_ps(a.m, b.m)); }
+        friend Float8 operator-( Float8 a ) { return Float8(_mm256_xor_ps(a.m, _mm256_set1_ps(-0.0f))); }
+
+        friend Bool8 operator<( Float8 a, Float8 b ) { return Bool8(_mm256_cmp_ps(a.m, b.m, _CMP_LT_OQ)); }
+        friend Bool8 operator<=( Float8 a, Float8 b ) { return Bool8(_mm256_cmp_ps(a.m, b.m, _CMP_LE_OQ)); }
+        friend Bool8 operator>( Float8 a, Float8 b ) { return Bool8(_mm256_cmp_ps(a.m, b.m, _CMP_GT_OQ)); }
+        friend Bool8 operator>=( Float8 a, Float8 b ) { return Bool8(_mm256_cmp_ps(a.m, b.m, _CMP_GE_OQ)); }
+        friend Bool8 operator==( Float8 a, Float8 b ) { return Bool8(_mm256_cmp_ps(a.m, b.m, _CMP_EQ_OQ)); }
+        friend Bool8 operator!=( Float8 a, Float8 b ) { return Bool8(_mm256_cmp_ps(a.m, b.m, _CMP_NEQ_UQ)); }
+
+        /// Lanes of a where m is set, of b elsewhere
+        friend Float8 select( Bool8 m, Float8 a, Float8 b ) { return Float8(_mm256_blendv_ps(b.m, a.m, m.m)); }
+
+        friend Float8 sqrt( Float8 a ) { return Float8(_mm256_sqrt_ps(a.m)); }
+        friend Float8 abs( Float8 a ) { return Float8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.m)); }
+
+        __m256 m;
+#else
+        Float8( float a ) : lo(a), hi(a) {}
+        Float8( float a, float b, float c, float d, float e, float f, float g, float h )
+            : lo(a, b, c, d), hi(e, f, g, h) {}
+        Float8( Float4 l, Float4 h ) : lo(l), hi(h) {}
+
+        /// Loads src[0..7]
+        static Float8 load( const float *src ) { return Float8(Float4::load(src), Float4::load(src + 4)); }
+        void get( float *dst ) const { lo.get(dst); hi.get(dst + 4); }
+
+        friend Float8 operator+( Float8 a, Float8 b ) { return Float8(a.lo + b.lo, a.hi + b.hi); }
+        friend Float8 operator-( Float8 a, Float8 b ) { return Float8(a.lo - b.lo, a.hi - b.hi); }
+        friend Float8 operator*( Float8 a, Float8 b ) { return Float8(a.lo * b.lo, a.hi * b.hi); }
+        friend Float8 operator/( Float8 a, Float8 b ) { return Float8(a.lo / b.lo, a.hi / b.hi); }
+        friend Float8 operator-( Float8 a ) { return Float8(-a.lo, -a.hi); }
+
+        friend Bool8 operator<( Float8 a, Float8 b ) { return Bool8(a.lo < b.lo, a.hi < b.hi); }
+        friend Bool8 operator<=( Float8 a, Float8 b ) { return Bool8(a.lo <= b.lo, a.hi <= b.hi); }
+        friend Bool8 operator>( Float8 a, Float8 b ) { return Bool8(a.lo > b.lo, a.hi > b.hi); }
+        friend Bool8 operator>=( Float8 a, Float8 b ) { return Bool8(a.lo >= b.lo, a.hi >= b.hi); }
+        friend Bool8 operator==( Float8 a, Float8 b ) { return Bool8(a.lo == b.lo, a.hi == b.hi); }
+        friend Bool8 operator!=( Float8 a, Float8 b ) { return Bool8(a.lo != b.lo, a.hi != b.hi); }
+
+        /// Lanes of a where m is set, of b elsewhere
+        friend Float8 select( Bool8 m, Float8 a, Float8 b ) { return Float8(select(m.lo, a.lo, b.lo), select(m.hi, a.hi, b.hi)); }
+
+        friend Float8 sqrt( Float8 a ) { return Float8(sqrt(a.lo), sqrt(a.hi)); }
+        friend Float8 abs( Float8 a ) { return Float8(abs(a.lo), abs(a.hi)); }
+
+        Float4 lo, hi;
+#endif
+
+        float operator[]( int i ) const { float t[8]; get(t); return t[i]; }
+
+        Float8& operator+=( Float8 b ) { return *this = *this + b; }
+        Float8& operator-=( Float8 b ) { return *this = *this - b; }
+        Float8& operator*=( Float8 b ) { return *this = *this * b; }
+        Float8& operator/=( Float8 b ) { return *this = *this / b; }
+
+        friend Float8 min( Float8 a, Float8 b ) { return select(a < b, a, b); }
+        friend Float8 max( Float8 a, Float8 b ) { return select(a > b, a, b); }
+        friend Float8 clamp( Float8 x, Float8 a, Float8 b ) { return select(x < a, a, select(x > b, b, x)); }
+    };
+
+
+    typedef Vec2<Float4> Vec2f4;
+    typedef Vec3<Float4> Vec3f4;
+    typedef Vec4<Float4> Vec4f4;
+    typedef Vec2<Float8> Vec2f8;
+    typedef Vec3<Float8> Vec3f8;
+    typedef Vec4<Float8> Vec4f8;
+
+
+    /// Scaling by a plain float, which the vector templates cannot deduce
+    template <typename P> Vec2<P> operator*(const Vec2<P>& v, typename P::scalar_type k) {
+        return v * P(k);
+    }
+
+    template <typename P> Vec2<P> operator*(typename P::scalar_type k, const Vec2<P>& v) {
+        return v * P(k);
+    }
+
+    template <typename P> Vec3<P> operator*(const Vec3<P>& v, typename P::scalar_type k) {
+        return v * P(k);
+    }
+
+    template <typename P> Vec3<P> operator*(typename P::scalar_type k, const Vec3<P>& v) {
+        return v * P(k);
+    }
+
+    template <typename P> Vec4<P> operator*(const Vec4<P>& v, typename P::scalar_type k) {
+        return v * P(k);
+    }
+
+    template <typename P> Vec4<P> operator*(typename P::scalar_type k, const Vec4<P>& v) {
+        return v * P(k);
+    }
+
+    /// Scalar counterparts, so code written for packets also runs on floats
+    inline float select(bool m, float a, float b) {
+        return m? a : b;
+    }
+
+    inline bool any(bool m) {
+        return m;
+    }
+
+    inline bool all(bool m) {
+        return m;
+    }
+
+    /// Lanes of a where m is set, of b elsewhere
+    template <typename M, typename T> Vec2<T> select(const M& m, const Vec2<T>& a, const Vec2<T>& b) {
+        return Vec2<T>( select(m, a.x, b.x), select(m, a.y, b.y) );
+    }
+
+    template <typename M, typename T> Vec3<T> select(const M& m, const Vec3<T>& a, const Vec3<T>& b) {
+        return Vec3<T>( select(m, a.x, b.x), select(m, a.y, b.y), select(m, a.z, b.z) );
+    }
+
+    template <typename M, typename T> Vec4<T> select(const M& m, const Vec4<T>& a, const Vec4<T>& b) {
+        return Vec4<T>( select(m, a.x, b.x), select(m, a.y, b.y), select(m, a.z, b.z), select(m, a.w, b.w) );
+    }
+
+    /// Elements i .. i + P::width - 1 of an SoA array. The streams are
+    /// padded to VecArray::ALIGNMENT, so a packet at a multiple of its
+    /// width below size() may reach past size().
+    template <typename P> void load(Vec2<P>& v, const Vec2Array& a, size_t i) {
+        v = Vec2<P>( P::load(a.x() + i), P::load(a.y() + i) );
+    }
+
+    template <typename P> void load(Vec3<P>& v, const Vec3Array& a, size_t i) {
+        v = Vec3<P>( P::load(a.x() + i), P::load(a.y() + i), P::load(a.z() + i) );
+    }
+
+    template <typename P> void load(Vec4<P>& v, const Vec4Array& a, size_t i) {
+        v = Vec4<P>( P::load(a.x() + i), P::load(a.y() + i), P::load(a.z() + i), P::load(a.w() + i) );
+    }
+
+    template <typename P> void store(Vec2Array& a, size_t i, const Vec2<P>& v) {
+        v.x.get(a.x() + i);
+        v.y.get(a.y() + i);
+    }
+
+    template <typename P> void store(Vec3Array& a, size_t i, const Vec3<P>& v) {
+        v.x.get(a.x() + i);
+        v.y.get(a.y() + i);
+        v.z.get(a.z() + i);
+    }
+
+    template <typename P> void store(Vec4Array& a, size_t i, const Vec4<P>& v) {
+        v.x.get(a.x() + i);
+        v.y.get(a.y() + i);
+        v.z.get(a.z() + i);
+        v.w.get(a.w() + i);
+    }
+
+}
@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/parallel.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+
+cgmath::ThreadPool::ThreadPool( int num_threads ) : m_stop(false) {
+    for (int i = 0; i < num_threads; ++i) {
+        m_threads.push_back(std::thread(&ThreadPool::run, this));
+    }
+}
+
+
+cgmath::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (size_t i = 0; i < m_threads.size(); ++i) {
+        m_threads[i].join();
+    }
+}
+
+
+void cgmath::ThreadPool::submit( const std::function<void()>& task ) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(task);
+    }
+    m_cond.notify_one();
+}
+
+
+void cgmath::ThreadPool::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop && m_tasks.empty()) m_cond.wait(lock);
+            if (m_tasks.empty()) return;
+            task = m_tasks.front();
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+
+cgmath::ThreadPool& cgmath::ThreadPool::global() {
+    static ThreadPool pool(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+    return pool;
+}
+
+
+namespace {
+
+    // State shared between the caller of parallel_for and its helper tasks.
+    // Helpers that are dequeued after the caller has closed the job return
+    // without touching f, so the caller never waits for queued tasks that
+    // other (possibly blocked) workers have not picked up yet.
+    struct ParallelJob {
+        ParallelJob( int count, const std::function<void(int)>& func )
+            : f(func), n(count), next(0), active(0), closed(false) {}
+
+        void work() {
+            for (;;) {
+                int i = next++;
+                if (i >= n) break;
+                f(i);
+            }
+        }
+
+        const std::function<void(int)>& f;
+        const int n;
+        std::atomic<int> next;
+        int active;
+        bool closed;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+}
+
+
+void cgmath::parallel_for( int count, const std::function<void(int)>& f, ThreadPool& pool ) {
+    int helpers = std::min(pool.size(), count - 1);
+    if (helpers <= 0) {
+        for (int i = 0; i < count; ++i) f(i);
+        return;
+    }
+
+    std::shared_ptr<ParallelJob> job = std::make_shared<ParallelJob>(count, f);
+    for (int i = 0; i < helpers; ++i) {
+        pool.submit([job]() {
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (job->closed) return;
+                ++job->active;
+            }
+            job->work();
+            std::lock_guard<std::mutex> lock(job->mutex);
+            if (--job->active == 0) job->done.notify_all();
+        });
+    }
+
+    job->work();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->closed = true;
+    while (job->active > 0) job->done.wait(lock);
+}
@@ -0,0 +1,63 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cgmath {
+
+    /// Fixed-size pool of worker threads executing queued tasks
+    class ThreadPool {
+    public:
+        explicit ThreadPool( int num_threads );
+        ~ThreadPool();
+
+        int size() const {
+            return static_cast<int>(m_threads.size());
+        }
+
+        void submit( const std::function<void()>& task );
+
+        /// Process-wide pool with one worker less than there are hardware threads
+        static ThreadPool& global();
+
+    private:
+        ThreadPool( const ThreadPool& );
+        ThreadPool& operator=( const ThreadPool& );
+        void run();
+
+        std::vector<std::thread> m_threads;
+        std::deque< std::function<void()> > m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        bool m_stop;
+    };
+
+    /// Calls f(i) for i = 0..count-1 on the workers of pool and the calling
+    /// thread, and returns when all calls have completed. Indices are handed
+    /// out dynamically, so uneven work items balance themselves. Safe to
+    /// call from within a task running on the same pool.
+    void parallel_for( int count, const std::function<void(int)>& f,
+                       ThreadPool& pool = ThreadPool::global() );
+
+}
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cgmath/vec3.h>
+#include <cmath>
 #include <cgmath/mat33.h>
 
 namespace cgmath {
@@ -27,10 +28,10 @@ namespace cgmath {
     public:
         typedef T value_type;
 
-        Quat(void) 
+        CGMATH_CONSTEXPR Quat(void) 
             : x(0), y(0), z(0), w(1) { }
 
-        Quat(T qx, T qy, T qz, T qw) 
+        CGMATH_CONSTEXPR Quat(T qx, T qy, T qz, T qw) 
             : x(qx), y(qy), z(qz), w(qw) { }
        
         explicit Quat(T angle, const Vec3<T>& axis ) {
@@ -46,7 +47,7 @@ namespace cgmath {
         explicit Quat( const Mat33<T> m ) {
             double tr,s;
             int i, j, k;
-            static int NEXT[3] = { 1,2,0 };
+            static const int NEXT[3] = { 1,2,0 };
 
             tr = m[0][0] + m[1][1] + m[2][2];
             if (tr > 0.0) {
@@ -60,31 +61,30 @@ namespace cgmath {
                 i = 0;
                 if (m[1][1] > m[0][0]) i = 1;
                 if (m[2][2] > m[i][i]) i = 2;
-                j = nxt[i];
-                k = nxt[j];
+                j = NEXT[i];
+                k = NEXT[j];
                 (*this)[i] = 0.5 * sqrt(m[i][i] - m[j][j] - m[k][k] + 1.0);
-                s = 0.25f / q[i];
+                s = 0.25 / (*this)[i];
                 (*this)[3] = (m[k][j] - m[j][k]) * s;
                 (*this)[j] = (m[j][i] + m[i][j]) * s;
                 (*this)[k] = (m[k][i] + m[i][k]) * s;
             }
         }
 
-        template <typename U> explicit Quat(const U *src) 
+        template <typename U> CGMATH_CONSTEXPR explicit Quat(const U *src) 
             : x(src[0]), y(src[1]), z(src[2]), w(src[3]) { }
 
-        Quat(const Quat& p, const Quat& q) {
-            x = p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y;
-            y = p.w * q.y + p.y * q.w + p.z * q.x - p.x * q.z;
-            z = p.w * q.z + p.z * q.w + p.x * q.y - p.y * q.x;
-            w = p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z;
-        }
+        CGMATH_CONSTEXPR Quat(const Quat& p, const Quat& q) 
+            : x(p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y),
+              y(p.w * q.y + p.y * q.w + p.z * q.x - p.x * q.z),
+              z(p.w * q.z + p.z * q.w + p.x * q.y - p.y * q.x),
+              w(p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z) { }
 
-        bool operator==(const Quat& q) const {
+        CGMATH_CONSTEXPR bool operator==(const Quat& q) const {
             return (x == q.x) && (y == q.y) && (z == q.z) && (w == q.w);
         }
 
-        bool operator!=(const Quat& q) const {
+        CGMATH_CONSTEXPR bool operator!=(const Quat& q) const {
             return !this->operator==(q);
         }
 
@@ -103,7 +103,7 @@ namespace cgmath {
             dst[3] = static_cast<U>(w);
         }
 
-        const Quat& operator+=(const Quat& q) {
+        CGMATH_CONSTEXPR const Quat& operator+=(const Quat& q) {
             x += q.x; 
             y += q.y; 
             z += q.z;
@@ -111,11 +111,11 @@ namespace cgmath {
             return *this;
         }
 
-        Quat operator+(const Quat& q) const {
+        CGMATH_CONSTEXPR Quat operator+(const Quat& q) const {
             return Quat(x + q.x, y + q.y, z + q.z, w + q.w);
         }
 
-        const Quat& operator-=(const Quat& q) {
+        CGMATH_CONSTEXPR const Quat& operator-=(const Quat& q) {
             x -= q.x; 
             y -= q.y; 
             z -= q.z;
@@ -123,23 +123,23 @@ namespace cgmath {
             return *this;
         }
 
-        Quat operator-(const Quat& q) const {
+        CGMATH_CONSTEXPR Quat operator-(const Quat& q) const {
             return Quat(x - q.x, y - q.y, z - q.z, w - q.w);
         }
 
-        Quat operator-() const {
+        CGMATH_CONSTEXPR Quat operator-() const {
             return Quat(-x, -y, -z, -w);
         }
 
-        const Quat& operator*=(const Quat& q) {
+        CGMATH_CONSTEXPR const Quat& operator*=(const Quat& q) {
             return (*this = Quat(*this, q));
         }
 
-        Quat operator*(const Quat& q) {
+        CGMATH_CONSTEXPR Quat operator*(const Quat& q) const {
             return Quat(*this, q);
         }
 
-        const Quat& operator*=(T k) {
+        CGMATH_CONSTEXPR const Quat& operator*=(T k) {
             x *= k; 
             y *= k; 
             z *= k;
@@ -147,24 +147,24 @@ namespace cgmath {
             return *this;
         }
 
-        const Quat& operator/=(T d) {
+        CGMATH_CONSTEXPR const Quat& operator/=(T d) {
             return this->operator*=(static_cast<T>(1) / d);
         }
 
-        Quat operator/(T d) const {
-            return this->operator*(static_cast<T>(1) / d);
+        CGMATH_CONSTEXPR Quat operator/(T d) const {
+            return *this * (static_cast<T>(1) / d);
         }
 
-        T r() const {
+        CGMATH_CONSTEXPR T r() const {
             return w;
         }
 
-        Vec3<T> v() const {
+        CGMATH_CONSTEXPR Vec3<T> v() const {
             return Vec3<T>(x, y, z);
         }
 
         T angle() const {
-            return to_deg(2.0 * atan2(sqrt(x * x + y * y + z * z), w));
+            return degrees(2.0 * atan2(sqrt(x * x + y * y + z * z), w));
         }
 
         Vec3<T> axis() const { //FIXME
@@ -172,19 +172,18 @@ namespace cgmath {
             return normalize(axis);
         }
 
-        Mat33 matrix() const {
+        CGMATH_CONSTEXPR Mat33<T> matrix() const {
             T l = x * x + y * y + z * z + w * w;
-            if (l == 0) return Mat33(1)
+            if (l == 0) return Mat33<T>(1);
             T s = static_cast<T>(2) / l;
-            T xs, ys, zs, wx, wy, wz, xx, xy, xz, yy, yz, zz;
-            xs = q.x * s;   ys = q.y * s;  zs = q.z * s;
-            wx = q.w * xs;  wy = q.w * ys; wz = q.w * zs;
-            xx = q.x * xs;  xy = q.x * ys; xz = q.x * zs;
-            yy = q.y * ys;  yz = q.y * zs; zz = q.z * zs;
-            return Mat33(
-                1.0 - (yy + zz),     xy - wz,         xz + wy,
-                    xy + wz,     1.0 - (xx + zz),     yz - wx,
-                    xz - wy,         yz + wx,     1.0 - (xx + yy) );
+            T xs = x * s,   ys = y * s,  zs = z * s;
+            T wx = w * xs,  wy = w * ys, wz = w * zs;
+            T xx = x * xs,  xy = x * ys, xz = x * zs;
+            T yy = y * ys,  yz = y * zs, zz = z * zs;
+            return Mat33<T>(
+                1 - (yy + zz),     xy - wz,         xz + wy,
+                    xy + wz,     1 - (xx + zz),     yz - wx,
+                    xz - wy,         yz + wx,     1 - (xx + yy) );
         }
 
         T x;
@@ -193,15 +192,15 @@ namespace cgmath {
         T w;
     };
 
-    template <typename T> Quat<T> operator*(T k, const Quat<T>& q) {
+    template <typename T> CGMATH_CONSTEXPR Quat<T> operator*(T k, const Quat<T>& q) {
         return Quat<T>(q.x * k, q.y * k, q.z * k, q.w * k);
     }
 
-    template <typename T> Quat<T> operator*(const Quat<T>& q, T k) {
+    template <typename T> CGMATH_CONSTEXPR Quat<T> operator*(const Quat<T>& q, T k) {
         return Quat<T>(q.x * k, q.y * k, q.z * k, q.w * k);
     }
 
-    template <typename T> T dot(const Quat<T>& p, const Quat<T>& q) {
+    template <typename T> CGMATH_CONSTEXPR T dot(const Quat<T>& p, const Quat<T>& q) {
         return (p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w);
     }
 
@@ -210,15 +209,15 @@ namespace cgmath {
     }
 
     template <typename T> Quat<T> normalize(const Quat<T>& q) {
-        return q.operator/(q.length());
+        return q / length(q);
     }
 
-    template <typename T> Quat<T> conjugate(const Quat<T>& q) {
+    template <typename T> CGMATH_CONSTEXPR Quat<T> conjugate(const Quat<T>& q) {
         return Quat<T>(-q.x, -q.y, -q.z, q.w);
     }
 
     template <typename T> Quat<T> inverse(const Quat<T>& q) {
-        double l2 = q.length2();
+        double l2 = dot(q, q);
         if (l2 > 0) {
             double s = 1 / l2;
             return Quat<T>(-q.x * s, -q.y * s, -q.z * s, q.w * s);
@@ -230,7 +229,7 @@ namespace cgmath {
         double lv = sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
         if (lv > 0) {
             double s = atan2(lv, q.w) / lv;
-            return Quat<T>(0, q.x * s, q.y * s, q.z * s);
+            return Quat<T>(q.x * s, q.y * s, q.z * s, 0);
         }
         return Quat<T>(0, 0, 0, 0);
     }
@@ -244,6 +243,9 @@ namespace cgmath {
         return Quat<T>(0, 0, 0, 1);
     }
 
+    typedef Quat<float> Quatf;
+    typedef Quat<double> Quatd;
+
     /*
     template <typename T> std::ostream& operator<<(std::ostream& os, const quat<T>& q) {
         return (os << q.x << " " << q.y << " " << q.z << " " << q.w);
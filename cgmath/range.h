@@ -18,7 +18,10 @@
 #ifndef CGMATH_INCLUDED_RANGE_H
 #define CGMATH_INCLUDED_RANGE_H
 
+#include <algorithm>
+#include <istream>
 #include <limits>
+#include <ostream>
 
 namespace cgmath {
 
@@ -102,22 +105,22 @@ namespace cgmath {
             return Range<T>(a / s, b / s);
         }
 
-        const Range<T> expanded( T dt ) {
+        const Range<T> expanded( T dt ) const {
             return Range<T>(
                 (a != std::numeric_limits<T>::max())? a - dt : a,
-                (b != -std::numeric_limits<T>::max()) b + dt : b
+                (b != -std::numeric_limits<T>::max())? b + dt : b
             );
         }
 
-        const Range<T> united( T x ) {
+        const Range<T> united( T x ) const {
             return Range<T>(std::min(a, x), std::max(b, x));
         }
 
-        const Range<T> united( const Range<T>& r ) {
+        const Range<T> united( const Range<T>& r ) const {
             return Range<T>(std::min(a, r.a), std::max(b, r.b));
         }
 
-        const Range<T> intersected(const Range<T>& r) {
+        const Range<T> intersected(const Range<T>& r) const {
             return Range<T>(std::max(a, r.a), std::min(b, r.b));
         }
 
@@ -134,9 +137,9 @@ namespace cgmath {
         T a, b;
         is >> a >> b;
         if (a < b) 
-            r.set(a, b);
+            r = Range<T>(a, b);
         else 
-            r.clear();
+            r = Range<T>();
         return is;
     }
 } 
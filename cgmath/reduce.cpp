@@ -0,0 +1,188 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/reduce.h>
+#include <cgmath/simd.h>
+#include <algorithm>
+#include <vector>
+
+using namespace cgmath::simd;
+
+
+namespace {
+
+    const size_t BLOCK = 64 * width;       // points summed in float, 64 per lane
+    const size_t CHUNK = 1 << 16;          // points per task, a multiple of BLOCK
+
+    // Number of points, mean and co-moments sum (p - mean)(p - mean)^T,
+    // stored as xx, xy, xz, yy, yz, zz
+    struct Moments {
+        Moments() : n(0) {}
+
+        size_t n;
+        double mean[3];
+        double m2[6];
+        float lo[3], hi[3];
+    };
+
+    const int ROW[6] = { 0, 0, 0, 1, 1, 2 };
+    const int COL[6] = { 0, 1, 2, 1, 2, 2 };
+
+    // Chan, Golub and LeVeque's update for the union of two point sets
+    void merge( Moments& a, const Moments& b ) {
+        if (b.n == 0) return;
+        if (a.n == 0) {
+            a = b;
+            return;
+        }
+        double n = static_cast<double>(a.n + b.n);
+        double f = static_cast<double>(a.n) * static_cast<double>(b.n) / n;
+        double d[3];
+        for (int k = 0; k < 3; ++k) d[k] = b.mean[k] - a.mean[k];
+        for (int k = 0; k < 6; ++k) a.m2[k] += b.m2[k] + d[ROW[k]] * d[COL[k]] * f;
+        for (int k = 0; k < 3; ++k) {
+            a.mean[k] += d[k] * (static_cast<double>(b.n) / n);
+            a.lo[k] = std::min(a.lo[k], b.lo[k]);
+            a.hi[k] = std::max(a.hi[k], b.hi[k]);
+        }
+        a.n += b.n;
+    }
+
+    double lane_sum( vfloat a ) {
+        float t[width];
+        store(t, a);
+        double s = 0;
+        for (int i = 0; i < width; ++i) s += t[i];
+        return s;
+    }
+
+    // Moments of m <= BLOCK points. Coordinates are taken relative to the
+    // first point, which keeps the float sums small; the tail is padded
+    // with that point, which adds nothing to them.
+    Moments block( const float *const *p, size_t m ) {
+        float s[3] = { p[0][0], p[1][0], p[2][0] };
+        vfloat vs[3], sum[3], lo[3], hi[3], prod[6];
+        for (int k = 0; k < 3; ++k) {
+            vs[k] = lo[k] = hi[k] = splat(s[k]);
+            sum[k] = splat(0.0f);
+        }
+        for (int k = 0; k < 6; ++k) prod[k] = splat(0.0f);
+
+        auto add_points = [&]( const vfloat *v ) {
+            vfloat d[3];
+            for (int k = 0; k < 3; ++k) {
+                d[k] = sub(v[k], vs[k]);
+                sum[k] = add(sum[k], d[k]);
+                lo[k] = min(lo[k], v[k]);
+                hi[k] = max(hi[k], v[k]);
+            }
+            for (int k = 0; k < 6; ++k) prod[k] = add(prod[k], mul(d[ROW[k]], d[COL[k]]));
+        };
+
+        vfloat v[3];
+        size_t i = 0;
+        for (; i + width <= m; i += width) {
+            for (int k = 0; k < 3; ++k) v[k] = load(p[k] + i);
+            add_points(v);
+        }
+        if (i < m) {
+            float t[width];
+            for (int k = 0; k < 3; ++k) {
+                std::fill(t, t + width, s[k]);
+                std::copy(p[k] + i, p[k] + m, t);
+                v[k] = load(t);
+            }
+            add_points(v);
+        }
+
+        Moments r;
+        r.n = m;
+        double mean[3];
+        for (int k = 0; k < 3; ++k) {
+            mean[k] = lane_sum(sum[k]) / m;
+            r.mean[k] = s[k] + mean[k];
+            float t[width];
+            store(t, lo[k]);
+            r.lo[k] = *std::min_element(t, t + width);
+            store(t, hi[k]);
+            r.hi[k] = *std::max_element(t, t + width);
+        }
+        for (int k = 0; k < 6; ++k) r.m2[k] = lane_sum(prod[k]) - m * mean[ROW[k]] * mean[COL[k]];
+        return r;
+    }
+
+    // Runs block() over fixed chunks in parallel and merges the chunks
+    // pairwise, so the order of the merges does not depend on the pool
+    template <typename F> Moments reduce( size_t n, F blocks, cgmath::ThreadPool& pool ) {
+        size_t chunks = (n + CHUNK - 1) / CHUNK;
+        std::vector<Moments> partial(chunks);
+        cgmath::parallel_for(static_cast<int>(chunks), [&]( int c ) {
+            size_t begin = c * CHUNK;
+            size_t end = std::min(n, begin + CHUNK);
+            for (size_t i = begin; i < end; i += BLOCK) {
+                merge(partial[c], blocks(i, std::min(end - i, BLOCK)));
+            }
+        }, pool);
+
+        for (size_t step = 1; step < chunks; step *= 2) {
+            for (size_t c = 0; c + step < chunks; c += 2 * step) merge(partial[c], partial[c + step]);
+        }
+        return chunks? partial[0] : Moments();
+    }
+
+    cgmath::PointStats point_stats( const Moments& m ) {
+        cgmath::PointStats s;
+        s.count = m.n;
+        s.centroid = cgmath::Vec3d(0.0);
+        s.covariance = cgmath::Mat33d(0.0);
+        if (m.n == 0) return s;
+
+        double c[6];
+        for (int k = 0; k < 6; ++k) c[k] = m.m2[k] / m.n;
+        for (int k = 0; k < 3; ++k) s.bounds[k] = cgmath::Range<float>(m.lo[k], m.hi[k]);
+        s.centroid = cgmath::Vec3d(m.mean[0], m.mean[1], m.mean[2]);
+        s.covariance = cgmath::Mat33d(c[0], c[1], c[2],
+                                      c[1], c[3], c[4],
+                                      c[2], c[4], c[5]);
+        return s;
+    }
+
+}
+
+
+cgmath::PointStats cgmath::point_stats( const Vec3f *p, size_t n, ThreadPool& pool ) {
+    Moments m = reduce(n, [p]( size_t i, size_t count ) {
+        float x[BLOCK], y[BLOCK], z[BLOCK];
+        for (size_t j = 0; j < count; ++j) {
+            x[j] = p[i + j].x;
+            y[j] = p[i + j].y;
+            z[j] = p[i + j].z;
+        }
+        const float *s[3] = { x, y, z };
+        return block(s, count);
+    }, pool);
+    return ::point_stats(m);
+}
+
+
+cgmath::PointStats cgmath::point_stats( const Vec3Array& p, ThreadPool& pool ) {
+    Moments m = reduce(p.size(), [&p]( size_t i, size_t count ) {
+        const float *s[3] = { p.x() + i, p.y() + i, p.z() + i };
+        return block(s, count);
+    }, pool);
+    return ::point_stats(m);
+}
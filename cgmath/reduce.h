@@ -0,0 +1,50 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/mat33.h>
+#include <cgmath/parallel.h>
+#include <cgmath/range.h>
+#include <cgmath/vec3.h>
+#include <cgmath/vec_array.h>
+#include <cstddef>
+
+namespace cgmath {
+
+    /// Bounds, centroid and covariance of a point set, see point_stats()
+    struct PointStats {
+        size_t count;
+        Range<float> bounds[3];     ///< per axis, empty if there are no points
+        Vec3d centroid;
+        Mat33d covariance;          ///< sum of (p - centroid)(p - centroid)^T over count
+    };
+
+    /// Computes all statistics of n points in a single pass. The points
+    /// are split into fixed chunks that are processed on the workers of
+    /// pool and the calling thread. Within a chunk, blocks of a few hundred
+    /// points are summed in SIMD registers relative to the first point of
+    /// the block, and the block sums are merged in double precision with
+    /// the pairwise update of Chan et al., so that the covariance of
+    /// clouds far from the origin does not cancel out. Results do not
+    /// depend on the number of threads, and the array of structures and
+    /// the Vec3Array version agree exactly. NaN coordinates are not
+    /// supported.
+    PointStats point_stats( const Vec3f *p, size_t n, ThreadPool& pool = ThreadPool::global() );
+    PointStats point_stats( const Vec3Array& p, ThreadPool& pool = ThreadPool::global() );
+
+}
@@ -0,0 +1,279 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+//
+// Thin lane abstraction used by the batch kernels. The lane width is
+// picked at compile time: 8 with AVX2, 4 with SSE2 and 1 otherwise (or
+// if CGMATH_NO_SIMD is defined). Every operation but rsqrt maps to
+// exactly one IEEE operation per lane, so kernels written on top of it
+// give the same results as the equivalent scalar code. rsqrt is the
+// hardware estimate of 1/sqrt, good to about 12 bits.
+//
+
+#if !defined(CGMATH_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define CGMATH_SIMD_WIDTH 8
+#elif !defined(CGMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#include <emmintrin.h>
+#define CGMATH_SIMD_WIDTH 4
+#else
+#define CGMATH_SIMD_WIDTH 1
+#endif
+
+#include <cgmath/types.h>
+#include <cmath>
+#include <cstring>
+
+namespace cgmath {
+namespace simd {
+
+    enum { width = CGMATH_SIMD_WIDTH };
+
+#if CGMATH_SIMD_WIDTH == 8
+
+    typedef __m256 vfloat;
+    typedef __m256i vint;
+    typedef __m256 vmask;
+
+    inline vfloat splat( float a ) { return _mm256_set1_ps(a); }
+    inline vint splat( int a ) { return _mm256_set1_epi32(a); }
+    inline vfloat load( const float *p ) { return _mm256_loadu_ps(p); }
+    inline vint load( const int *p ) { return _mm256_loadu_si256((const __m256i*)p); }
+    inline void store( float *p, vfloat a ) { _mm256_storeu_ps(p, a); }
+    inline void store( int *p, vint a ) { _mm256_storeu_si256((__m256i*)p, a); }
+
+    inline vfloat add( vfloat a, vfloat b ) { return _mm256_add_ps(a, b); }
+    inline vfloat sub( vfloat a, vfloat b ) { return _mm256_sub_ps(a, b); }
+    inline vfloat mul( vfloat a, vfloat b ) { return _mm256_mul_ps(a, b); }
+    inline vfloat div( vfloat a, vfloat b ) { return _mm256_div_ps(a, b); }
+    inline vfloat sqrt( vfloat a ) { return _mm256_sqrt_ps(a); }
+    inline vfloat rsqrt( vfloat a ) { return _mm256_rsqrt_ps(a); }
+    inline vint add( vint a, vint b ) { return _mm256_add_epi32(a, b); }
+    inline vint sub( vint a, vint b ) { return _mm256_sub_epi32(a, b); }
+    inline vint bit_and( vint a, vint b ) { return _mm256_and_si256(a, b); }
+    inline vint bit_xor( vint a, vint b ) { return _mm256_xor_si256(a, b); }
+    inline vint shift_right( vint a, int n ) { return _mm256_srli_epi32(a, n); }
+    inline vint mul( vint a, vint b ) { return _mm256_mullo_epi32(a, b); }
+
+    inline vfloat to_float( vint a ) { return _mm256_cvtepi32_ps(a); }
+
+    inline vint fast_floor( vfloat x ) {
+        vint i = _mm256_cvttps_epi32(x);
+        vint m = _mm256_castps_si256(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ));
+        return _mm256_add_epi32(i, _mm256_xor_si256(m, _mm256_set1_epi32(-1)));
+    }
+
+    inline vint floor_int( vfloat x ) {
+        vint i = _mm256_cvttps_epi32(x);
+        vint m = _mm256_castps_si256(_mm256_cmp_ps(x, _mm256_cvtepi32_ps(i), _CMP_LT_OQ));
+        return _mm256_add_epi32(i, m);
+    }
+
+    inline vmask cmp_lt( vfloat a, vfloat b ) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    inline vmask cmp_lt( vint a, vint b ) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)); }
+    inline vmask cmp_eq( vint a, vint b ) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+    inline vmask mask_or( vmask a, vmask b ) { return _mm256_or_ps(a, b); }
+
+    inline vmask test_bit( vint a, int bit ) {
+        vint b = _mm256_set1_epi32(bit);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(a, b), b));
+    }
+
+    inline vfloat select( vmask m, vfloat a, vfloat b ) { return _mm256_blendv_ps(b, a, m); }
+    inline vint select( vmask m, vint a, vint b ) { return _mm256_blendv_epi8(b, a, _mm256_castps_si256(m)); }
+
+    inline vfloat negate_if( vmask m, vfloat a ) {
+        return _mm256_xor_ps(a, _mm256_and_ps(m, _mm256_set1_ps(-0.0f)));
+    }
+
+    inline vint gather( const int *table, vint idx ) { return _mm256_i32gather_epi32(table, idx, 4); }
+    inline vfloat gather( const float *table, vint idx ) { return _mm256_i32gather_ps(table, idx, 4); }
+
+    inline vfloat min( vfloat a, vfloat b ) { return _mm256_min_ps(a, b); }
+    inline vfloat max( vfloat a, vfloat b ) { return _mm256_max_ps(a, b); }
+    inline vint trunc_int( vfloat x ) { return _mm256_cvttps_epi32(x); }
+
+    // Narrowing stores of width lanes, which have to be in range already
+    inline void store( uint8_t *p, vint a ) {
+        vint b = _mm256_packus_epi16(_mm256_packus_epi32(a, a), a);
+        _mm_storel_epi64((__m128i*)p, _mm_unpacklo_epi32(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1)));
+    }
+
+    inline void store( uint16_t *p, vint a ) {
+        vint b = _mm256_packus_epi32(a, a);
+        _mm_storeu_si128((__m128i*)p, _mm_unpacklo_epi64(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1)));
+    }
+
+#elif CGMATH_SIMD_WIDTH == 4
+
+    typedef __m128 vfloat;
+    typedef __m128i vint;
+    typedef __m128 vmask;
+
+    inline vfloat splat( float a ) { return _mm_set1_ps(a); }
+    inline vint splat( int a ) { return _mm_set1_epi32(a); }
+    inline vfloat load( const float *p ) { return _mm_loadu_ps(p); }
+    inline vint load( const int *p ) { return _mm_loadu_si128((const __m128i*)p); }
+    inline void store( float *p, vfloat a ) { _mm_storeu_ps(p, a); }
+    inline void store( int *p, vint a ) { _mm_storeu_si128((__m128i*)p, a); }
+
+    inline vfloat add( vfloat a, vfloat b ) { return _mm_add_ps(a, b); }
+    inline vfloat sub( vfloat a, vfloat b ) { return _mm_sub_ps(a, b); }
+    inline vfloat mul( vfloat a, vfloat b ) { return _mm_mul_ps(a, b); }
+    inline vfloat div( vfloat a, vfloat b ) { return _mm_div_ps(a, b); }
+    inline vfloat sqrt( vfloat a ) { return _mm_sqrt_ps(a); }
+    inline vfloat rsqrt( vfloat a ) { return _mm_rsqrt_ps(a); }
+    inline vint add( vint a, vint b ) { return _mm_add_epi32(a, b); }
+    inline vint sub( vint a, vint b ) { return _mm_sub_epi32(a, b); }
+    inline vint bit_and( vint a, vint b ) { return _mm_and_si128(a, b); }
+    inline vint bit_xor( vint a, vint b ) { return _mm_xor_si128(a, b); }
+    inline vint shift_right( vint a, int n ) { return _mm_srli_epi32(a, n); }
+
+    // low 32 bits of the products; SSE2 only multiplies even lanes
+    inline vint mul( vint a, vint b ) {
+        vint even = _mm_mul_epu32(a, b);
+        vint odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), 
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    inline vfloat to_float( vint a ) { return _mm_cvtepi32_ps(a); }
+
+    inline vint fast_floor( vfloat x ) {
+        vint i = _mm_cvttps_epi32(x);
+        vint m = _mm_castps_si128(_mm_cmpgt_ps(x, _mm_setzero_ps()));
+        return _mm_add_epi32(i, _mm_xor_si128(m, _mm_set1_epi32(-1)));
+    }
+
+    inline vint floor_int( vfloat x ) {
+        vint i = _mm_cvttps_epi32(x);
+        vint m = _mm_castps_si128(_mm_cmplt_ps(x, _mm_cvtepi32_ps(i)));
+        return _mm_add_epi32(i, m);
+    }
+
+    inline vmask cmp_lt( vfloat a, vfloat b ) { return _mm_cmplt_ps(a, b); }
+    inline vmask cmp_lt( vint a, vint b ) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, b)); }
+    inline vmask cmp_eq( vint a, vint b ) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+    inline vmask mask_or( vmask a, vmask b ) { return _mm_or_ps(a, b); }
+
+    inline vmask test_bit( vint a, int bit ) {
+        vint b = _mm_set1_epi32(bit);
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, b), b));
+    }
+
+    inline vfloat select( vmask m, vfloat a, vfloat b ) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+
+    inline vint select( vmask m, vint a, vint b ) {
+        vint mi = _mm_castps_si128(m);
+        return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b));
+    }
+
+    inline vfloat negate_if( vmask m, vfloat a ) {
+        return _mm_xor_ps(a, _mm_and_ps(m, _mm_set1_ps(-0.0f)));
+    }
+
+    inline vint gather( const int *table, vint idx ) {
+        int i[4];
+        _mm_storeu_si128((__m128i*)i, idx);
+        return _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+    }
+
+    inline vfloat gather( const float *table, vint idx ) {
+        int i[4];
+        _mm_storeu_si128((__m128i*)i, idx);
+        return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+    }
+
+    inline vfloat min( vfloat a, vfloat b ) { return _mm_min_ps(a, b); }
+    inline vfloat max( vfloat a, vfloat b ) { return _mm_max_ps(a, b); }
+    inline vint trunc_int( vfloat x ) { return _mm_cvttps_epi32(x); }
+
+    // Narrowing stores of width lanes, which have to be in range already
+    inline void store( uint8_t *p, vint a ) {
+        vint b = _mm_packus_epi16(_mm_packs_epi32(a, a), a);
+        int r = _mm_cvtsi128_si32(b);
+        std::memcpy(p, &r, 4);
+    }
+
+    // SSE2 has no unsigned 32 to 16 bit pack, so shift to signed and back
+    inline void store( uint16_t *p, vint a ) {
+        vint b = _mm_packs_epi32(_mm_sub_epi32(a, _mm_set1_epi32(32768)), a);
+        _mm_storel_epi64((__m128i*)p, _mm_xor_si128(b, _mm_set1_epi16(-32768)));
+    }
+
+#else
+
+    typedef float vfloat;
+    typedef int vint;
+    typedef bool vmask;
+
+    inline vfloat splat( float a ) { return a; }
+    inline vint splat( int a ) { return a; }
+    inline vfloat load( const float *p ) { return *p; }
+    inline vint load( const int *p ) { return *p; }
+    inline void store( float *p, vfloat a ) { *p = a; }
+    inline void store( int *p, vint a ) { *p = a; }
+
+    inline vfloat add( vfloat a, vfloat b ) { return a + b; }
+    inline vfloat sub( vfloat a, vfloat b ) { return a - b; }
+    inline vfloat mul( vfloat a, vfloat b ) { return a * b; }
+    inline vfloat div( vfloat a, vfloat b ) { return a / b; }
+    inline vfloat sqrt( vfloat a ) { return std::sqrt(a); }
+    inline vfloat rsqrt( vfloat a ) { return 1 / std::sqrt(a); }
+    inline vint add( vint a, vint b ) { return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b)); }
+    inline vint sub( vint a, vint b ) { return static_cast<int>(static_cast<unsigned>(a) - static_cast<unsigned>(b)); }
+    inline vint bit_and( vint a, vint b ) { return a & b; }
+    inline vint bit_xor( vint a, vint b ) { return a ^ b; }
+    inline vint shift_right( vint a, int n ) { return static_cast<int>(static_cast<unsigned>(a) >> n); }
+    inline vint mul( vint a, vint b ) { return static_cast<int>(static_cast<unsigned>(a) * static_cast<unsigned>(b)); }
+
+    inline vfloat to_float( vint a ) { return static_cast<float>(a); }
+
+    inline vint fast_floor( vfloat x ) {
+        return (x > 0)? static_cast<int>(x) : static_cast<int>(x) - 1;
+    }
+
+    inline vint floor_int( vfloat x ) {
+        int i = static_cast<int>(x);
+        return (x < i)? i - 1 : i;
+    }
+
+    inline vmask cmp_lt( vfloat a, vfloat b ) { return a < b; }
+    inline vmask cmp_lt( vint a, vint b ) { return a < b; }
+    inline vmask cmp_eq( vint a, vint b ) { return a == b; }
+    inline vmask mask_or( vmask a, vmask b ) { return a || b; }
+    inline vmask test_bit( vint a, int bit ) { return (a & bit) != 0; }
+    inline vfloat select( vmask m, vfloat a, vfloat b ) { return m? a : b; }
+    inline vint select( vmask m, vint a, vint b ) { return m? a : b; }
+    inline vfloat negate_if( vmask m, vfloat a ) { return m? -a : a; }
+    inline vint gather( const int *table, vint idx ) { return table[idx]; }
+    inline vfloat gather( const float *table, vint idx ) { return table[idx]; }
+
+    inline vfloat min( vfloat a, vfloat b ) { return (a < b)? a : b; }
+    inline vfloat max( vfloat a, vfloat b ) { return (b < a)? a : b; }
+    inline vint trunc_int( vfloat x ) { return static_cast<int>(x); }
+    inline void store( uint8_t *p, vint a ) { *p = static_cast<uint8_t>(a); }
+    inline void store( uint16_t *p, vint a ) { *p = static_cast<uint16_t>(a); }
+
+#endif
+
+}
+}
@@ -66,13 +66,13 @@ namespace cgmath {
 
     void timer::reset() {
         timeval x;
-        gettimeofday(&x, NULL);
+        gettimeofday(&x, 0);
         m_current = 1000.0 * x.tv_sec + x.tv_usec / 1000.0;
     }
 
     double timer::get_elapsed_time( bool reset ) {
         timeval tv;
-        gettimeofday(&tv, NULL);
+        gettimeofday(&tv, 0);
         double x = 1000.0 * tv.tv_sec + tv.tv_usec / 1000.0;
         double dt = x - m_current;
         if (reset) {
@@ -23,6 +23,42 @@
 
 #include <limits>
 
+/// constexpr for compilers with C++14 constant expressions, whose loops
+/// and assignments the vector and matrix code needs; empty otherwise
+#if (__cplusplus >= 201402L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201402L))
+#define CGMATH_CONSTEXPR constexpr
+#else
+#define CGMATH_CONSTEXPR
+#endif
+
+/// Test for constant evaluation, which lets constexpr functions take an
+/// intrinsics path at run time. Always false without constexpr; left
+/// undefined for C++14 compilers that cannot tell.
+#if (__cplusplus >= 201402L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201402L))
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define CGMATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif (defined(__GNUC__) && (__GNUC__ >= 9)) || (defined(_MSC_VER) && (_MSC_VER >= 1925))
+#define CGMATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#else
+#define CGMATH_CONSTANT_EVALUATED() false
+#endif
+
+/// SSE versions of the Vec4<float> and Mat44<float> operations. They
+/// give the same results as the scalar code, except that FMA is used
+/// where it is enabled. Define CGMATH_NO_SIMD to debug with the scalar
+/// code; the memory layout and alignment are the same either way.
+#if !defined(CGMATH_NO_SIMD) && defined(CGMATH_CONSTANT_EVALUATED) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define CGMATH_SSE
+#include <emmintrin.h>
+#if defined(__FMA__)
+#include <immintrin.h>
+#endif
+#endif
+
 #ifdef M_PI
 #undef M_PI
 #endif
@@ -47,9 +83,19 @@ namespace cgmath {
     typedef signed __int64 int64_t;
     #endif
 
-    static const double PI = 3.14159265358979323846;
-    static const double PI_2 = 1.57079632679489661923;
-    static const double PI_4 = 0.785398163397448309616;
-    static const float EPSILON  = 1e-5f;
+    static CGMATH_CONSTEXPR const double PI = 3.14159265358979323846;
+    static CGMATH_CONSTEXPR const double PI_2 = 1.57079632679489661923;
+    static CGMATH_CONSTEXPR const double PI_4 = 0.785398163397448309616;
+    static CGMATH_CONSTEXPR const float EPSILON  = 1e-5f;
+
+    /// Alignment of Vec4<T> and Mat44<T>: 16 bytes for float, so that
+    /// they load into SSE registers directly, the natural one otherwise
+    template <typename T> struct SimdAlignment {
+        static const int value = alignof(T);
+    };
+
+    template <> struct SimdAlignment<float> {
+        static const int value = 16;
+    };
 
 }
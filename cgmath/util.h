@@ -22,39 +22,39 @@
 
 namespace cgmath {
 
-    inline double radians(double deg) { 
+    inline CGMATH_CONSTEXPR double radians(double deg) { 
         return deg * PI / 180.0; 
     }
 
-    inline float radians(float deg) { 
+    inline CGMATH_CONSTEXPR float radians(float deg) { 
         return static_cast<float>(deg * PI / 180.0 ); 
     }
     
-    inline double degrees(double rad) { 
+    inline CGMATH_CONSTEXPR double degrees(double rad) { 
         return rad * 180.0 / PI;    
     }
     
-    inline float degrees(float rad) { 
+    inline CGMATH_CONSTEXPR float degrees(float rad) { 
         return static_cast<float>(rad * 180.0 / PI); 
     }
 
-    template <typename T> inline T abs(T v) {
+    template <typename T> inline CGMATH_CONSTEXPR T abs(T v) {
         return (v < 0)? -v : v;
     }
 
-    template<typename T> inline T sign(T v) { 
+    template<typename T> inline CGMATH_CONSTEXPR T sign(T v) { 
         return v<0? (T)-1 : (T)1; 
     }
 
-    template <typename T> T min(T a, T b) {
+    template <typename T> CGMATH_CONSTEXPR T min(T a, T b) {
         return (a < b)?  a :  b;
     }
 
-    template <typename T> T max(T a, T b) {
+    template <typename T> CGMATH_CONSTEXPR T max(T a, T b) {
         return (a > b)?  a :  b;
     }
 
-    template <typename T> T clamp(T x, T a, T b) {
+    template <typename T> CGMATH_CONSTEXPR T clamp(T x, T a, T b) {
         return (x < a)?  a : ((x > b)? b : x);
     }
 
@@ -66,7 +66,7 @@ namespace cgmath {
         return abs(a - b) <= epsilon;
     }
 
-    template<typename T> inline T smoothstep(T a, T b, T x) {
+    template<typename T> inline CGMATH_CONSTEXPR T smoothstep(T a, T b, T x) {
         T t = (x - a) / (b - a);
         if (t < 0) t = 0;
         if (t > 1) t = 1;
@@ -17,6 +17,9 @@
 */
 #pragma once
 
+#include <cgmath/types.h>
+#include <cmath>
+
 namespace cgmath {
 
     /// 2-dimensional vector template (T = int|float|double)
@@ -27,16 +30,16 @@ namespace cgmath {
 
         Vec2() { }
 
-        Vec2( T vx ) 
+        CGMATH_CONSTEXPR Vec2( T vx ) 
             : x(vx), y(vx){ }
 
-        Vec2( T vx, T vy ) 
+        CGMATH_CONSTEXPR Vec2( T vx, T vy ) 
             : x(vx), y(vy){ }
 
-        template <typename U> Vec2( const Vec2<U>& src )
+        template <typename U> CGMATH_CONSTEXPR Vec2( const Vec2<U>& src )
             : x(static_cast<T>(src.x)), y(static_cast<T>(src.y)) { }
 
-        template <typename U> explicit Vec2( const U *src ) 
+        template <typename U> CGMATH_CONSTEXPR explicit Vec2( const U *src ) 
             : x(static_cast<T>(src[0])), y(static_cast<T>(src[1])) { }
 
         T& operator[]( int index ) {
@@ -52,75 +55,75 @@ namespace cgmath {
             dst[1] = static_cast<U>(y);
         }
 
-        bool operator==( const Vec2& v ) const {
+        CGMATH_CONSTEXPR bool operator==( const Vec2& v ) const {
             return (x == v.x) && (y == v.y);
         }
 
-        bool operator!=( const Vec2& v ) const {
+        CGMATH_CONSTEXPR bool operator!=( const Vec2& v ) const {
             return !this->operator==(v);
         }
 
-        const Vec2& operator+=( const Vec2& v ) {
+        CGMATH_CONSTEXPR const Vec2& operator+=( const Vec2& v ) {
             x += v.x; 
             y += v.y; 
             return *this;
         }
 
-        Vec2 operator+( const Vec2& v ) const {
+        CGMATH_CONSTEXPR Vec2 operator+( const Vec2& v ) const {
             return Vec2(x + v.x, y + v.y);
         }
 
-        const Vec2& operator-=( const Vec2& v ) {
+        CGMATH_CONSTEXPR const Vec2& operator-=( const Vec2& v ) {
             x -= v.x; 
             y -= v.y; 
             return *this;
         }
 
-        Vec2 operator-( const Vec2& v ) const {
+        CGMATH_CONSTEXPR Vec2 operator-( const Vec2& v ) const {
             return Vec2(x - v.x, y - v.y);
         }
 
-        Vec2 operator-() const {
+        CGMATH_CONSTEXPR Vec2 operator-() const {
             return Vec2(-x, -y);
         }
 
-        const Vec2& operator*=( T k ) {
+        CGMATH_CONSTEXPR const Vec2& operator*=( T k ) {
             x *= k; 
             y *= k; 
             return *this;
         }
 
-        Vec2<T> operator*( T k ) const {
+        CGMATH_CONSTEXPR Vec2<T> operator*( T k ) const {
             return Vec2<T>( x * k, y * k );
         }
 
-        const Vec2& operator*=( const Vec2& v ) {
+        CGMATH_CONSTEXPR const Vec2& operator*=( const Vec2& v ) {
             x *= v.x; 
             y *= v.y; 
             return *this;
         }
 
-        Vec2 operator*( const Vec2& v ) const {
+        CGMATH_CONSTEXPR Vec2 operator*( const Vec2& v ) const {
             return Vec2( x * v.x, y * v.y );
         }
 
-        const Vec2& operator/=( T k ) {
+        CGMATH_CONSTEXPR const Vec2& operator/=( T k ) {
             x /= k; 
             y /= k; 
             return *this;
         }
 
-        Vec2<T> operator/( T k ) const {
+        CGMATH_CONSTEXPR Vec2<T> operator/( T k ) const {
             return Vec2<T>( x / k, y / k );
         }
 
-        const Vec2& operator/=( const Vec2& v ) {
+        CGMATH_CONSTEXPR const Vec2& operator/=( const Vec2& v ) {
             x /= v.x; 
             y /= v.y; 
             return *this;
         }
 
-        Vec2 operator/( const Vec2& v ) const {
+        CGMATH_CONSTEXPR Vec2 operator/( const Vec2& v ) const {
             return Vec2( x / v.x, y / v.y );
         }
 
@@ -128,11 +131,11 @@ namespace cgmath {
         T y;            
     };
 
-    template <typename T> Vec2<T> operator*(T k, const Vec2<T>& v) {
+    template <typename T> CGMATH_CONSTEXPR Vec2<T> operator*(T k, const Vec2<T>& v) {
         return Vec2<T>(v.x * k, v.y * k);
     }
 
-    template <typename T> T dot(const Vec2<T>& v1, const Vec2<T>& v2) {
+    template <typename T> CGMATH_CONSTEXPR T dot(const Vec2<T>& v1, const Vec2<T>& v2) {
         return v1.x * v2.x + v1.y * v2.y;
     }
 
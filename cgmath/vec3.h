@@ -17,6 +17,9 @@
 */
 #pragma once
 
+#include <cgmath/util.h>
+#include <cmath>
+
 namespace cgmath {
 
     /// 3-dimensional vector template (T = float|double)
@@ -27,16 +30,16 @@ namespace cgmath {
 
         Vec3() { }
 
-        Vec3(T vx) 
+        CGMATH_CONSTEXPR Vec3(T vx) 
             : x(vx), y(vx), z(vx) { }
 
-        Vec3(T vx, T vy, T vz) 
+        CGMATH_CONSTEXPR Vec3(T vx, T vy, T vz) 
             : x(vx), y(vy), z(vz) { }
 
-        template <typename U> Vec3(const Vec3<U>& src)
+        template <typename U> CGMATH_CONSTEXPR Vec3(const Vec3<U>& src)
             : x(static_cast<T>(src.x)), y(static_cast<T>(src.y)), z(static_cast<T>(src.z)) { }
 
-        template <typename U> explicit Vec3(const U *src) 
+        template <typename U> CGMATH_CONSTEXPR explicit Vec3(const U *src) 
             : x(static_cast<T>(src[0])), y(static_cast<T>(src[1])), z(static_cast<T>(src[2])) { }
 
         T& operator[](int index) {
@@ -53,59 +56,59 @@ namespace cgmath {
             dst[2] = static_cast<U>(z);
         }
 
-        bool operator==(const Vec3& v) const {
+        CGMATH_CONSTEXPR bool operator==(const Vec3& v) const {
             return (x == v.x) && (y == v.y) && (z == v.z);
         }
 
-        bool operator!=(const Vec3& v) const {
+        CGMATH_CONSTEXPR bool operator!=(const Vec3& v) const {
             return !this->operator==(v);
         }
 
-        const Vec3& operator+=(const Vec3& v) {
+        CGMATH_CONSTEXPR const Vec3& operator+=(const Vec3& v) {
             x += v.x; 
             y += v.y; 
             z += v.z;
             return *this;
         }
 
-        Vec3 operator+(const Vec3& v) const {
+        CGMATH_CONSTEXPR Vec3 operator+(const Vec3& v) const {
             return Vec3(x + v.x, y + v.y, z + v.z);
         }
 
-        const Vec3& operator-=(const Vec3& v) {
+        CGMATH_CONSTEXPR const Vec3& operator-=(const Vec3& v) {
             x -= v.x; 
             y -= v.y; 
             z -= v.z;
             return *this;
         }
 
-        Vec3 operator-(const Vec3& v) const {
+        CGMATH_CONSTEXPR Vec3 operator-(const Vec3& v) const {
             return Vec3(x - v.x, y - v.y, z - v.z);
         }
 
-        Vec3 operator-() const {
+        CGMATH_CONSTEXPR Vec3 operator-() const {
             return Vec3(-x, -y, -z);
         }
 
-        const Vec3 operator*=(T k) {
+        CGMATH_CONSTEXPR const Vec3 operator*=(T k) {
             x *= k; 
             y *= k; 
             z *= k;
             return *this;
         }
 
-        const Vec3& operator*=(const Vec3& v) {
+        CGMATH_CONSTEXPR const Vec3& operator*=(const Vec3& v) {
             x *= v.x; 
             y *= v.y; 
             z *= v.z; 
             return *this;
         }
 
-        const Vec3 operator/=(T d) {
+        CGMATH_CONSTEXPR const Vec3 operator/=(T d) {
             return this->operator*=(1 / d);
         }
 
-        Vec3 operator/(T d) const {
+        CGMATH_CONSTEXPR Vec3 operator/(T d) const {
             return operator*(*this, 1 / d);
         }
 
@@ -114,15 +117,15 @@ namespace cgmath {
         T z;
     };
 
-    template <typename T> Vec3<T> operator*(const Vec3<T> v, T k) {
+    template <typename T> CGMATH_CONSTEXPR Vec3<T> operator*(const Vec3<T> v, T k) {
         return Vec3<T>(v.x * k, v.y * k, v.z * k);
     }
 
-    template <typename T> Vec3<T> operator*(T k, const Vec3<T>& v) {
+    template <typename T> CGMATH_CONSTEXPR Vec3<T> operator*(T k, const Vec3<T>& v) {
         return Vec3<T>(v.x * k, v.y * k, v.z * k);
     }
 
-    template <typename T> T dot(const Vec3<T>& v1, const Vec3<T>& v2) {
+    template <typename T> CGMATH_CONSTEXPR T dot(const Vec3<T>& v1, const Vec3<T>& v2) {
         return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
     }
 
@@ -138,7 +141,7 @@ namespace cgmath {
         return v / length(v);
     }
 
-    template <typename T> Vec3<T> cross(const Vec3<T>& v1, const Vec3<T>& v2) {
+    template <typename T> CGMATH_CONSTEXPR Vec3<T> cross(const Vec3<T>& v1, const Vec3<T>& v2) {
         return Vec3<T>( 
             v1.y * v2.z - v1.z * v2.y, 
             v1.z * v2.x - v1.x * v2.z,
@@ -146,7 +149,7 @@ namespace cgmath {
         );
     }
 
-    template <typename T> Vec3<T> clamp(const Vec3<T>& v, T a, T b) {
+    template <typename T> CGMATH_CONSTEXPR Vec3<T> clamp(const Vec3<T>& v, T a, T b) {
         return Vec3<T>( clamp(v.x, a, b), clamp(v.y, a, b), clamp(v.z, a, b) );
     }
 
@@ -17,27 +17,31 @@
 */
 #pragma once
 
+#include <cgmath/types.h>
+#include <cmath>
+
 namespace cgmath {
 
-    /// 4-dimensional vector template (T = float|double)
-    template <typename T> class Vec4 {
+    /// 4-dimensional vector template (T = float|double). Vec4<float> is
+    /// 16 byte aligned and its arithmetic runs on SSE if CGMATH_SSE is set.
+    template <typename T> class alignas(SimdAlignment<T>::value) Vec4 {
     public:
         enum { dim = 4 };
         typedef T value_type;
 
         Vec4() { }
 
-        Vec4(T vx) 
+        CGMATH_CONSTEXPR Vec4(T vx) 
             : x(vx), y(vx), z(vx), w(vx) { }
 
-        Vec4(T vx, T vy, T vz, T vw) 
+        CGMATH_CONSTEXPR Vec4(T vx, T vy, T vz, T vw) 
             : x(vx), y(vy), z(vz), w(vw) { }
 
-        template <typename U> Vec4(const Vec4<U>& src)
+        template <typename U> CGMATH_CONSTEXPR Vec4(const Vec4<U>& src)
             : x(static_cast<T>(src.x)), y(static_cast<T>(src.y)), 
               z(static_cast<T>(src.z)), w(static_cast<T>(src.w)) { }
 
-        template <typename U> explicit Vec4(const U *src) 
+        template <typename U> CGMATH_CONSTEXPR explicit Vec4(const U *src) 
             : x(static_cast<T>(src[0])), y(static_cast<T>(src[1])), 
               z(static_cast<T>(src[2])), w(static_cast<T>(src[3])) { }
 
@@ -56,15 +60,15 @@ namespace cgmath {
             dst[3] = static_cast<U>(w);
         }
 
-        bool operator==(const Vec4& v) const {
+        CGMATH_CONSTEXPR bool operator==(const Vec4& v) const {
             return (x == v.x) && (y == v.y) && (z == v.z) && (w == v.w);
         }
 
-        bool operator!=(const Vec4& v) const {
+        CGMATH_CONSTEXPR bool operator!=(const Vec4& v) const {
             return !this->operator==(v);
         }
 
-        const Vec4& operator+=(const Vec4& v) {
+        CGMATH_CONSTEXPR const Vec4& operator+=(const Vec4& v) {
             x += v.x; 
             y += v.y; 
             z += v.z;
@@ -72,11 +76,11 @@ namespace cgmath {
             return *this;
         }
 
-        Vec4 operator+(const Vec4& v) const {
+        CGMATH_CONSTEXPR Vec4 operator+(const Vec4& v) const {
             return Vec4(x + v.x, y + v.y, z + v.z, w + v.w);
         }
 
-        const Vec4& operator-=(const Vec4& v) {
+        CGMATH_CONSTEXPR const Vec4& operator-=(const Vec4& v) {
             x -= v.x; 
             y -= v.y; 
             z -= v.z;
@@ -84,15 +88,15 @@ namespace cgmath {
             return *this;
         }
 
-        Vec4 operator-(const Vec4& v) const {
+        CGMATH_CONSTEXPR Vec4 operator-(const Vec4& v) const {
             return Vec4(x - v.x, y - v.y, z - v.z, w - v.w);
         }
 
-        Vec4 operator-() const {
+        CGMATH_CONSTEXPR Vec4 operator-() const {
             return Vec4(-x, -y, -z, -w);
         }
 
-        const Vec4 operator*=(T k) {
+        CGMATH_CONSTEXPR const Vec4 operator*=(T k) {
             x *= k; 
             y *= k; 
             z *= k;
@@ -100,7 +104,7 @@ namespace cgmath {
             return *this;
         }
 
-        const Vec4& operator*=(const Vec4& v) {
+        CGMATH_CONSTEXPR const Vec4& operator*=(const Vec4& v) {
             x *= v.x; 
             y *= v.y; 
             z *= v.z; 
@@ -108,11 +112,11 @@ namespace cgmath {
             return *this;
         }
 
-        const Vec4 operator/=(T d) {
+        CGMATH_CONSTEXPR const Vec4 operator/=(T d) {
             return this->operator*=(1 / d);
         }
 
-        Vec4 operator/(T d) const {
+        CGMATH_CONSTEXPR Vec4 operator/(T d) const {
             return operator*(*this, 1 / d);
         }
 
@@ -123,25 +127,125 @@ namespace cgmath {
     };
 
     /// \related vec4
-    template <typename T> Vec4<T> operator*(const Vec4<T> v, T k) {
+    template <typename T> CGMATH_CONSTEXPR Vec4<T> operator*(const Vec4<T> v, T k) {
         return Vec4<T>(v.x * k, v.y * k, v.z * k, v.w * k);
     }
 
     /// \related vec4
-    template <typename T> Vec4<T> operator*(T k, const Vec4<T>& v) {
+    template <typename T> CGMATH_CONSTEXPR Vec4<T> operator*(T k, const Vec4<T>& v) {
         return Vec4<T>(v.x * k, v.y * k, v.z * k, v.w * k);
     }
 
+    /// \related vec4
+    template <typename T> CGMATH_CONSTEXPR T dot(const Vec4<T>& v1, const Vec4<T>& v2) {
+        return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+    }
+
     /// \related vec4
     template <typename T> T length(const Vec4<T>& v) {
         return sqrt(v.x * v.x + v.y * v.y + v.z * v.z + v.w * v.w);
     }
 
+    /// \related vec4
+    template <typename T> T distance(const Vec4<T>& a, const Vec4<T>& b) {
+        return length(a - b);
+    }
+
     /// \related vec4
     template <typename T> Vec4<T> normalize(const Vec4<T>& v) {
         return v / length(v);
     }
 
+#ifdef CGMATH_SSE
+
+    namespace sse {
+
+        inline __m128 load( const Vec4<float>& v ) {
+            return _mm_load_ps(&v.x);
+        }
+
+        inline Vec4<float> vec4( __m128 a ) {
+            Vec4<float> r;
+            _mm_store_ps(&r.x, a);
+            return r;
+        }
+
+        /// Sum of the lanes, added in order like the scalar code
+        inline float sum( __m128 a ) {
+            __m128 s = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+            s = _mm_add_ss(s, _mm_movehl_ps(a, a));
+            return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(a, a, 3)));
+        }
+
+    }
+
+    template <> inline CGMATH_CONSTEXPR const Vec4<float>& Vec4<float>::operator+=(const Vec4<float>& v) {
+        if (CGMATH_CONSTANT_EVALUATED()) return *this = Vec4(x + v.x, y + v.y, z + v.z, w + v.w);
+        _mm_store_ps(&x, _mm_add_ps(sse::load(*this), sse::load(v)));
+        return *this;
+    }
+
+    template <> inline CGMATH_CONSTEXPR Vec4<float> Vec4<float>::operator+(const Vec4<float>& v) const {
+        if (CGMATH_CONSTANT_EVALUATED()) return Vec4(x + v.x, y + v.y, z + v.z, w + v.w);
+        return sse::vec4(_mm_add_ps(sse::load(*this), sse::load(v)));
+    }
+
+    template <> inline CGMATH_CONSTEXPR const Vec4<float>& Vec4<float>::operator-=(const Vec4<float>& v) {
+        if (CGMATH_CONSTANT_EVALUATED()) return *this = Vec4(x - v.x, y - v.y, z - v.z, w - v.w);
+        _mm_store_ps(&x, _mm_sub_ps(sse::load(*this), sse::load(v)));
+        return *this;
+    }
+
+    template <> inline CGMATH_CONSTEXPR Vec4<float> Vec4<float>::operator-(const Vec4<float>& v) const {
+        if (CGMATH_CONSTANT_EVALUATED()) return Vec4(x - v.x, y - v.y, z - v.z, w - v.w);
+        return sse::vec4(_mm_sub_ps(sse::load(*this), sse::load(v)));
+    }
+
+    template <> inline CGMATH_CONSTEXPR Vec4<float> Vec4<float>::operator-() const {
+        if (CGMATH_CONSTANT_EVALUATED()) return Vec4(-x, -y, -z, -w);
+        return sse::vec4(_mm_xor_ps(sse::load(*this), _mm_set1_ps(-0.0f)));
+    }
+
+    template <> inline CGMATH_CONSTEXPR const Vec4<float> Vec4<float>::operator*=(float k) {
+        if (CGMATH_CONSTANT_EVALUATED()) return *this = Vec4(x * k, y * k, z * k, w * k);
+        _mm_store_ps(&x, _mm_mul_ps(sse::load(*this), _mm_set1_ps(k)));
+        return *this;
+    }
+
+    template <> inline CGMATH_CONSTEXPR const Vec4<float>& Vec4<float>::operator*=(const Vec4<float>& v) {
+        if (CGMATH_CONSTANT_EVALUATED()) return *this = Vec4(x * v.x, y * v.y, z * v.z, w * v.w);
+        _mm_store_ps(&x, _mm_mul_ps(sse::load(*this), sse::load(v)));
+        return *this;
+    }
+
+    template <> inline CGMATH_CONSTEXPR Vec4<float> operator*(const Vec4<float> v, float k) {
+        if (CGMATH_CONSTANT_EVALUATED()) return Vec4<float>(v.x * k, v.y * k, v.z * k, v.w * k);
+        return sse::vec4(_mm_mul_ps(sse::load(v), _mm_set1_ps(k)));
+    }
+
+    template <> inline CGMATH_CONSTEXPR Vec4<float> operator*(float k, const Vec4<float>& v) {
+        if (CGMATH_CONSTANT_EVALUATED()) return Vec4<float>(v.x * k, v.y * k, v.z * k, v.w * k);
+        return sse::vec4(_mm_mul_ps(sse::load(v), _mm_set1_ps(k)));
+    }
+
+    // With FMA the compiler fuses the scalar sum, which the lane sum
+    // would not match
+#ifndef __FMA__
+
+    template <> inline CGMATH_CONSTEXPR float dot(const Vec4<float>& v1, const Vec4<float>& v2) {
+        if (CGMATH_CONSTANT_EVALUATED()) return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+        return sse::sum(_mm_mul_ps(sse::load(v1), sse::load(v2)));
+    }
+
+    // normalize() and distance() go through these as well
+    template <> inline float length(const Vec4<float>& v) {
+        return std::sqrt(dot(v, v));
+    }
+
+#endif
+
+#endif
+
     typedef Vec4<float> Vec4f;
     typedef Vec4<float> Point4f;
     typedef Vec4<double> Vec4d;
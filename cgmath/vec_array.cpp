@@ -0,0 +1,345 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cgmath/vec_array.h>
+#include <cgmath/fast.h>
+#include <cgmath/simd.h>
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+
+using namespace cgmath::simd;
+
+
+namespace {
+
+    const size_t ALIGN_FLOATS = cgmath::VecArray::ALIGNMENT / sizeof(float);
+
+    // Runs f over I input and O output streams of n floats, a register at
+    // a time. The tail is padded with zeros into a full register, so f
+    // never sees a partial one. Outputs may be inputs.
+    template <int I, int O, typename F>
+    void kernel( const float *const *in, float *const *out, size_t n, F f ) {
+        vfloat a[I], r[O];
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            for (int k = 0; k < I; ++k) a[k] = load(in[k] + i);
+            f(a, r);
+            for (int k = 0; k < O; ++k) store(out[k] + i, r[k]);
+        }
+        if (i < n) {
+            size_t m = n - i;
+            float t[width];
+            for (int k = 0; k < I; ++k) {
+                std::fill(t, t + width, 0.0f);
+                std::copy(in[k] + i, in[k] + n, t);
+                a[k] = load(t);
+            }
+            f(a, r);
+            for (int k = 0; k < O; ++k) {
+                store(t, r[k]);
+                std::copy(t, t + m, out[k] + i);
+            }
+        }
+    }
+
+    template <int D> vfloat dot( const vfloat *a, const vfloat *b ) {
+        vfloat s = mul(a[0], b[0]);
+        for (int k = 1; k < D; ++k) s = add(s, mul(a[k], b[k]));
+        return s;
+    }
+
+    template <int D> void dot( const cgmath::VecArray& a, const cgmath::VecArray& b, float *out ) {
+        const float *in[2 * D];
+        for (int k = 0; k < D; ++k) {
+            in[k] = a.stream(k);
+            in[D + k] = b.stream(k);
+        }
+        kernel<2 * D, 1>(in, &out, a.size(), [](const vfloat *v, vfloat *r) {
+            r[0] = dot<D>(v, v + D);
+        });
+    }
+
+    template <int D> void length( const cgmath::VecArray& a, float *out ) {
+        const float *in[D];
+        for (int k = 0; k < D; ++k) in[k] = a.stream(k);
+        kernel<D, 1>(in, &out, a.size(), [](const vfloat *v, vfloat *r) {
+            r[0] = cgmath::simd::sqrt(dot<D>(v, v));
+        });
+    }
+
+    template <int D> void distance( const cgmath::VecArray& a, const cgmath::VecArray& b, float *out ) {
+        const float *in[2 * D];
+        for (int k = 0; k < D; ++k) {
+            in[k] = a.stream(k);
+            in[D + k] = b.stream(k);
+        }
+        kernel<2 * D, 1>(in, &out, a.size(), [](const vfloat *v, vfloat *r) {
+            vfloat d[D];
+            for (int k = 0; k < D; ++k) d[k] = sub(v[k], v[D + k]);
+            r[0] = cgmath::simd::sqrt(dot<D>(d, d));
+        });
+    }
+
+    // Vec3 and Vec4 divide by multiplying with the reciprocal, Vec2 divides
+    template <int D> void normalize( const cgmath::VecArray& a, cgmath::VecArray& out ) {
+        const float *in[D];
+        float *o[D];
+        for (int k = 0; k < D; ++k) {
+            in[k] = a.stream(k);
+            o[k] = out.stream(k);
+        }
+        kernel<D, D>(in, o, a.size(), [](const vfloat *v, vfloat *r) {
+            vfloat l = cgmath::simd::sqrt(dot<D>(v, v));
+            if (D == 2) {
+                for (int k = 0; k < D; ++k) r[k] = div(v[k], l);
+            } else {
+                vfloat s = div(splat(1.0f), l);
+                for (int k = 0; k < D; ++k) r[k] = mul(v[k], s);
+            }
+        });
+    }
+
+    // Same as util.h's clamp for lo <= hi, including NaN and signed zeros
+    template <int D> void clamp( const cgmath::VecArray& a, float lo, float hi, cgmath::VecArray& out ) {
+        const float *in[D];
+        float *o[D];
+        for (int k = 0; k < D; ++k) {
+            in[k] = a.stream(k);
+            o[k] = out.stream(k);
+        }
+        vfloat vlo = splat(lo);
+        vfloat vhi = splat(hi);
+        kernel<D, D>(in, o, a.size(), [vlo, vhi](const vfloat *v, vfloat *r) {
+            for (int k = 0; k < D; ++k) r[k] = min(vhi, max(vlo, v[k]));
+        });
+    }
+
+    // Same as fast::rsqrt and fast::sqrt
+    vfloat fast_rsqrt( vfloat x ) {
+        vfloat y = rsqrt(x);
+        return mul(y, sub(splat(1.5f), mul(mul(mul(splat(0.5f), x), y), y)));
+    }
+
+    vfloat fast_sqrt( vfloat x ) {
+        return mul(x, fast_rsqrt(max(x, splat(FLT_MIN))));
+    }
+
+    template <int D> void fast_length( const cgmath::VecArray& a, float *out ) {
+        const float *in[D];
+        for (int k = 0; k < D; ++k) in[k] = a.stream(k);
+        kernel<D, 1>(in, &out, a.size(), [](const vfloat *v, vfloat *r) {
+            r[0] = fast_sqrt(dot<D>(v, v));
+        });
+    }
+
+    template <int D> void fast_distance( const cgmath::VecArray& a, const cgmath::VecArray& b, float *out ) {
+        const float *in[2 * D];
+        for (int k = 0; k < D; ++k) {
+            in[k] = a.stream(k);
+            in[D + k] = b.stream(k);
+        }
+        kernel<2 * D, 1>(in, &out, a.size(), [](const vfloat *v, vfloat *r) {
+            vfloat d[D];
+            for (int k = 0; k < D; ++k) d[k] = sub(v[k], v[D + k]);
+            r[0] = fast_sqrt(dot<D>(d, d));
+        });
+    }
+
+    template <int D> void fast_normalize( const cgmath::VecArray& a, cgmath::VecArray& out ) {
+        const float *in[D];
+        float *o[D];
+        for (int k = 0; k < D; ++k) {
+            in[k] = a.stream(k);
+            o[k] = out.stream(k);
+        }
+        kernel<D, D>(in, o, a.size(), [](const vfloat *v, vfloat *r) {
+            vfloat s = fast_rsqrt(dot<D>(v, v));
+            for (int k = 0; k < D; ++k) r[k] = mul(v[k], s);
+        });
+    }
+
+    template <int D> void axpy( float k, const cgmath::VecArray& x, cgmath::VecArray& y ) {
+        const float *in[2 * D];
+        float *o[D];
+        for (int j = 0; j < D; ++j) {
+            in[j] = x.stream(j);
+            in[D + j] = y.stream(j);
+            o[j] = y.stream(j);
+        }
+        vfloat vk = splat(k);
+        kernel<2 * D, D>(in, o, x.size(), [vk](const vfloat *v, vfloat *r) {
+            for (int j = 0; j < D; ++j) r[j] = add(v[D + j], mul(v[j], vk));
+        });
+    }
+
+}
+
+
+cgmath::VecArray::VecArray( int dim, size_t n )
+    : m_dim(dim), m_size(0), m_stride(0), m_data(0), m_buffer(0)
+{
+    resize(n);
+}
+
+
+cgmath::VecArray::VecArray( const VecArray& a )
+    : m_dim(a.m_dim), m_size(0), m_stride(0), m_data(0), m_buffer(0)
+{
+    *this = a;
+}
+
+
+cgmath::VecArray& cgmath::VecArray::operator=( const VecArray& a ) {
+    if (this != &a) {
+        m_size = 0;
+        reserve(a.m_size);
+        m_size = a.m_size;
+        for (int k = 0; k < m_dim; ++k) std::copy(a.stream(k), a.stream(k) + m_size, stream(k));
+    }
+    return *this;
+}
+
+
+cgmath::VecArray::~VecArray() {
+    delete[] m_buffer;
+}
+
+
+void cgmath::VecArray::reserve( size_t n ) {
+    if (n <= m_stride) return;
+    size_t stride = (std::max(n, 2 * m_stride) + ALIGN_FLOATS - 1) / ALIGN_FLOATS * ALIGN_FLOATS;
+    float *buffer = new float[m_dim * stride + ALIGN_FLOATS];
+    uintptr_t p = reinterpret_cast<uintptr_t>(buffer);
+    float *data = reinterpret_cast<float*>((p + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+    for (int k = 0; k < m_dim; ++k) std::copy(stream(k), stream(k) + m_size, data + k * stride);
+    delete[] m_buffer;
+    m_buffer = buffer;
+    m_data = data;
+    m_stride = stride;
+}
+
+
+void cgmath::VecArray::resize( size_t n ) {
+    reserve(n);
+    if (n > m_size) {
+        for (int k = 0; k < m_dim; ++k) std::fill(stream(k) + m_size, stream(k) + n, 0.0f);
+    }
+    m_size = n;
+}
+
+
+void cgmath::Vec2Array::assign( const Vec2f *src, size_t n ) {
+    clear();
+    resize(n);
+    float *px = x(), *py = y();
+    for (size_t i = 0; i < n; ++i) {
+        px[i] = src[i].x;
+        py[i] = src[i].y;
+    }
+}
+
+
+void cgmath::Vec2Array::copy_to( Vec2f *dst ) const {
+    const float *px = x(), *py = y();
+    for (size_t i = 0; i < size(); ++i) dst[i] = Vec2f(px[i], py[i]);
+}
+
+
+void cgmath::Vec3Array::assign( const Vec3f *src, size_t n ) {
+    clear();
+    resize(n);
+    float *px = x(), *py = y(), *pz = z();
+    for (size_t i = 0; i < n; ++i) {
+        px[i] = src[i].x;
+        py[i] = src[i].y;
+        pz[i] = src[i].z;
+    }
+}
+
+
+void cgmath::Vec3Array::copy_to( Vec3f *dst ) const {
+    const float *px = x(), *py = y(), *pz = z();
+    for (size_t i = 0; i < size(); ++i) dst[i] = Vec3f(px[i], py[i], pz[i]);
+}
+
+
+void cgmath::Vec4Array::assign( const Vec4f *src, size_t n ) {
+    clear();
+    resize(n);
+    float *px = x(), *py = y(), *pz = z(), *pw = w();
+    for (size_t i = 0; i < n; ++i) {
+        px[i] = src[i].x;
+        py[i] = src[i].y;
+        pz[i] = src[i].z;
+        pw[i] = src[i].w;
+    }
+}
+
+
+void cgmath::Vec4Array::copy_to( Vec4f *dst ) const {
+    const float *px = x(), *py = y(), *pz = z(), *pw = w();
+    for (size_t i = 0; i < size(); ++i) dst[i] = Vec4f(px[i], py[i], pz[i], pw[i]);
+}
+
+
+void cgmath::dot( const Vec2Array& a, const Vec2Array& b, float *out ) { ::dot<2>(a, b, out); }
+void cgmath::length( const Vec2Array& a, float *out ) { ::length<2>(a, out); }
+void cgmath::distance( const Vec2Array& a, const Vec2Array& b, float *out ) { ::distance<2>(a, b, out); }
+void cgmath::normalize( const Vec2Array& a, Vec2Array& out ) { out.resize(a.size()); ::normalize<2>(a, out); }
+void cgmath::clamp( const Vec2Array& a, float lo, float hi, Vec2Array& out ) { out.resize(a.size()); ::clamp<2>(a, lo, hi, out); }
+void cgmath::axpy( float k, const Vec2Array& x, Vec2Array& y ) { ::axpy<2>(k, x, y); }
+
+void cgmath::dot( const Vec3Array& a, const Vec3Array& b, float *out ) { ::dot<3>(a, b, out); }
+void cgmath::length( const Vec3Array& a, float *out ) { ::length<3>(a, out); }
+void cgmath::distance( const Vec3Array& a, const Vec3Array& b, float *out ) { ::distance<3>(a, b, out); }
+void cgmath::normalize( const Vec3Array& a, Vec3Array& out ) { out.resize(a.size()); ::normalize<3>(a, out); }
+void cgmath::clamp( const Vec3Array& a, float lo, float hi, Vec3Array& out ) { out.resize(a.size()); ::clamp<3>(a, lo, hi, out); }
+void cgmath::axpy( float k, const Vec3Array& x, Vec3Array& y ) { ::axpy<3>(k, x, y); }
+
+void cgmath::dot( const Vec4Array& a, const Vec4Array& b, float *out ) { ::dot<4>(a, b, out); }
+void cgmath::length( const Vec4Array& a, float *out ) { ::length<4>(a, out); }
+void cgmath::distance( const Vec4Array& a, const Vec4Array& b, float *out ) { ::distance<4>(a, b, out); }
+void cgmath::normalize( const Vec4Array& a, Vec4Array& out ) { out.resize(a.size()); ::normalize<4>(a, out); }
+void cgmath::clamp( const Vec4Array& a, float lo, float hi, Vec4Array& out ) { out.resize(a.size()); ::clamp<4>(a, lo, hi, out); }
+void cgmath::axpy( float k, const Vec4Array& x, Vec4Array& y ) { ::axpy<4>(k, x, y); }
+
+
+void cgmath::fast::length( const Vec2Array& a, float *out ) { fast_length<2>(a, out); }
+void cgmath::fast::distance( const Vec2Array& a, const Vec2Array& b, float *out ) { fast_distance<2>(a, b, out); }
+void cgmath::fast::normalize( const Vec2Array& a, Vec2Array& out ) { out.resize(a.size()); fast_normalize<2>(a, out); }
+
+void cgmath::fast::length( const Vec3Array& a, float *out ) { fast_length<3>(a, out); }
+void cgmath::fast::distance( const Vec3Array& a, const Vec3Array& b, float *out ) { fast_distance<3>(a, b, out); }
+void cgmath::fast::normalize( const Vec3Array& a, Vec3Array& out ) { out.resize(a.size()); fast_normalize<3>(a, out); }
+
+void cgmath::fast::length( const Vec4Array& a, float *out ) { fast_length<4>(a, out); }
+void cgmath::fast::distance( const Vec4Array& a, const Vec4Array& b, float *out ) { fast_distance<4>(a, b, out); }
+void cgmath::fast::normalize( const Vec4Array& a, Vec4Array& out ) { out.resize(a.size()); fast_normalize<4>(a, out); }
+
+
+void cgmath::cross( const Vec3Array& a, const Vec3Array& b, Vec3Array& out ) {
+    out.resize(a.size());
+    const float *in[6] = { a.x(), a.y(), a.z(), b.x(), b.y(), b.z() };
+    float *o[3] = { out.x(), out.y(), out.z() };
+    kernel<6, 3>(in, o, a.size(), [](const vfloat *v, vfloat *r) {
+        r[0] = sub(mul(v[1], v[5]), mul(v[2], v[4]));
+        r[1] = sub(mul(v[2], v[3]), mul(v[0], v[5]));
+        r[2] = sub(mul(v[0], v[4]), mul(v[1], v[3]));
+    });
+}
@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cgmath/vec2.h>
+#include <cgmath/vec3.h>
+#include <cgmath/vec4.h>
+#include <cstddef>
+
+namespace cgmath {
+
+    /// Structure of arrays storage: one stream of floats per component,
+    /// each aligned to ALIGNMENT bytes. Base class of Vec2Array, Vec3Array
+    /// and Vec4Array; the batched functions below run over the streams a
+    /// full SIMD register at a time.
+    class VecArray {
+    public:
+        enum { ALIGNMENT = 32 };
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        int dim() const { return m_dim; }
+
+        /// New elements are zero
+        void resize( size_t n );
+        void reserve( size_t n );
+        void clear() { m_size = 0; }
+
+        float* stream( int k ) { return m_data + k * m_stride; }
+        const float* stream( int k ) const { return m_data + k * m_stride; }
+
+    protected:
+        VecArray( int dim, size_t n );
+        VecArray( const VecArray& a );
+        VecArray& operator=( const VecArray& a );
+        ~VecArray();
+
+    private:
+        int m_dim;
+        size_t m_size;
+        size_t m_stride;        ///< floats per stream, keeps every stream aligned
+        float *m_data;          ///< aligned start of the first stream
+        float *m_buffer;
+    };
+
+
+    /// 2-dimensional vectors stored as separate x and y streams
+    class Vec2Array : public VecArray {
+    public:
+        explicit Vec2Array( size_t n = 0 ) : VecArray(2, n) {}
+        Vec2Array( const Vec2f *src, size_t n ) : VecArray(2, 0) { assign(src, n); }
+
+        /// Copies from and to arrays of structures
+        void assign( const Vec2f *src, size_t n );
+        void copy_to( Vec2f *dst ) const;
+
+        Vec2f operator[]( size_t i ) const { return Vec2f(x()[i], y()[i]); }
+        void set( size_t i, const Vec2f& v ) { x()[i] = v.x; y()[i] = v.y; }
+
+        float* x() { return stream(0); }
+        float* y() { return stream(1); }
+        const float* x() const { return stream(0); }
+        const float* y() const { return stream(1); }
+    };
+
+
+    /// 3-dimensional vectors stored as separate x, y and z streams
+    class Vec3Array : public VecArray {
+    public:
+        explicit Vec3Array( size_t n = 0 ) : VecArray(3, n) {}
+        Vec3Array( const Vec3f *src, size_t n ) : VecArray(3, 0) { assign(src, n); }
+
+        /// Copies from and to arrays of structures
+        void assign( const Vec3f *src, size_t n );
+        void copy_to( Vec3f *dst ) const;
+
+        Vec3f operator[]( size_t i ) const { return Vec3f(x()[i], y()[i], z()[i]); }
+        void set( size_t i, const Vec3f& v ) { x()[i] = v.x; y()[i] = v.y; z()[i] = v.z; }
+
+        float* x() { return stream(0); }
+        float* y() { return stream(1); }
+        float* z() { return stream(2); }
+        const float* x() const { return stream(0); }
+        const float* y() const { return stream(1); }
+        const float* z() const { return stream(2); }
+    };
+
+
+    /// 4-dimensional vectors stored as separate x, y, z and w streams
+    class Vec4Array : public VecArray {
+    public:
+        explicit Vec4Array( size_t n = 0 ) : VecArray(4, n) {}
+        Vec4Array( const Vec4f *src, size_t n ) : VecArray(4, 0) { assign(src, n); }
+
+        /// Copies from and to arrays of structures
+        void assign( const Vec4f *src, size_t n );
+        void copy_to( Vec4f *dst ) const;
+
+        Vec4f operator[]( size_t i ) const { return Vec4f(x()[i], y()[i], z()[i], w()[i]); }
+        void set( size_t i, const Vec4f& v ) { x()[i] = v.x; y()[i] = v.y; z()[i] = v.z; w()[i] = v.w; }
+
+        float* x() { return stream(0); }
+        float* y() { return stream(1); }
+        float* z() { return stream(2); }
+        float* w() { return stream(3); }
+        const float* x() const { return stream(0); }
+        const float* y() const { return stream(1); }
+        const float* z() const { return stream(2); }
+        const float* w() const { return stream(3); }
+    };
+
+
+    /// Batched versions of the vector functions. They process the
+    /// a.size() elements of a, second operands have to be at least as long
+    /// and scalar results are written to out[0..a.size()-1]. Vector results
+    /// resize out, which may be one of the operands. Every element gives
+    /// the same result as the single vector function.
+    void dot( const Vec2Array& a, const Vec2Array& b, float *out );
+    void length( const Vec2Array& a, float *out );
+    void distance( const Vec2Array& a, const Vec2Array& b, float *out );
+    void normalize( const Vec2Array& a, Vec2Array& out );
+    void clamp( const Vec2Array& a, float lo, float hi, Vec2Array& out );
+
+    /// y[i] += x[i] * k
+    void axpy( float k, const Vec2Array& x, Vec2Array& y );
+
+    void dot( const Vec3Array& a, const Vec3Array& b, float *out );
+    void length( const Vec3Array& a, float *out );
+    void distance( const Vec3Array& a, const Vec3Array& b, float *out );
+    void normalize( const Vec3Array& a, Vec3Array& out );
+    void cross( const Vec3Array& a, const Vec3Array& b, Vec3Array& out );
+    void clamp( const Vec3Array& a, float lo, float hi, Vec3Array& out );
+    void axpy( float k, const Vec3Array& x, Vec3Array& y );
+
+    void dot( const Vec4Array& a, const Vec4Array& b, float *out );
+    void length( const Vec4Array& a, float *out );
+    void distance( const Vec4Array& a, const Vec4Array& b, float *out );
+    void normalize( const Vec4Array& a, Vec4Array& out );
+    void clamp( const Vec4Array& a, float lo, float hi, Vec4Array& out );
+    void axpy( float k, const Vec4Array& x, Vec4Array& y );
+
+}
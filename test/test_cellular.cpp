@@ -0,0 +1,154 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <cgmath/cellular.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace cgmath;
+
+
+static float distance( CellularNoise::Metric m, const float *a, const float *b, int dim ) {
+    float d = 0;
+    for (int i = 0; i < dim; ++i) {
+        float e = std::fabs(a[i] - b[i]);
+        switch (m) {
+            case CellularNoise::EUCLIDEAN: d += e * e; break;
+            case CellularNoise::MANHATTAN: d += e; break;
+            case CellularNoise::CHEBYSHEV: d = std::max(d, e); break;
+        }
+    }
+    return (m == CellularNoise::EUCLIDEAN)? std::sqrt(d) : d;
+}
+
+
+// F1 and F2 over all feature points within r cells
+static void brute_force( const CellularNoise& c, const float *p, int dim, int r, float *f1, float *f2 ) {
+    std::vector<float> d;
+    int c0[3] = { 0, 0, 0 };
+    for (int i = 0; i < dim; ++i) c0[i] = static_cast<int>(std::floor(p[i]));
+    int rz = (dim == 3)? r : 0;
+    for (int k = -rz; k <= rz; ++k) {
+        for (int j = -r; j <= r; ++j) {
+            for (int i = -r; i <= r; ++i) {
+                float q[3];
+                if (dim == 2) {
+                    c.feature_point(c0[0] + i, c0[1] + j, q);
+                } else {
+                    c.feature_point(c0[0] + i, c0[1] + j, c0[2] + k, q);
+                }
+                d.push_back(distance(c.metric, p, q, dim));
+            }
+        }
+    }
+    std::sort(d.begin(), d.end());
+    *f1 = d[0];
+    *f2 = d[1];
+}
+
+
+BOOST_AUTO_TEST_CASE( test_cellular_search ) {
+    const CellularNoise::Metric metrics[3] = { CellularNoise::EUCLIDEAN, CellularNoise::MANHATTAN, CellularNoise::CHEBYSHEV };
+    NoiseContext ctx(3);
+
+    for (int m = 0; m < 3; ++m) {
+        for (int j = 0; j < 3; ++j) {
+            CellularNoise c(CellularNoise::F1, metrics[m], 0.5f * j);
+            c.context = (j == 1)? &ctx : 0;
+            for (int i = 0; i < 500; ++i) {
+                float p[3];
+                for (int k = 0; k < 3; ++k) p[k] = 600.0f * std::rand() / RAND_MAX - 300.0f;
+                if (i == 0) p[0] = p[1] = p[2] = -2;
+
+                // F1 and F2 equal a brute-force search over the 3x3
+                // (3x3x3) neighbourhood of the sample's cell
+                float f1, f2, r1, r2;
+                c.distances(p[0], p[1], &f1, &f2);
+                brute_force(c, p, 2, 1, &r1, &r2);
+                BOOST_CHECK_SMALL( f1 - r1, 1e-4f );
+                BOOST_CHECK_SMALL( f2 - r2, 1e-4f );
+                BOOST_CHECK_EQUAL( c(p[0], p[1]), f1 );
+
+                c.distances(p[0], p[1], p[2], &f1, &f2);
+                brute_force(c, p, 3, 1, &r1, &r2);
+                BOOST_CHECK_SMALL( f1 - r1, 1e-4f );
+                BOOST_CHECK_SMALL( f2 - r2, 1e-4f );
+                BOOST_CHECK_EQUAL( c(p[0], p[1], p[2]), f1 );
+
+                // with half jitter, the nearest point is always a neighbour
+                if ((j < 2) && (m != CellularNoise::MANHATTAN)) {
+                    c.distances(p[0], p[1], &f1, &f2);
+                    brute_force(c, p, 2, 2, &r1, &r2);
+                    BOOST_CHECK_SMALL( f1 - r1, 1e-4f );
+                }
+            }
+        }
+    }
+
+    // regular grid of cell centers
+    CellularNoise c(CellularNoise::F2_MINUS_F1, CellularNoise::EUCLIDEAN, 0);
+    BOOST_CHECK_CLOSE( c(3.5f, -7.5f), 1.0f, 1e-4f );
+    BOOST_CHECK_SMALL( c(3.0f, -7.5f), 1e-6f );
+    c.type = CellularNoise::F1;
+    BOOST_CHECK_CLOSE( c(3.0f, -7.0f), std::sqrt(0.5f), 1e-4f );
+    c.metric = CellularNoise::MANHATTAN;
+    BOOST_CHECK_CLOSE( c(3.0f, -7.0f, 1.0f), 1.5f, 1e-4f );
+    c.metric = CellularNoise::CHEBYSHEV;
+    BOOST_CHECK_CLOSE( c(3.2f, -7.0f, 1.5f), 0.5f, 1e-4f );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_cellular_fill ) {
+    const CellularNoise::Type types[3] = { CellularNoise::F1, CellularNoise::F2, CellularNoise::F2_MINUS_F1 };
+    const int W = 70, H = 20, D = 3;
+
+    for (int t = 0; t < 3; ++t) {
+        CellularNoise c(types[t], CellularNoise::Metric(t));
+        std::vector<float> img(W * H * D);
+        c.fill(&img[0], W, H, -3.0f, 2.0f, 0.1f, 0.15f);
+        for (int j = 0; j < H; ++j) {
+            for (int i = 0; i < W; ++i) {
+                BOOST_REQUIRE_EQUAL( img[j * W + i], c(-3.0f + i * 0.1f, 2.0f + j * 0.15f) );
+            }
+        }
+
+        c.fill(&img[0], W, H, D, 1.0f, 2.0f, -3.0f, 0.1f, 0.15f, 0.2f);
+        for (int k = 0; k < D; ++k) {
+            for (int j = 0; j < H; ++j) {
+                for (int i = 0; i < W; ++i) {
+                    BOOST_REQUIRE_EQUAL( img[(k * H + j) * W + i],
+                                         c(1.0f + i * 0.1f, 2.0f + j * 0.15f, -3.0f + k * 0.2f) );
+                }
+            }
+        }
+
+        std::vector<float> xs(W), ys(W), zs(W), out(W);
+        for (int i = 0; i < W; ++i) {
+            xs[i] = 0.37f * i - 5;
+            ys[i] = 0.11f * i;
+            zs[i] = -0.23f * i;
+        }
+        c.eval_batch(&xs[0], &ys[0], &out[0], W);
+        for (int i = 0; i < W; ++i) BOOST_REQUIRE_EQUAL( out[i], c(xs[i], ys[i]) );
+        c.eval_batch(&xs[0], &ys[0], &zs[0], &out[0], W);
+        for (int i = 0; i < W; ++i) BOOST_REQUIRE_EQUAL( out[i], c(xs[i], ys[i], zs[i]) );
+    }
+}
@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/clipmap.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace cgmath;
+
+
+static void drain( const NoiseClipmap& c ) {
+    while (c.pending() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+
+BOOST_AUTO_TEST_CASE( test_clipmap ) {
+    FractalNoise f(FractalNoise::FBM, 4);
+    ThreadPool pool(2);
+    const int LEVELS = 3, T = 16, R = 1;
+    NoiseClipmap c(f, LEVELS, T, R, 0.25f, 0, pool);
+    c.lookahead = 0;
+
+    c.update(10.3f, -3.7f);
+    drain(c);
+    std::vector<NoiseClipmap::TilePtr> ready;
+    BOOST_CHECK_EQUAL( c.poll(ready), static_cast<size_t>(LEVELS * (2 * R + 1) * (2 * R + 1)) );
+    BOOST_CHECK_EQUAL( c.poll(ready), 0u );
+
+    for (int l = 0; l < LEVELS; ++l) {
+        int ci, cj;
+        c.tile_index(l, 10.3f, -3.7f, &ci, &cj);
+        for (int j = cj - R; j <= cj + R; ++j) {
+            for (int i = ci - R; i <= ci + R; ++i) {
+                NoiseClipmap::TilePtr t = c.tile(l, i, j);
+                BOOST_REQUIRE( t );
+                BOOST_CHECK_EQUAL( t->size, T + 1 );
+                BOOST_CHECK_EQUAL( t->spacing, 0.25f * (1 << l) );
+                BOOST_CHECK_EQUAL( t->x0, i * T * t->spacing );
+                for (int k = 0; k < t->size * t->size; k += 37) {
+                    float x = t->x0 + (k % t->size) * t->spacing;
+                    float y = t->y0 + (k / t->size) * t->spacing;
+                    BOOST_REQUIRE_EQUAL( t->heights[k], f(x, y) );
+                }
+            }
+        }
+        // neighbours share their borders
+        NoiseClipmap::TilePtr a = c.tile(l, ci, cj), b = c.tile(l, ci + 1, cj);
+        for (int k = 0; k <= T; ++k) {
+            BOOST_REQUIRE_EQUAL( a->heights[k * (T + 1) + T], b->heights[k * (T + 1)] );
+        }
+    }
+    BOOST_CHECK( !c.tile(0, 1000, 1000) );
+
+    // tiles outside the requested area are generated on demand
+    NoiseClipmap::TilePtr t = c.wait(1, 1000, 1000);
+    BOOST_REQUIRE( t );
+    BOOST_CHECK_EQUAL( t->heights[0], f(1000 * T * 0.5f, 1000 * T * 0.5f) );
+    BOOST_CHECK( c.tile(1, 1000, 1000) == t );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_clipmap_streaming ) {
+    FractalNoise f(FractalNoise::FBM, 3);
+    ThreadPool pool(2);
+    const int LEVELS = 2, T = 8, R = 1, CAPACITY = 30;
+    NoiseClipmap c(f, LEVELS, T, R, 1, CAPACITY, pool);
+    c.lookahead = 4;
+    c.max_requests = 5;
+
+    // walking along x, the cache stays bounded and the tiles ahead of the
+    // viewer are prefetched
+    float x = 0;
+    for (int frame = 0; frame < 40; ++frame) {
+        c.update(x, 0, 3, 0);
+        BOOST_CHECK( c.pending() <= 5u );
+        drain(c);
+        BOOST_CHECK( c.cached() <= static_cast<size_t>(CAPACITY) );
+        x += 3;
+    }
+    for (int frame = 0; frame < 3; ++frame) {
+        c.update(x, 0, 3, 0);
+        drain(c);
+    }
+    int i, j;
+    c.tile_index(0, x + 12, 0, &i, &j);
+    BOOST_CHECK( c.tile(0, i, j) );
+    BOOST_CHECK( c.tile(0, i + 1, j) );
+    BOOST_CHECK( !c.tile(0, 0, 0) );
+
+    std::vector<NoiseClipmap::TilePtr> ready;
+    BOOST_CHECK( c.poll(ready) <= static_cast<size_t>(CAPACITY) );
+}
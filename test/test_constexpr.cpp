@@ -0,0 +1,90 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/vec2.h>
+#include <cgmath/vec3.h>
+#include <cgmath/vec4.h>
+#include <cgmath/mat22.h>
+#include <cgmath/mat33.h>
+#include <cgmath/mat44.h>
+#include <cgmath/quat.h>
+
+using namespace cgmath;
+
+
+#if (__cplusplus >= 201402L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201402L))
+
+namespace {
+
+    constexpr Vec3f FACES[6] = {
+        Vec3f(1, 0, 0), Vec3f(-1, 0, 0),
+        Vec3f(0, 1, 0), Vec3f(0, -1, 0),
+        Vec3f(0, 0, 1), Vec3f(0, 0, -1)
+    };
+
+    constexpr Mat33f ROT_Z(0, -1, 0,
+                           1,  0, 0,
+                           0,  0, 1);
+    constexpr Mat33f ROT_Z2 = ROT_Z * ROT_Z;
+    constexpr Mat33f ROT_Z4(ROT_Z2, ROT_Z2);
+
+    constexpr Vec2f OFFSETS[3] = { Vec2f(1, 2) * 0.5f, -Vec2f(1, 2), Vec2f(3, 4) / 2.0f };
+
+    constexpr Vec4f V4 = (Vec4f(1, 2, 3, 4) + Vec4f(1)) * 2.0f - Vec4f(0, 0, 0, 10);
+    constexpr Mat44f SHIFT(1, 0, 0, 1,
+                           0, 1, 0, 2,
+                           0, 0, 1, 3,
+                           0, 0, 0, 1);
+    constexpr Mat44f SHIFT2 = SHIFT * SHIFT;
+
+    constexpr Quatf QX(1, 0, 0, 0);
+    constexpr Quatf QXX = QX * QX;
+
+    static_assert(dot(FACES[0], FACES[2]) == 0, "dot");
+    static_assert(cross(FACES[0], FACES[2]) == FACES[4], "cross");
+    static_assert(FACES[0] + FACES[1] == Vec3f(0), "sum");
+    static_assert(ROT_Z.transform(FACES[0]) == FACES[2], "transform");
+    static_assert(ROT_Z4 == Mat33f(1), "product");
+    static_assert(det(ROT_Z) == 1, "det");
+    static_assert(transpose(ROT_Z) * ROT_Z == Mat33f(1), "transpose");
+    static_assert(OFFSETS[2] == Vec2f(1.5f, 2), "division");
+    static_assert(clamp(Vec3f(-2, 0.5f, 3), 0.0f, 1.0f) == Vec3f(0, 0.5f, 1), "clamp");
+    static_assert(QXX == Quatf(0, 0, 0, -1), "quaternion product");
+    static_assert(QX.matrix() == Mat33f(1, 0, 0, 0, -1, 0, 0, 0, -1), "quaternion matrix");
+    static_assert(V4 == Vec4f(4, 6, 8, 0), "4d arithmetic");
+    static_assert(dot(V4, -Vec4f(1)) == -18, "4d dot");
+    static_assert(SHIFT2[2][3] == 6, "4x4 product");
+    static_assert(det(Mat44f(2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 4, 0, 1, 2, 3, 1)) == 24, "det 4x4");
+    static_assert(det(Mat22f(1, 2, 3, 4) * Mat22f(2)) == -8, "det 2x2");
+    static_assert(radians(180.0) == PI, "radians");
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_constexpr_tables) {
+    BOOST_CHECK( ROT_Z2 == Mat33f(-1, 0, 0, 0, -1, 0, 0, 0, 1) );
+    BOOST_CHECK( ROT_Z2 == ROT_Z * ROT_Z );
+    BOOST_CHECK( OFFSETS[0] == Vec2f(0.5f, 1) );
+    BOOST_CHECK( Vec4f(1, 2, 3, 4) * 2.0f == Vec4f(2, 4, 6, 8) );
+    BOOST_CHECK_EQUAL( det(Mat44f(2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 4, 0, 1, 2, 3, 1)), 24 );
+    Mat44f A(1, 2, 3, 4, 5, 6, 7, 8, 2, 6, 4, 8, 3, 1, 1, 2);
+    BOOST_CHECK_EQUAL( det(A), 72 );
+    BOOST_CHECK_EQUAL( det(transpose(A)), 72 );
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/expr.h>
+#include <cstdlib>
+#include "random.h"
+
+using namespace cgmath;
+
+
+namespace {
+
+    template <typename M> M random_matrix( int n ) {
+        M m;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) m[i][j] = random_float();
+        return m;
+    }
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_expr_vec) {
+    std::srand(3);
+    for (int k = 0; k < 100; ++k) {
+        float s = random_float(), t = random_float();
+        Vec3f a(random_float(), random_float(), random_float());
+        Vec3f b(random_float(), random_float(), random_float());
+        Vec3f c(random_float(), random_float(), random_float());
+
+        Vec3f r = lazy(a) * s + lazy(b) * t - c;
+        BOOST_CHECK( r == a * s + b * t - c );
+        r = s * (lazy(a) - lazy(b)) / t;
+        BOOST_CHECK( r == s * (a - b) / t );
+        r = -lazy(a) + c;
+        BOOST_CHECK( r == -a + c );
+        r = lazy(r) * 2.0f + r;
+        BOOST_CHECK( r == (-a + c) * 2.0f + (-a + c) );
+        BOOST_CHECK_EQUAL( dot(lazy(a) - b, lazy(c)), dot(a - b, c) );
+
+        Vec2f u(a.x, a.y), v(b.x, b.y);
+        Vec2f w = (lazy(u) + v) / s;
+        BOOST_CHECK( w == (u + v) / s );
+
+        Vec4f p(a.x, a.y, a.z, s), q(c.x, c.y, c.z, t);
+        Vec4f x = (lazy(p) - q * t) / s;
+        BOOST_CHECK( x == (p - q * t) / s );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(test_expr_mat) {
+    std::srand(5);
+    for (int k = 0; k < 20; ++k) {
+        float s = random_float();
+        Mat33f A = random_matrix<Mat33f>(3), B = random_matrix<Mat33f>(3), C = random_matrix<Mat33f>(3);
+
+        Mat33f R = lazy(A) * B * C;
+        BOOST_CHECK( R == A * B * C );
+        R = A * (lazy(B) * C);
+        BOOST_CHECK( R == A * (B * C) );
+        R = lazy(A) * s + B - (-lazy(C));
+        BOOST_CHECK( R == A * s + B - (-C) );
+        R = (lazy(A) + B) * (lazy(C) - A);
+        BOOST_CHECK( R == (A + B) * (C - A) );
+
+        Mat33f D = A;
+        D *= B;
+        BOOST_CHECK( D == Mat33f(A, B) );
+        D *= D;
+        BOOST_CHECK( D == Mat33f(A, B) * Mat33f(A, B) );
+
+        Mat44f E = random_matrix<Mat44f>(4), F = random_matrix<Mat44f>(4), G = random_matrix<Mat44f>(4);
+        Mat44f S = lazy(E) * F * G * E;
+        BOOST_CHECK( S == E * F * G * E );
+        S = E * (lazy(F) * G);
+        BOOST_CHECK( S == E * (F * G) );
+        Mat44f H = E;
+        H *= F;
+        BOOST_CHECK( H == E * F );
+    }
+}
@@ -0,0 +1,144 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/fast.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "random.h"
+
+using namespace cgmath;
+
+
+namespace {
+
+    // Distance in ulp between a and the float nearest to x
+    int ulp( float a, double x ) {
+        float b = static_cast<float>(x);
+        int32_t ia, ib;
+        std::memcpy(&ia, &a, sizeof(ia));
+        std::memcpy(&ib, &b, sizeof(ib));
+        return std::abs(ia - ib);
+    }
+
+    double relative( double a, double x ) {
+        return std::fabs(a - x) / std::fabs(x);
+    }
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_fast_rsqrt) {
+    // every float in [1,4) covers every mantissa at both exponent parities
+    int max_ulp = 0;
+    for (float x = 1; x < 4; x = std::nextafter(x, 4.0f)) {
+        max_ulp = std::max(max_ulp, ulp(fast::rsqrt(x), 1 / std::sqrt(static_cast<double>(x))));
+    }
+    BOOST_CHECK_LE( max_ulp, 4 );
+
+    for (int e = -120; e <= 120; e += 7) {
+        float x = std::ldexp(1.37f, e);
+        BOOST_CHECK_LE( ulp(fast::rsqrt(x), 1 / std::sqrt(static_cast<double>(x))), 4 );
+        BOOST_CHECK_LE( relative(fast::sqrt(x), std::sqrt(static_cast<double>(x))), 1e-6 );
+    }
+    BOOST_CHECK_EQUAL( fast::sqrt(0), 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE(test_fast_vec) {
+    std::srand(11);
+    for (int i = 0; i < 1000; ++i) {
+        Vec2f a2(random_float(), random_float()), b2(random_float(), random_float());
+        Vec3f a3(random_float(), random_float(), random_float());
+        Vec3f b3(random_float(), random_float(), random_float());
+        Vec4f a4(random_float(), random_float(), random_float(), random_float());
+        Vec4f b4(random_float(), random_float(), random_float(), random_float());
+        Vec2d d2(a2.x, a2.y);
+        Vec3d d3(a3.x, a3.y, a3.z);
+        Vec4d d4(a4.x, a4.y, a4.z, a4.w);
+
+        BOOST_CHECK_LE( relative(fast::length(a2), length(d2)), 1e-6 );
+        BOOST_CHECK_LE( relative(fast::length(a3), length(d3)), 1e-6 );
+        BOOST_CHECK_LE( relative(fast::length(a4), length(d4)), 1e-6 );
+        BOOST_CHECK_LE( relative(fast::distance(a3, b3), distance(a3, b3)), 1e-6 );
+        BOOST_CHECK_LE( relative(fast::distance(a2, b2), distance(a2, b2)), 1e-6 );
+        BOOST_CHECK_LE( relative(fast::distance(a4, b4), distance(a4, b4)), 1e-6 );
+
+        Vec2f n2 = fast::normalize(a2);
+        Vec3f n3 = fast::normalize(a3);
+        Vec4f n4 = fast::normalize(a4);
+        Vec2d e2 = normalize(d2);
+        Vec3d e3 = normalize(d3);
+        Vec4d e4 = normalize(d4);
+        BOOST_CHECK_LE( length(Vec2d(n2.x, n2.y) - e2), 1e-6 );
+        BOOST_CHECK_LE( length(Vec3d(n3.x, n3.y, n3.z) - e3), 1e-6 );
+        BOOST_CHECK_LE( length(Vec4d(n4.x, n4.y, n4.z, n4.w) - e4), 1e-6 );
+    }
+
+    BOOST_CHECK_EQUAL( fast::length(Vec3f(0, 0, 0)), 0 );
+    BOOST_CHECK_EQUAL( fast::distance(Vec2f(1, 2), Vec2f(1, 2)), 0 );
+    BOOST_CHECK_LE( relative(fast::length(Vec4f(0, 0, 0, 3)), 3), 1e-6 );
+}
+
+
+BOOST_AUTO_TEST_CASE(test_fast_vec_array) {
+    std::srand(13);
+    const size_t sizes[] = { 0, 1, 5, 16, 1001 };
+    for (int s = 0; s < 5; ++s) {
+        size_t n = sizes[s];
+        std::vector<Vec2f> a2(n), b2(n);
+        std::vector<Vec3f> a3(n), b3(n);
+        std::vector<Vec4f> a4(n), b4(n);
+        for (size_t i = 0; i < n; ++i) {
+            a2[i] = Vec2f(random_float(), random_float());
+            b2[i] = Vec2f(random_float(), random_float());
+            a3[i] = Vec3f(random_float(), random_float(), random_float());
+            b3[i] = Vec3f(random_float(), random_float(), random_float());
+            a4[i] = Vec4f(random_float(), random_float(), random_float(), random_float());
+            b4[i] = Vec4f(random_float(), random_float(), random_float(), random_float());
+        }
+        if (n > 0) a3[0] = Vec3f(0, 0, 0);
+        Vec2Array sa2(a2.data(), n), sb2(b2.data(), n), r2;
+        Vec3Array sa3(a3.data(), n), sb3(b3.data(), n), r3;
+        Vec4Array sa4(a4.data(), n), sb4(b4.data(), n), r4;
+        std::vector<float> out(n + 1);
+
+        fast::length(sa2, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], fast::length(a2[i]) );
+        fast::distance(sa2, sb2, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], fast::distance(a2[i], b2[i]) );
+        fast::normalize(sa2, r2);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r2[i] == fast::normalize(a2[i]) );
+
+        fast::length(sa3, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], fast::length(a3[i]) );
+        fast::distance(sa3, sb3, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], fast::distance(a3[i], b3[i]) );
+        fast::normalize(sb3, r3);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r3[i] == fast::normalize(b3[i]) );
+
+        fast::length(sa4, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], fast::length(a4[i]) );
+        fast::distance(sa4, sb4, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], fast::distance(a4[i], b4[i]) );
+        fast::normalize(sa4, sa4);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( sa4[i] == fast::normalize(a4[i]) );
+    }
+}
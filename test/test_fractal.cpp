@@ -0,0 +1,135 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <cgmath/fractal.h>
+#include <cgmath/parallel.h>
+#include <atomic>
+#include <vector>
+
+using namespace cgmath;
+
+
+BOOST_AUTO_TEST_CASE( test_parallel_for ) {
+    const int N = 1000;
+    std::vector< std::atomic<int> > hits(N);
+    for (int i = 0; i < N; ++i) hits[i] = 0;
+
+    ThreadPool pool(3);
+    parallel_for(N, [&]( int i ) { 
+        ++hits[i]; 
+        // nested calls must not dead-lock the pool
+        if (i % 100 == 0) parallel_for(10, [&]( int ) { }, pool);
+    }, pool);
+
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( hits[i], 1 );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_fractal_fill ) {
+    const FractalNoise::Type types[3] = { FractalNoise::FBM, FractalNoise::TURBULENCE, FractalNoise::RIDGED };
+    const int W = 100, H = 70, D = 3;
+
+    for (int t = 0; t < 3; ++t) {
+        FractalNoise f(types[t], 5);
+        std::vector<float> img(W * H);
+        f.fill(&img[0], W, H, -3.0f, 2.0f, 0.1f, 0.15f);
+        for (int j = 0; j < H; ++j) {
+            for (int i = 0; i < W; ++i) {
+                BOOST_REQUIRE_EQUAL( img[j * W + i], f(-3.0f + i * 0.1f, 2.0f + j * 0.15f) );
+            }
+        }
+
+        std::vector<float> vol(W * H * D);
+        f.fill(&vol[0], W, H, D, 1.0f, 2.0f, -3.0f, 0.1f, 0.15f, 0.2f);
+        for (int k = 0; k < D; ++k) {
+            for (int j = 0; j < H; ++j) {
+                for (int i = 0; i < W; ++i) {
+                    BOOST_REQUIRE_EQUAL( vol[(k * H + j) * W + i], 
+                                         f(1.0f + i * 0.1f, 2.0f + j * 0.15f, -3.0f + k * 0.2f) );
+                }
+            }
+        }
+
+        std::vector<uint8_t> img8(W * H), ref8(W * H);
+        f.fill(&img8[0], W, H, -3.0f, 2.0f, 0.1f, 0.15f);
+        to_unorm(&img[0], &ref8[0], W * H);
+        BOOST_REQUIRE( img8 == ref8 );
+
+        std::vector<uint16_t> vol16(W * H * D), ref16(W * H * D);
+        f.fill(&vol16[0], W, H, D, 1.0f, 2.0f, -3.0f, 0.1f, 0.15f, 0.2f);
+        to_unorm(&vol[0], &ref16[0], W * H * D);
+        BOOST_REQUIRE( vol16 == ref16 );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_fractal_periodic ) {
+    FractalNoise f(FractalNoise::FBM, 4);
+    f.px = 4;
+    f.py = 8;
+    for (int i = 0; i < 100; ++i) {
+        float x = 0.37f * i;
+        float y = 0.11f * i;
+        BOOST_CHECK_SMALL( f(x, y) - f(x + 4, y + 8), 1e-4f );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_fractal_filtered ) {
+    const FractalNoise::Type types[3] = { FractalNoise::FBM, FractalNoise::TURBULENCE, FractalNoise::RIDGED };
+    const int N = 20, S = 8;
+    const float W = 0.2f;
+
+    for (int t = 0; t < 3; ++t) {
+        FractalNoise f(types[t], 8);
+        std::vector<float> xs(N * N), ys(N * N), zs(N * N), ws(N * N, W), out(N * N);
+        float err_filtered = 0, err_point = 0;
+        for (int i = 0; i < N * N; ++i) {
+            xs[i] = (i % N) * W + 0.37f;
+            ys[i] = (i / N) * W - 5.1f;
+            zs[i] = 1.3f;
+            BOOST_REQUIRE_EQUAL( f.filtered(xs[i], ys[i], 0), f(xs[i], ys[i]) );
+            BOOST_REQUIRE_EQUAL( f.filtered(xs[i], ys[i], zs[i], 0), f(xs[i], ys[i], zs[i]) );
+
+            // box filtered reference
+            float ref = 0;
+            for (int b = 0; b < S; ++b) {
+                for (int a = 0; a < S; ++a) {
+                    ref += f(xs[i] + ((a + 0.5f) / S - 0.5f) * W, ys[i] + ((b + 0.5f) / S - 0.5f) * W);
+                }
+            }
+            ref /= S * S;
+            float e = f.filtered(xs[i], ys[i], W) - ref;
+            err_filtered += e * e;
+            e = f(xs[i], ys[i]) - ref;
+            err_point += e * e;
+        }
+        // one filtered sample is much closer to the supersampled pixel
+        BOOST_CHECK( err_filtered < 0.5f * err_point );
+
+        f.filtered_batch(&xs[0], &ys[0], &ws[0], &out[0], N * N);
+        for (int i = 0; i < N * N; ++i) BOOST_REQUIRE_EQUAL( out[i], f.filtered(xs[i], ys[i], W) );
+        f.filtered_batch(&xs[0], &ys[0], &zs[0], &ws[0], &out[0], N * N);
+        for (int i = 0; i < N * N; ++i) BOOST_REQUIRE_EQUAL( out[i], f.filtered(xs[i], ys[i], zs[i], W) );
+    }
+
+    // beyond the first octave, fBm fades to its mean
+    FractalNoise f(FractalNoise::FBM, 4);
+    BOOST_CHECK_EQUAL( f.filtered(0.3f, 0.7f, 10), 0.0f );
+}
@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/half.h>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+using namespace cgmath;
+
+
+BOOST_AUTO_TEST_CASE(test_half_scalar) {
+    BOOST_CHECK_EQUAL( float_to_half(1.0f), 0x3c00 );
+    BOOST_CHECK_EQUAL( float_to_half(-2.0f), 0xc000 );
+    BOOST_CHECK_EQUAL( float_to_half(-0.0f), 0x8000 );
+    BOOST_CHECK_EQUAL( float_to_half(65504.0f), 0x7bff );
+    BOOST_CHECK_EQUAL( float_to_half(65519.0f), 0x7bff );
+    BOOST_CHECK_EQUAL( float_to_half(65520.0f), 0x7c00 );
+    BOOST_CHECK_EQUAL( float_to_half(1e10f), 0x7c00 );
+    BOOST_CHECK_EQUAL( float_to_half(-std::numeric_limits<float>::infinity()), 0xfc00 );
+    BOOST_CHECK_EQUAL( float_to_half(std::ldexp(1.0f, -14)), 0x0400 );
+    BOOST_CHECK_EQUAL( float_to_half(std::ldexp(1.0f, -24)), 0x0001 );
+    BOOST_CHECK_EQUAL( float_to_half(std::ldexp(1.0f, -25)), 0x0000 );        // ties to even
+    BOOST_CHECK_EQUAL( float_to_half(std::ldexp(3.0f, -25)), 0x0002 );
+    BOOST_CHECK_EQUAL( float_to_half(1.0f + std::ldexp(1.0f, -11)), 0x3c00 );
+    BOOST_CHECK_EQUAL( float_to_half(1.0f + std::ldexp(3.0f, -11)), 0x3c02 );
+    BOOST_CHECK( std::isnan(half_to_float(float_to_half(std::numeric_limits<float>::quiet_NaN()))) );
+    BOOST_CHECK_EQUAL( half_to_float(0x0001), std::ldexp(1.0f, -24) );
+    BOOST_CHECK_EQUAL( half_to_float(0xfbff), -65504.0f );
+
+    // every half survives the round trip through float
+    for (int h = 0; h < 65536; ++h) {
+        uint16_t b = static_cast<uint16_t>(h);
+        if (std::isnan(half_to_float(b))) continue;
+        BOOST_CHECK_EQUAL( float_to_half(half_to_float(b)), b );
+    }
+
+    // rounding error at most half an ulp in the normal range
+    for (float f = 1e-4f; f < 6e4f; f *= 1.0001f) {
+        float g = half_to_float(float_to_half(f));
+        BOOST_CHECK_LE( std::fabs(f - g), std::ldexp(std::fabs(g), -11) );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(test_half_vec) {
+    BOOST_CHECK_EQUAL( sizeof(Vec3h), 6u );
+    Vec3h h(Vec3f(1.5f, -0.25f, 1000.0f));
+    BOOST_CHECK_EQUAL( h.y.bits(), float_to_half(-0.25f) );
+    Vec3f f(h);
+    BOOST_CHECK( f == Vec3f(1.5f, -0.25f, 1000.0f) );
+    BOOST_CHECK_EQUAL( Vec4f(Vec4h(Vec4f(0.1f))).w, half_to_float(float_to_half(0.1f)) );
+
+    std::srand(17);
+    const size_t sizes[] = { 0, 1, 7, 8, 9, 100 };
+    for (int s = 0; s < 6; ++s) {
+        size_t n = sizes[s];
+        std::vector<Vec3f> a(n), b(n);
+        std::vector<Vec4f> a4(n), b4(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = Vec3f(std::rand() / 1000.0f - 1e6f, std::rand() * 1e-9f, static_cast<float>(i));
+            a4[i] = Vec4f(a[i].x, a[i].y, a[i].z, -a[i].x);
+        }
+        std::vector<Vec3h> h3(n);
+        std::vector<Vec4h> h4(n);
+        convert(a.data(), h3.data(), n);
+        convert(h3.data(), b.data(), n);
+        convert(a4.data(), h4.data(), n);
+        convert(h4.data(), b4.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                BOOST_CHECK_EQUAL( h3[i][k].bits(), float_to_half(a[i][k]) );
+                BOOST_CHECK_EQUAL( b[i][k], half_to_float(float_to_half(a[i][k])) );
+            }
+            BOOST_CHECK_EQUAL( h4[i].w.bits(), float_to_half(a4[i].w) );
+            BOOST_CHECK_EQUAL( b4[i].w, half_to_float(h4[i].w.bits()) );
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/mat44.h>
+#include <cstdint>
+#include <cstdlib>
+#include "random.h"
+
+using namespace cgmath;
+
+
+namespace {
+
+    Mat44f random_mat44() {
+        float a[16];
+        for (int i = 0; i < 16; ++i) a[i] = random_float();
+        return Mat44f(a);
+    }
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_mat44_product) {
+    std::srand(5);
+    Mat44f M[2];
+    BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>(&M[1]) % 16, 0u );
+    BOOST_CHECK_EQUAL( sizeof(Mat44f), 16 * sizeof(float) );
+
+    for (int n = 0; n < 100; ++n) {
+        Mat44f A = random_mat44();
+        Mat44f B = random_mat44();
+        Mat44f C = A * B;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                double c = 0;
+                for (int k = 0; k < 4; ++k) c += static_cast<double>(A[i][k]) * B[k][j];
+                BOOST_CHECK_SMALL( C[i][j] - c, 1e-3 );
+            #ifndef __FMA__
+                // without FMA the SSE product sums like the scalar code
+                BOOST_CHECK_EQUAL( C[i][j], A[i][0] * B[0][j] + A[i][1] * B[1][j] + A[i][2] * B[2][j] + A[i][3] * B[3][j] );
+            #endif
+            }
+        }
+
+        Mat44f D = A;
+        D *= B;
+        BOOST_CHECK( D == C );
+        D = A;
+        D *= D;
+        BOOST_CHECK( D == A * A );
+    }
+}
@@ -0,0 +1,446 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <cgmath/noise.h>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+using namespace cgmath;
+
+
+static std::vector<float> random_coords( int n, float scale ) {
+    std::vector<float> v(n);
+    for (int i = 0; i < n; ++i) {
+        v[i] = scale * (2.0f * std::rand() / RAND_MAX - 1.0f);
+    }
+    // include lattice points and zero, where FASTFLOOR is most delicate
+    v[0] = 0;
+    v[1] = -1;
+    v[2] = 3;
+    return v;
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_batch ) {
+    const int N = 1027;
+    std::vector<float> x = random_coords(N, 300);
+    std::vector<float> y = random_coords(N, 300);
+    std::vector<float> z = random_coords(N, 300);
+    std::vector<float> w = random_coords(N, 300);
+    std::vector<float> out(N);
+
+    noise_batch(&x[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], noise(x[i]) );
+
+    noise_batch(&x[0], &y[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], noise(x[i], y[i]) );
+
+    noise_batch(&x[0], &y[0], &z[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], noise(x[i], y[i], z[i]) );
+
+    noise_batch(&x[0], &y[0], &z[0], &w[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], noise(x[i], y[i], z[i], w[i]) );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_pnoise_batch ) {
+    const int N = 1027;
+    std::vector<float> x = random_coords(N, 20);
+    std::vector<float> y = random_coords(N, 20);
+    std::vector<float> z = random_coords(N, 20);
+    std::vector<float> w = random_coords(N, 20);
+    std::vector<float> out(N);
+
+    pnoise_batch(&x[0], 5, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], pnoise(x[i], 5) );
+
+    pnoise_batch(&x[0], &y[0], 5, 7, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], pnoise(x[i], y[i], 5, 7) );
+
+    pnoise_batch(&x[0], &y[0], &z[0], 5, 7, 300, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], pnoise(x[i], y[i], z[i], 5, 7, 300) );
+
+    pnoise_batch(&x[0], &y[0], &z[0], &w[0], 5, 7, 3, 16, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], pnoise(x[i], y[i], z[i], w[i], 5, 7, 3, 16) );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_context ) {
+    const NoiseContext& def = default_noise_context();
+    NoiseContext a(1), b(1), c(2);
+
+    // a seeded context is a permutation of 0..255
+    std::vector<int> count(256);
+    for (int i = 0; i < 256; ++i) ++count[a.perm()[i]];
+    for (int i = 0; i < 256; ++i) BOOST_REQUIRE_EQUAL( count[i], 1 );
+
+    int differ = 0;
+    for (int i = 0; i < 100; ++i) {
+        float x = 0.37f * i - 11;
+        float y = 0.71f * i - 17;
+        float z = 0.13f * i + 5;
+        BOOST_REQUIRE_EQUAL( def.noise(x, y, z), noise(x, y, z) );
+        BOOST_REQUIRE_EQUAL( a.noise(x, y, z), b.noise(x, y, z) );
+        if (a.noise(x, y, z) != c.noise(x, y, z)) ++differ;
+    }
+    BOOST_CHECK( differ > 90 );
+
+    const int N = 103;
+    std::vector<float> x = random_coords(N, 300);
+    std::vector<float> y = random_coords(N, 300);
+    std::vector<float> z = random_coords(N, 300);
+    std::vector<float> w = random_coords(N, 300);
+    std::vector<float> out(N);
+
+    c.noise_batch(&x[0], &y[0], &z[0], &w[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], c.noise(x[i], y[i], z[i], w[i]) );
+
+    c.pnoise_batch(&x[0], &y[0], 6, 9, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], c.pnoise(x[i], y[i], 6, 9) );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_grad ) {
+    const float h = 1e-3f;
+    NoiseContext integer(7, NoiseContext::INTEGER);
+    for (int i = 0; i < 200; ++i) {
+        float x = 0.37f * i - 31;
+        float y = 0.71f * i - 47;
+        float z = 0.13f * i + 5;
+        float w = -0.29f * i + 2;
+        float g[4];
+
+        BOOST_REQUIRE_EQUAL( noise_grad(x, y, g), noise(x, y) );
+        BOOST_CHECK_SMALL( g[0] - (noise(x + h, y) - noise(x - h, y)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[1] - (noise(x, y + h) - noise(x, y - h)) / (2 * h), 2e-2f );
+
+        BOOST_REQUIRE_EQUAL( noise_grad(x, y, z, g), noise(x, y, z) );
+        BOOST_CHECK_SMALL( g[0] - (noise(x + h, y, z) - noise(x - h, y, z)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[1] - (noise(x, y + h, z) - noise(x, y - h, z)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[2] - (noise(x, y, z + h) - noise(x, y, z - h)) / (2 * h), 2e-2f );
+
+        BOOST_REQUIRE_EQUAL( noise_grad(x, y, z, w, g), noise(x, y, z, w) );
+        BOOST_CHECK_SMALL( g[0] - (noise(x + h, y, z, w) - noise(x - h, y, z, w)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[1] - (noise(x, y + h, z, w) - noise(x, y - h, z, w)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[2] - (noise(x, y, z + h, w) - noise(x, y, z - h, w)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[3] - (noise(x, y, z, w + h) - noise(x, y, z, w - h)) / (2 * h), 2e-2f );
+
+        const NoiseContext& c = integer;
+        BOOST_REQUIRE_EQUAL( c.noise_grad(x, y, g), c.noise(x, y) );
+        BOOST_CHECK_SMALL( g[0] - (c.noise(x + h, y) - c.noise(x - h, y)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[1] - (c.noise(x, y + h) - c.noise(x, y - h)) / (2 * h), 2e-2f );
+
+        BOOST_REQUIRE_EQUAL( c.noise_grad(x, y, z, g), c.noise(x, y, z) );
+        BOOST_CHECK_SMALL( g[0] - (c.noise(x + h, y, z) - c.noise(x - h, y, z)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[1] - (c.noise(x, y + h, z) - c.noise(x, y - h, z)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[2] - (c.noise(x, y, z + h) - c.noise(x, y, z - h)) / (2 * h), 2e-2f );
+
+        BOOST_REQUIRE_EQUAL( c.noise_grad(x, y, z, w, g), c.noise(x, y, z, w) );
+        BOOST_CHECK_SMALL( g[0] - (c.noise(x + h, y, z, w) - c.noise(x - h, y, z, w)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[1] - (c.noise(x, y + h, z, w) - c.noise(x, y - h, z, w)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[2] - (c.noise(x, y, z + h, w) - c.noise(x, y, z - h, w)) / (2 * h), 2e-2f );
+        BOOST_CHECK_SMALL( g[3] - (c.noise(x, y, z, w + h) - c.noise(x, y, z, w - h)) / (2 * h), 2e-2f );
+    }
+    float g[2];
+    BOOST_CHECK_EQUAL( integer.noise_grad(1.3f, 2.7f, g), integer.noise(1.3f, 2.7f) );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_snoise ) {
+    const int N = 1027;
+    std::vector<float> x = random_coords(N, 300);
+    std::vector<float> y = random_coords(N, 300);
+    std::vector<float> z = random_coords(N, 300);
+    std::vector<float> w = random_coords(N, 300);
+    std::vector<float> out(N);
+
+    snoise_batch(&x[0], &y[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], snoise(x[i], y[i]) );
+
+    snoise_batch(&x[0], &y[0], &z[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], snoise(x[i], y[i], z[i]) );
+
+    snoise_batch(&x[0], &y[0], &z[0], &w[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], snoise(x[i], y[i], z[i], w[i]) );
+
+    psnoise_batch(&x[0], &y[0], 5, 6, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], psnoise(x[i], y[i], 5, 6) );
+
+    psnoise_batch(&x[0], &y[0], &z[0], 3, 0, 7, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], psnoise(x[i], y[i], z[i], 3, 0, 7) );
+
+    for (int i = 0; i < N; ++i) {
+        BOOST_CHECK( std::fabs(snoise(x[i], y[i])) <= 1 );
+        BOOST_CHECK( std::fabs(snoise(x[i], y[i], z[i])) <= 1 );
+        BOOST_CHECK( std::fabs(snoise(x[i], y[i], z[i], w[i])) <= 1 );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_psnoise ) {
+    for (int i = 0; i < 200; ++i) {
+        float x = 0.37f * i - 31;
+        float y = 0.71f * i - 47;
+        float z = 0.13f * i - 5;
+        BOOST_CHECK_SMALL( psnoise(x, y, 5, 6) - psnoise(x + 5, y, 5, 6), 1e-4f );
+        BOOST_CHECK_SMALL( psnoise(x, y, 5, 6) - psnoise(x, y - 12, 5, 6), 1e-4f );
+        BOOST_CHECK_SMALL( psnoise(x, y, 7, 0) - psnoise(x - 7, y, 7, 0), 1e-4f );
+        BOOST_CHECK_EQUAL( psnoise(x, y, 5, 3), psnoise(x, y, 5, 4) );
+        BOOST_CHECK_SMALL( psnoise(x, y, 5, 3) - psnoise(x, y + 4, 5, 3), 1e-4f );
+        BOOST_CHECK_SMALL( psnoise(x, y, z, 3, 4, 5) - psnoise(x + 3, y, z, 3, 4, 5), 1e-4f );
+        BOOST_CHECK_SMALL( psnoise(x, y, z, 3, 4, 5) - psnoise(x, y - 4, z, 3, 4, 5), 1e-4f );
+        BOOST_CHECK_SMALL( psnoise(x, y, z, 3, 4, 5) - psnoise(x, y, z + 10, 3, 4, 5), 1e-4f );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_span ) {
+    const int N = 1027;
+    std::vector<float> out(N);
+    // dense and sparse sampling, crossing zero and running backwards
+    const float span[4][2] = { { -3.7f, 0.013f }, { -40.1f, 0.37f }, { 5.2f, -0.021f }, { 0.0f, 1.0f } };
+
+    for (int k = 0; k < 4; ++k) {
+        float x = span[k][0], dx = span[k][1];
+        float y = -2.3f + k, z = 7.9f - 3 * k;
+
+        noise_span(x, y, dx, &out[0], N);
+        for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], noise(x + i * dx, y) );
+
+        noise_span(x, y, z, dx, &out[0], N);
+        for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], noise(x + i * dx, y, z) );
+
+        pnoise_span(x, y, dx, 5, 7, &out[0], N);
+        for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], pnoise(x + i * dx, y, 5, 7) );
+
+        pnoise_span(x, y, z, dx, 5, 7, 3, &out[0], N);
+        for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], pnoise(x + i * dx, y, z, 5, 7, 3) );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_unorm ) {
+    const float v[8] = { -1.0f, 1.0f, 0.0f, -7.0f, 3.0f, -0.5f, 0.25f, 0.999f };
+    const int r8[8] = { 0, 255, 128, 0, 255, 64, 159, 255 };
+    const int r16[8] = { 0, 65535, 32768, 0, 65535, 16384, 40959, 65502 };
+    for (int n = 1; n <= 8; ++n) {
+        uint8_t a[8];
+        uint16_t b[8];
+        to_unorm(v, a, n);
+        to_unorm(v, b, n);
+        for (int i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL( a[i], r8[i] );
+            BOOST_CHECK_EQUAL( b[i], r16[i] );
+        }
+    }
+
+    const int W = 37, H = 11, D = 3;
+    std::vector<float> ref(W);
+    std::vector<uint8_t> img8(W * H * D), ref8(W);
+    std::vector<uint16_t> img16(W * H * D), ref16(W);
+    NoiseContext ctx(5, NoiseContext::INTEGER);
+
+    noise_fill(&img8[0], W, H, -1.3f, 2.2f, 0.1f, 0.3f);
+    pnoise_fill(&img16[0], W, H, -1.3f, 2.2f, 0.1f, 0.3f, 4, 3);
+    for (int j = 0; j < H; ++j) {
+        noise_span(-1.3f, 2.2f + j * 0.3f, 0.1f, &ref[0], W);
+        to_unorm(&ref[0], &ref8[0], W);
+        BOOST_REQUIRE( std::equal(ref8.begin(), ref8.end(), img8.begin() + j * W) );
+        pnoise_span(-1.3f, 2.2f + j * 0.3f, 0.1f, 4, 3, &ref[0], W);
+        to_unorm(&ref[0], &ref16[0], W);
+        BOOST_REQUIRE( std::equal(ref16.begin(), ref16.end(), img16.begin() + j * W) );
+    }
+
+    ctx.noise_fill(&img16[0], W, H, D, 0.5f, -2.0f, 1.0f, 0.2f, 0.3f, 0.7f);
+    ctx.pnoise_fill(&img8[0], W, H, D, 0.5f, -2.0f, 1.0f, 0.2f, 0.3f, 0.7f, 3, 0, 2);
+    for (int k = 0; k < D; ++k) {
+        for (int j = 0; j < H; ++j) {
+            size_t row = (k * H + j) * W;
+            ctx.noise_span(0.5f, -2.0f + j * 0.3f, 1.0f + k * 0.7f, 0.2f, &ref[0], W);
+            to_unorm(&ref[0], &ref16[0], W);
+            BOOST_REQUIRE( std::equal(ref16.begin(), ref16.end(), img16.begin() + row) );
+            ctx.pnoise_span(0.5f, -2.0f + j * 0.3f, 1.0f + k * 0.7f, 0.2f, 3, 0, 2, &ref[0], W);
+            to_unorm(&ref[0], &ref8[0], W);
+            BOOST_REQUIRE( std::equal(ref8.begin(), ref8.end(), img8.begin() + row) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_integer_hash ) {
+    const int N = 1027;
+    std::vector<float> x = random_coords(N, 3000);
+    std::vector<float> y = random_coords(N, 3000);
+    std::vector<float> z = random_coords(N, 3000);
+    std::vector<float> w = random_coords(N, 3000);
+    std::vector<float> out(N);
+    NoiseContext ctx(11, NoiseContext::INTEGER);
+    BOOST_CHECK_EQUAL( ctx.hash(), NoiseContext::INTEGER );
+
+    ctx.noise_batch(&x[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i]) );
+    ctx.noise_batch(&x[0], &y[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i], y[i]) );
+    ctx.noise_batch(&x[0], &y[0], &z[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i], y[i], z[i]) );
+    ctx.noise_batch(&x[0], &y[0], &z[0], &w[0], &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i], y[i], z[i], w[i]) );
+
+    ctx.pnoise_batch(&x[0], 700, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], 700) );
+    ctx.pnoise_batch(&x[0], &y[0], 700, 0, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], y[i], 700, 0) );
+    ctx.pnoise_batch(&x[0], &y[0], &z[0], 5, 1000, 300, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], y[i], z[i], 5, 1000, 300) );
+    ctx.pnoise_batch(&x[0], &y[0], &z[0], &w[0], 5, 7, 0, 16, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], y[i], z[i], w[i], 5, 7, 0, 16) );
+
+    ctx.noise_span(-3.7f, 2.1f, 0.013f, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.noise(-3.7f + i * 0.013f, 2.1f) );
+    ctx.pnoise_span(-40.1f, 2.1f, 7.9f, 0.37f, 600, 0, 5, &out[0], N);
+    for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(-40.1f + i * 0.37f, 2.1f, 7.9f, 600, 0, 5) );
+
+    // far from the origin the hashes of the lattice coordinates wrap around
+    for (int r = 0; r < 4; ++r) {
+        ctx.noise_span(1.0e9f, r + 0.5f, 0.25f, &out[0], N);
+        for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.noise(1.0e9f + i * 0.25f, r + 0.5f) );
+        ctx.noise_span(-1.5e9f, 2.0e9f, r - 1.0e9f, 64.0f, &out[0], N);
+        for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL( out[i], ctx.noise(-1.5e9f + i * 64.0f, 2.0e9f, r - 1.0e9f) );
+    }
+
+    // the lattice does not repeat every 256 units, but wraps to any period
+    int repeats = 0;
+    for (int i = 3; i < 100; ++i) {
+        float a = std::fabs(x[i]) / 30, b = std::fabs(y[i]) / 30;
+        if (std::fabs(ctx.noise(a, b) - ctx.noise(a + 256, b)) < 1e-3f) ++repeats;
+        BOOST_CHECK_SMALL( noise(a, b) - noise(a + 256, b), 1e-3f );
+        BOOST_CHECK_SMALL( ctx.pnoise(a, b, 1000, 3000) - ctx.pnoise(a + 1000, b + 3000, 1000, 3000), 1e-2f );
+        BOOST_CHECK( std::fabs(ctx.noise(a, b, x[i])) <= 1.1f );
+    }
+    BOOST_CHECK( repeats < 5 );
+
+    NoiseContext other(12, NoiseContext::INTEGER);
+    BOOST_CHECK( other.noise(0.5f, 0.5f, 0.5f) != ctx.noise(0.5f, 0.5f, 0.5f) );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_periodic_noise ) {
+    const int N = 1027;
+    std::vector<float> x = random_coords(N, 900);
+    std::vector<float> y = random_coords(N, 900);
+    std::vector<float> z = random_coords(N, 900);
+    std::vector<float> w = random_coords(N, 900);
+    for (int i = 0; i < N; ++i) {
+        x[i] = std::fabs(x[i]);
+        y[i] = std::fabs(y[i]);
+        z[i] = std::fabs(z[i]);
+        w[i] = std::fabs(w[i]);
+    }
+    std::vector<float> out(N);
+    NoiseContext integer(11, NoiseContext::INTEGER);
+    const NoiseContext *contexts[2] = { &default_noise_context(), &integer };
+
+    // equal to pnoise() on the non-negative lattice, for power-of-two,
+    // other and large periods, scalar and batch
+    for (int c = 0; c < 2; ++c) {
+        const NoiseContext& ctx = *contexts[c];
+        PeriodicNoise p(5, 16, 300, 7, &ctx);
+        p.eval_batch(&x[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], 5) );
+            BOOST_REQUIRE_EQUAL( p(x[i]), out[i] );
+        }
+        p.eval_batch(&x[0], &y[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], y[i], 5, 16) );
+            BOOST_REQUIRE_EQUAL( p(x[i], y[i]), out[i] );
+        }
+        p.eval_batch(&x[0], &y[0], &z[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], y[i], z[i], 5, 16, 300) );
+            BOOST_REQUIRE_EQUAL( p(x[i], y[i], z[i]), out[i] );
+        }
+        p.eval_batch(&x[0], &y[0], &z[0], &w[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.pnoise(x[i], y[i], z[i], w[i], 5, 16, 300, 7) );
+            BOOST_REQUIRE_EQUAL( p(x[i], y[i], z[i], w[i]), out[i] );
+        }
+    }
+
+    // tiles across negative coordinates, a period of 0 does not wrap
+    PeriodicNoise p(3, 8, 0);
+    BOOST_CHECK_EQUAL( p.period(2), 0 );
+    for (int i = 0; i < 200; ++i) {
+        float a = -20 + i * 0.1875f, b = -9 + i * 0.0625f, c = i * 0.125f;
+        BOOST_REQUIRE_EQUAL( p(a, b, c), p(a + 3, b, c) );
+        BOOST_REQUIRE_EQUAL( p(a, b, c), p(a - 6, b + 16, c) );
+        BOOST_REQUIRE_EQUAL( p(a, b), pnoise(a - 3 * std::floor(a / 3), b - 8 * std::floor(b / 8), 3, 8) );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise64 ) {
+    const int N = 1027;
+    std::vector<float> x = random_coords(N, 300);
+    std::vector<float> y = random_coords(N, 300);
+    std::vector<float> z = random_coords(N, 300);
+    std::vector<float> w = random_coords(N, 300);
+    std::vector<double> dx(x.begin(), x.end()), dy(y.begin(), y.end()), dz(z.begin(), z.end()), dw(w.begin(), w.end());
+    std::vector<float> out(N);
+    NoiseContext integer(11, NoiseContext::INTEGER);
+    const NoiseContext *contexts[2] = { &default_noise_context(), &integer };
+
+    // equal to noise() at float coordinates, scalar and batch
+    for (int c = 0; c < 2; ++c) {
+        const NoiseContext& ctx = *contexts[c];
+        ctx.noise64_batch(&dx[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i]) );
+            BOOST_REQUIRE_EQUAL( ctx.noise64(dx[i]), out[i] );
+        }
+        ctx.noise64_batch(&dx[0], &dy[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i], y[i]) );
+            BOOST_REQUIRE_EQUAL( ctx.noise64(dx[i], dy[i]), out[i] );
+        }
+        ctx.noise64_batch(&dx[0], &dy[0], &dz[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i], y[i], z[i]) );
+            BOOST_REQUIRE_EQUAL( ctx.noise64(dx[i], dy[i], dz[i]), out[i] );
+        }
+        ctx.noise64_batch(&dx[0], &dy[0], &dz[0], &dw[0], &out[0], N);
+        for (int i = 0; i < N; ++i) {
+            BOOST_REQUIRE_EQUAL( out[i], ctx.noise(x[i], y[i], z[i], w[i]) );
+            BOOST_REQUIRE_EQUAL( ctx.noise64(dx[i], dy[i], dz[i], dw[i]), out[i] );
+        }
+    }
+
+    // full detail far from the origin, where the permutation lattice
+    // repeats every 256 units and the INTEGER lattice every 2^32 units
+    const double far = 1e9 * 256;
+    const double wrap = 4294967296.0 * 1000;
+    for (int i = 0; i < 200; ++i) {
+        float a = -3 + i * 0.0390625f, b = 5 - i * 0.015625f;
+        BOOST_REQUIRE_EQUAL( noise64(far + a, b - far), noise(a, b) );
+        BOOST_REQUIRE_EQUAL( noise64(a, far + b, -far), noise(a, b, 0) );
+        BOOST_REQUIRE_EQUAL( integer.noise64(wrap + a, b - wrap), integer.noise(a, b) );
+    }
+}
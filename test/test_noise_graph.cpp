@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/noise_graph.h>
+#include <cgmath/fractal.h>
+#include <vector>
+
+using namespace cgmath;
+
+
+BOOST_AUTO_TEST_CASE( test_noise_graph ) {
+    // q = (noise(x, y), noise(y + 5.2, x + 1.3)), r = noise(x + 4 q.x, y + 4 q.y)
+    NoiseGraph g;
+    NoiseGraph::Node qx = g.noise(g.x(), g.y());
+    NoiseGraph::Node qy = g.noise(g.add(g.y(), g.constant(5.2f)), g.add(g.x(), g.constant(1.3f)));
+    NoiseGraph::Node n = g.noise(g.x(), g.y());
+    NoiseGraph::Node r = g.warp(n, g.add(g.x(), g.remap(qx, 4)), g.add(g.y(), g.remap(qy, 4)));
+    NoiseGraph::Node s = g.add(r, g.mul(qx, g.constant(0.5f)));
+
+    NoiseProgram p(g, s);
+    // qx and n are the same noise, which is computed only once
+    BOOST_CHECK_EQUAL( p.instructions(), 11u );
+    BOOST_CHECK( p.registers() < 6 );
+
+    const int N = 1000;
+    std::vector<float> xs(N), ys(N), out(N);
+    for (int i = 0; i < N; ++i) {
+        xs[i] = -7.3f + 0.031f * i;
+        ys[i] = 3.1f - 0.017f * i;
+    }
+    p.eval_batch(&xs[0], &ys[0], 0, &out[0], N);
+    for (int i = 0; i < N; ++i) {
+        float x = xs[i], y = ys[i];
+        float a = noise(x, y);
+        float b = noise(y + 5.2f, x + 1.3f);
+        float e = noise(x + a * 4, y + b * 4) + a * 0.5f;
+        BOOST_REQUIRE_EQUAL( out[i], e );
+        BOOST_REQUIRE_EQUAL( p(x, y), e );
+    }
+
+    const int W = 37, H = 5;
+    std::vector<float> img(W * H);
+    p.fill(&img[0], W, H, 1.5f, -2.0f, 0.25f, 0.5f);
+    for (int j = 0; j < H; ++j) {
+        for (int i = 0; i < W; ++i) {
+            BOOST_REQUIRE_EQUAL( img[j * W + i], p(1.5f + i * 0.25f, -2.0f + j * 0.5f) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_graph_fbm ) {
+    FractalNoise f(FractalNoise::FBM, 5, 2, 0.5f);
+    NoiseGraph g;
+    NoiseProgram p2(g, g.fbm(g.x(), g.y(), 5));
+    NoiseProgram p3(g, g.fbm(g.x(), g.y(), g.z(), 5));
+    for (int i = 0; i < 200; ++i) {
+        float x = -3.7f + 0.093f * i, y = 1.1f + 0.051f * i, z = 0.3f - 0.027f * i;
+        BOOST_REQUIRE_CLOSE_FRACTION( p2(x, y), f(x, y), 1e-5f );
+        BOOST_REQUIRE_CLOSE_FRACTION( p3(x, y, z), f(x, y, z), 1e-5f );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_graph_trivial ) {
+    NoiseGraph g;
+    NoiseProgram c(g, g.add(g.constant(1), g.mul(g.constant(2), g.constant(3))));
+    BOOST_CHECK_EQUAL( c.instructions(), 1u );
+    BOOST_CHECK_EQUAL( c(4, 5), 7.0f );
+
+    NoiseProgram y(g, g.y());
+    BOOST_CHECK_EQUAL( y.instructions(), 0u );
+    BOOST_CHECK_EQUAL( y(4, 5), 5.0f );
+
+    NoiseProgram w(g, g.warp(g.z(), g.x(), g.y(), g.remap(g.x(), 2, 1)));
+    BOOST_CHECK_EQUAL( w(4, 5, 6), 9.0f );
+}
@@ -0,0 +1,110 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <cgmath/noise_texture.h>
+#include <cgmath/fractal.h>
+#include <cstdio>
+
+using namespace cgmath;
+
+
+BOOST_AUTO_TEST_CASE( test_noise_texture_bake ) {
+    NoiseTextureParams p(32, 16, 8);
+    p.px = 4;
+    p.py = 2;
+    p.pz = 2;
+    p.octaves = 3;
+    p.seed = 7;
+    NoiseTexture tex;
+    tex.bake(p);
+    BOOST_REQUIRE( !tex.empty() );
+
+    NoiseContext context(7);
+    FractalNoise f(FractalNoise::FBM, 3, 2, 0.5f);
+    f.context = &context;
+    f.px = 4;
+    f.py = 2;
+    f.pz = 2;
+    const float *d = tex.data();
+    for (int k = 0; k < 8; k += 3) {
+        for (int j = 0; j < 16; j += 5) {
+            for (int i = 0; i < 32; i += 7) {
+                float x = i * 4.0f / 32, y = j * 2.0f / 16, z = k * 2.0f / 8;
+                BOOST_CHECK_CLOSE( d[(k * 16 + j) * 32 + i], f(x, y, z), 1e-3f );
+                // texel centers are reproduced exactly by both filters
+                BOOST_CHECK_CLOSE( tex.sample(x, y, z), d[(k * 16 + j) * 32 + i], 1e-3f );
+                BOOST_CHECK_CLOSE( tex.sample_cubic(x, y, z), d[(k * 16 + j) * 32 + i], 1e-3f );
+            }
+        }
+    }
+
+    // seamless tiling in every direction
+    for (int i = 0; i < 50; ++i) {
+        float x = 0.37f * i, y = 0.21f * i, z = 0.13f * i;
+        BOOST_CHECK_SMALL( tex.sample(x, y, z) - tex.sample(x + 4, y - 2, z + 2), 1e-4f );
+        BOOST_CHECK_SMALL( tex.sample_cubic(x, y, z) - tex.sample_cubic(x - 4, y + 2, z - 2), 1e-4f );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( test_noise_texture_cache ) {
+    const char *path = "test_noise_texture.cgnt";
+    std::remove(path);
+
+    NoiseTextureParams p(64, 32);
+    p.seed = 3;
+    {
+        NoiseTexture tex;
+        BOOST_CHECK( !tex.load(path) );
+        BOOST_REQUIRE( tex.load_or_bake(path, p) );
+    }
+
+    NoiseTexture baked, loaded;
+    baked.bake(p);
+    BOOST_REQUIRE( loaded.load(path) );
+    BOOST_CHECK( loaded.params() == p );
+    for (int i = 0; i < 64 * 32; ++i) BOOST_REQUIRE_EQUAL( loaded.data()[i], baked.data()[i] );
+    BOOST_CHECK_EQUAL( loaded.sample(1.3f, 2.7f), baked.sample(1.3f, 2.7f) );
+
+    // a parameter mismatch rebakes and rewrites the file
+    p.octaves = 2;
+    NoiseTexture tex;
+    BOOST_REQUIRE( tex.load_or_bake(path, p) );
+    BOOST_CHECK( tex.params() == p );
+    loaded.clear();
+    BOOST_REQUIRE( loaded.load(path) );
+    BOOST_CHECK_EQUAL( loaded.params().octaves, 2 );
+
+    // a file with a bad header is rejected without taking its parameters
+    const char *bad = "test_noise_texture_bad.cgnt";
+    BOOST_REQUIRE( tex.save(bad) );
+    FILE *f = std::fopen(bad, "r+b");
+    BOOST_REQUIRE( f );
+    std::fputc('X', f);
+    std::fclose(f);
+    NoiseTexture rejected;
+    BOOST_CHECK( !rejected.load(bad) );
+    BOOST_CHECK( rejected.empty() );
+    BOOST_CHECK( rejected.params() == NoiseTextureParams() );
+    std::remove(bad);
+
+    loaded.clear();
+    tex.clear();
+    std::remove(path);
+}
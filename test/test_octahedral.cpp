@@ -0,0 +1,112 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/octahedral.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace cgmath;
+
+namespace {
+
+    double angle( const Vec3f& a, const Vec3f& b ) {
+        Vec3d u(a), v(b);
+        return std::atan2(length(cross(u, v)), dot(u, v)) * 180 / PI;
+    }
+
+    std::vector<Vec3f> random_normals( size_t n ) {
+        std::mt19937 rng(5);
+        std::normal_distribution<double> g;
+        std::vector<Vec3f> v(n);
+        for (size_t i = 0; i < n; ++i) v[i] = Vec3f(normalize(Vec3d(g(rng), g(rng), g(rng))));
+        // axes, diagonals and the fold of the octahedron
+        for (int k = 0; k < 27; ++k) {
+            Vec3f d(static_cast<float>(k % 3 - 1), static_cast<float>(k / 3 % 3 - 1), static_cast<float>(k / 9 - 1));
+            if (k != 13) v[k] = normalize(d);
+        }
+        return v;
+    }
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_octahedral_scalar) {
+    const Vec3f axes[6] = { Vec3f(1,0,0), Vec3f(-1,0,0), Vec3f(0,1,0), Vec3f(0,-1,0), Vec3f(0,0,1), Vec3f(0,0,-1) };
+    for (int k = 0; k < 6; ++k) {
+        BOOST_CHECK( oct_decode(oct_encode16(axes[k])) == axes[k] );
+        BOOST_CHECK( oct_decode(oct_encode8(axes[k])) == axes[k] );
+        BOOST_CHECK( oct_decode(oct_encode16_precise(axes[k])) == axes[k] );
+        BOOST_CHECK( oct_decode(oct_encode8_precise(axes[k])) == axes[k] );
+    }
+    BOOST_CHECK( oct_encode16(Vec3f(0,0,1)) == Oct16(0, 0) );
+    BOOST_CHECK( oct_encode16(Vec3f(1,0,0)) == Oct16(32767, 0) );
+    BOOST_CHECK( oct_encode8(Vec3d(0,-2,0)) == Oct8(0, -127) );
+    BOOST_CHECK( oct_encode8(Vec3f(0,0,0)) == Oct8(0, 0) );
+    BOOST_CHECK( oct_decode(Oct8(-128, 0)) == Vec3f(-1, 0, 0) );
+
+    Vec3d d = oct_decode<double>(oct_encode16(Vec3f(0.6f, 0, -0.8f)));
+    BOOST_CHECK_CLOSE( d.x, 0.6, 0.01 );
+    BOOST_CHECK_CLOSE( d.z, -0.8, 0.01 );
+
+    std::vector<Vec3f> v = random_normals(200000);
+    double e16 = 0, e16p = 0, e8 = 0, e8p = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        double a16 = angle(v[i], oct_decode(oct_encode16(v[i])));
+        double a16p = angle(v[i], oct_decode(oct_encode16_precise(v[i])));
+        double a8 = angle(v[i], oct_decode(oct_encode8(v[i])));
+        double a8p = angle(v[i], oct_decode(oct_encode8_precise(v[i])));
+        BOOST_REQUIRE_LE( a16p, a16 + 1e-4 );
+        BOOST_REQUIRE_LE( a8p, a8 + 1e-4 );
+        e16 = std::max(e16, a16);
+        e16p = std::max(e16p, a16p);
+        e8 = std::max(e8, a8);
+        e8p = std::max(e8p, a8p);
+    }
+    BOOST_CHECK_LE( e16, 0.0040 );
+    BOOST_CHECK_LE( e16p, 0.0027 );
+    BOOST_CHECK_LE( e8, 1.0 );
+    BOOST_CHECK_LE( e8p, 0.66 );
+    BOOST_CHECK_LT( e16p, e16 );
+    BOOST_CHECK_LT( e8p, e8 );
+}
+
+
+BOOST_AUTO_TEST_CASE(test_octahedral_batch) {
+    for (size_t n = 0; n < 40; n += 13) {
+        std::vector<Vec3f> v = random_normals(n + 27);
+        v.resize(n);
+        std::vector<Oct16> e16(n), p16(n);
+        std::vector<Oct8> e8(n), p8(n);
+        std::vector<Vec3f> d16(n), d8(n);
+        oct_encode(v.data(), e16.data(), n);
+        oct_encode(v.data(), e8.data(), n);
+        oct_encode_precise(v.data(), p16.data(), n);
+        oct_encode_precise(v.data(), p8.data(), n);
+        oct_decode(p16.data(), d16.data(), n);
+        oct_decode(p8.data(), d8.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK( e16[i] == oct_encode16(v[i]) );
+            BOOST_CHECK( e8[i] == oct_encode8(v[i]) );
+            BOOST_CHECK( p16[i] == oct_encode16_precise(v[i]) );
+            BOOST_CHECK( p8[i] == oct_encode8_precise(v[i]) );
+            BOOST_CHECK( d16[i] == oct_decode(p16[i]) );
+            BOOST_CHECK( d8[i] == oct_decode(p8[i]) );
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/packet.h>
+#include <cstdlib>
+#include <vector>
+#include "random.h"
+
+using namespace cgmath;
+
+
+namespace {
+
+    // Reflection of a direction at a surface, facing the normal towards it.
+    // Written once and run on floats and on packets.
+    template <typename T, typename V> V shade( const V& d, const V& a, const V& b ) {
+        V n = normalize(cross(a, b));
+        T c = dot(d, n);
+        n = select(c > T(0), -n, n);
+        V r = d - n * (2 * dot(d, n));
+        return clamp(r * 0.5f, T(-1), T(1)) + V(length(r));
+    }
+
+    template <typename P> void test_lanes() {
+        const int W = P::width;
+        float a[W], b[W], t[W];
+        for (int i = 0; i < W; ++i) {
+            a[i] = random_float();
+            b[i] = (i % 3 == 0)? a[i] : random_float();
+        }
+        P pa = P::load(a), pb = P::load(b);
+
+        (pa + pb).get(t);
+        for (int i = 0; i < W; ++i) BOOST_CHECK_EQUAL( t[i], a[i] + b[i] );
+        (pa - pb * 3.0f).get(t);
+        for (int i = 0; i < W; ++i) BOOST_CHECK_EQUAL( t[i], a[i] - b[i] * 3.0f );
+        (1 / pb).get(t);
+        for (int i = 0; i < W; ++i) BOOST_CHECK_EQUAL( t[i], 1 / b[i] );
+        P q = pa;
+        q /= pb;
+        q += 1.0f;
+        for (int i = 0; i < W; ++i) BOOST_CHECK_EQUAL( q[i], a[i] / b[i] + 1.0f );
+
+        for (int i = 0; i < W; ++i) {
+            BOOST_CHECK_EQUAL( (pa < pb)[i], a[i] < b[i] );
+            BOOST_CHECK_EQUAL( (pa <= pb)[i], a[i] <= b[i] );
+            BOOST_CHECK_EQUAL( (pa == pb)[i], a[i] == b[i] );
+            BOOST_CHECK_EQUAL( (pa != pb)[i], a[i] != b[i] );
+            BOOST_CHECK_EQUAL( ((pa > pb) | !(pa == pb))[i], (a[i] > b[i]) || (a[i] != b[i]) );
+            BOOST_CHECK_EQUAL( select(pa > pb, pa, pb)[i], (a[i] > b[i])? a[i] : b[i] );
+            BOOST_CHECK_EQUAL( min(pa, pb)[i], std::min(a[i], b[i]) );
+            BOOST_CHECK_EQUAL( abs(-pa)[i], std::fabs(a[i]) );
+            BOOST_CHECK_EQUAL( sqrt(abs(pa))[i], std::sqrt(std::fabs(a[i])) );
+            BOOST_CHECK_EQUAL( clamp(pa, P(-2), P(3))[i], clamp(a[i], -2.0f, 3.0f) );
+        }
+
+        BOOST_CHECK( any(pa == pb) );
+        BOOST_CHECK( all(pa == pa) );
+        BOOST_CHECK( !any(pa != pa) );
+        BOOST_CHECK( !all(typename P::mask_type(false)) );
+    }
+
+    template <typename P> void test_vectors() {
+        const int W = P::width;
+        const size_t n = 4 * W + 3;
+        std::vector<Vec3f> d(n), a(n), b(n);
+        for (size_t i = 0; i < n; ++i) {
+            d[i] = Vec3f(random_float(), random_float(), random_float());
+            a[i] = Vec3f(random_float(), random_float(), random_float());
+            b[i] = Vec3f(random_float(), random_float(), random_float());
+        }
+        Vec3Array sd(d.data(), n), sa(a.data(), n), sb(b.data(), n), out(n);
+
+        // the last packet reaches past the end into the padding
+        for (size_t i = 0; i < n; i += W) {
+            Vec3<P> pd, pa, pb;
+            load(pd, sd, i);
+            load(pa, sa, i);
+            load(pb, sb, i);
+            store(out, i, shade<P>(pd, pa, pb));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK( out[i] == shade<float>(d[i], a[i], b[i]) );
+        }
+
+        Vec2<P> u(P(3), P(4));
+        BOOST_CHECK_EQUAL( length(u)[W - 1], 5 );
+        BOOST_CHECK_EQUAL( normalize(u).y[0], 0.8f );
+        Vec4<P> w = 2.0f * Vec4<P>(P(1), P(2), P(3), P(4));
+        BOOST_CHECK_EQUAL( w.w[0], 8 );
+        BOOST_CHECK_EQUAL( select(P(1) < P(0), w, Vec4<P>(P(0))).z[1], 0 );
+    }
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_packet) {
+    std::srand(11);
+    test_lanes<Float4>();
+    test_lanes<Float8>();
+    test_vectors<Float4>();
+    test_vectors<Float8>();
+}
@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/reduce.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "random.h"
+
+using namespace cgmath;
+
+
+namespace {
+
+    // Two-pass reference in double precision
+    PointStats reference( const std::vector<Vec3f>& p ) {
+        PointStats s;
+        s.count = p.size();
+        s.centroid = Vec3d(0.0);
+        for (size_t i = 0; i < p.size(); ++i) {
+            s.centroid += Vec3d(p[i]);
+            for (int k = 0; k < 3; ++k) s.bounds[k] = s.bounds[k].united(p[i][k]);
+        }
+        s.centroid /= static_cast<double>(p.size());
+        double c[3][3] = {};
+        for (size_t i = 0; i < p.size(); ++i) {
+            Vec3d d = Vec3d(p[i]) - s.centroid;
+            for (int j = 0; j < 3; ++j)
+                for (int k = 0; k < 3; ++k) c[j][k] += d[j] * d[k] / p.size();
+        }
+        s.covariance = Mat33d(&c[0][0]);
+        return s;
+    }
+
+    void check_close( const PointStats& a, const PointStats& b, double tolerance ) {
+        BOOST_CHECK_EQUAL( a.count, b.count );
+        for (int k = 0; k < 3; ++k) {
+            BOOST_CHECK_EQUAL( a.bounds[k].start(), b.bounds[k].start() );
+            BOOST_CHECK_EQUAL( a.bounds[k].end(), b.bounds[k].end() );
+            BOOST_CHECK_SMALL( a.centroid[k] - b.centroid[k], tolerance );
+            for (int j = 0; j < 3; ++j) {
+                BOOST_CHECK_SMALL( a.covariance[j][k] - b.covariance[j][k], tolerance * std::sqrt(b.covariance[j][j] * b.covariance[k][k]) );
+            }
+        }
+    }
+
+    bool operator==( const PointStats& a, const PointStats& b ) {
+        for (int k = 0; k < 3; ++k) {
+            if (a.bounds[k] != b.bounds[k]) return false;
+        }
+        return (a.count == b.count) && (a.centroid == b.centroid) && (a.covariance == b.covariance);
+    }
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_point_stats) {
+    std::srand(3);
+    const size_t sizes[] = { 1, 7, 1000, 200000 };
+    for (int s = 0; s < 4; ++s) {
+        // a flat cloud far from the origin, where one-pass sums of squares cancel
+        std::vector<Vec3f> p(sizes[s]);
+        for (size_t i = 0; i < p.size(); ++i) {
+            p[i] = Vec3f(5000 + random_float(), -3000 + 0.1f * random_float(), 1e4f + 0.01f * random_float());
+        }
+        PointStats a = point_stats(&p[0], p.size());
+        check_close(a, reference(p), 1e-6);
+        BOOST_CHECK( point_stats(Vec3Array(&p[0], p.size())) == a );
+
+        ThreadPool one(1);
+        ThreadPool four(4);
+        BOOST_CHECK( point_stats(&p[0], p.size(), one) == a );
+        BOOST_CHECK( point_stats(&p[0], p.size(), four) == a );
+    }
+
+    PointStats e = point_stats(Vec3Array());
+    BOOST_CHECK_EQUAL( e.count, 0u );
+    BOOST_CHECK( e.bounds[0].is_empty() );
+    BOOST_CHECK( e.centroid == Vec3d(0.0) );
+    BOOST_CHECK( e.covariance == Mat33d(0.0) );
+
+    Vec3f q(1, 2, 3);
+    PointStats one = point_stats(&q, 1);
+    BOOST_CHECK( one.centroid == Vec3d(1, 2, 3) );
+    BOOST_CHECK( one.bounds[2] == Range<float>(3) );
+    BOOST_CHECK( one.covariance == Mat33d(0.0) );
+}
@@ -18,6 +18,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <cgmath/vec4.h>
+#include <cstdint>
 
 using namespace cgmath;
 
@@ -179,3 +180,30 @@ BOOST_AUTO_TEST_CASE( test_float_vec4 ) {
 BOOST_AUTO_TEST_CASE( test_double_vec4 ) {
     test_vec4<double>();
 }
+
+
+BOOST_AUTO_TEST_CASE( test_float_vec4_sse ) {
+    Vec4f v[3] = { Vec4f(1.5f, -2.25f, 3.1f, 0.7f), Vec4f(0.3f, 9.0f, -4.4f, 1e-3f), Vec4f(0) };
+    for (int i = 0; i < 3; ++i) {
+        BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>(&v[i]) % 16, 0u );
+    }
+    BOOST_CHECK_EQUAL( sizeof(Vec4f), 4 * sizeof(float) );
+
+    // the SSE versions give the same results as the scalar code
+    const Vec4f& a = v[0];
+    const Vec4f& b = v[1];
+    float d = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    BOOST_CHECK_EQUAL( dot(a, b), d );
+    float l = std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z + a.w * a.w);
+    BOOST_CHECK_EQUAL( length(a), l );
+    Vec4f n = normalize(a);
+    BOOST_CHECK_EQUAL( n.x, a.x * (1 / l) );
+    BOOST_CHECK_EQUAL( n.w, a.w * (1 / l) );
+    Vec4f c = (a + b) * 0.3f - b;
+    BOOST_CHECK_EQUAL( c.y, (a.y + b.y) * 0.3f - b.y );
+    BOOST_CHECK_EQUAL( c.z, (a.z + b.z) * 0.3f - b.z );
+    c = a;
+    c *= b;
+    BOOST_CHECK_EQUAL( c.x, a.x * b.x );
+    BOOST_CHECK_EQUAL( (-v[2]).x, -0.0f );
+}
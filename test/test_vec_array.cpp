@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2007-2011 by Jan Eric Kyprianidis <www.kyprianidis.com>
+    All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <boost/test/unit_test.hpp>
+#include <cgmath/vec_array.h>
+#include <cgmath/util.h>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "random.h"
+
+using namespace cgmath;
+
+
+BOOST_AUTO_TEST_CASE(test_vec_array_storage) {
+    Vec3Array a(5);
+    BOOST_REQUIRE_EQUAL( a.size(), 5u );
+    BOOST_REQUIRE_EQUAL( a.dim(), 3 );
+    for (int k = 0; k < 3; ++k) {
+        BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>(a.stream(k)) % VecArray::ALIGNMENT, 0u );
+    }
+    BOOST_CHECK_EQUAL( a[4].z, 0 );
+
+    std::vector<Vec3f> v;
+    for (int i = 0; i < 37; ++i) v.push_back(Vec3f(float(i), float(2 * i), float(-i)));
+    a.assign(&v[0], v.size());
+    BOOST_REQUIRE_EQUAL( a.size(), 37u );
+    BOOST_CHECK_EQUAL( a.y()[10], 20 );
+    BOOST_CHECK_EQUAL( a[36].z, -36 );
+
+    a.resize(100);
+    BOOST_CHECK_EQUAL( a[36].x, 36 );
+    BOOST_CHECK_EQUAL( a[99].x, 0 );
+    a.set(99, Vec3f(1, 2, 3));
+    BOOST_CHECK_EQUAL( a.z()[99], 3 );
+
+    Vec3Array b(a);
+    a.set(0, Vec3f(7, 7, 7));
+    BOOST_CHECK_EQUAL( b[0].x, 0 );
+    BOOST_CHECK_EQUAL( b[99].y, 2 );
+
+    std::vector<Vec3f> w(37);
+    Vec3Array(&v[0], v.size()).copy_to(&w[0]);
+    for (size_t i = 0; i < v.size(); ++i) {
+        BOOST_CHECK( w[i] == v[i] );
+    }
+
+    std::vector<Vec4f> v4(3, Vec4f(1, 2, 3, 4));
+    Vec4Array a4(&v4[0], 3);
+    BOOST_CHECK_EQUAL( a4[2].w, 4 );
+    Vec2Array a2;
+    BOOST_CHECK( a2.empty() );
+}
+
+
+BOOST_AUTO_TEST_CASE(test_vec_array_kernels) {
+    std::srand(7);
+    const size_t sizes[] = { 0, 1, 3, 8, 13, 1000 };
+    for (int s = 0; s < 6; ++s) {
+        size_t n = sizes[s];
+        std::vector<Vec2f> a2(n), b2(n);
+        std::vector<Vec3f> a3(n), b3(n);
+        std::vector<Vec4f> a4(n), b4(n);
+        for (size_t i = 0; i < n; ++i) {
+            a2[i] = Vec2f(random_float(), random_float());
+            b2[i] = Vec2f(random_float(), random_float());
+            a3[i] = Vec3f(random_float(), random_float(), random_float());
+            b3[i] = Vec3f(random_float(), random_float(), random_float());
+            a4[i] = Vec4f(random_float(), random_float(), random_float(), random_float());
+            b4[i] = Vec4f(random_float(), random_float(), random_float(), random_float());
+        }
+        Vec2Array sa2(a2.data(), n), sb2(b2.data(), n), r2;
+        Vec3Array sa3(a3.data(), n), sb3(b3.data(), n), r3;
+        Vec4Array sa4(a4.data(), n), sb4(b4.data(), n), r4;
+        std::vector<float> out(n + 1);
+
+        dot(sa2, sb2, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], dot(a2[i], b2[i]) );
+        length(sa2, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], length(a2[i]) );
+        distance(sa2, sb2, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], distance(a2[i], b2[i]) );
+        normalize(sa2, r2);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r2[i] == normalize(a2[i]) );
+        clamp(sa2, -2.0f, 3.0f, r2);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r2[i] == Vec2f(clamp(a2[i].x, -2.0f, 3.0f), clamp(a2[i].y, -2.0f, 3.0f)) );
+
+        dot(sa3, sb3, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], dot(a3[i], b3[i]) );
+        length(sa3, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], length(a3[i]) );
+        distance(sa3, sb3, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], distance(a3[i], b3[i]) );
+        normalize(sa3, r3);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r3[i] == normalize(a3[i]) );
+        cross(sa3, sb3, r3);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r3[i] == cross(a3[i], b3[i]) );
+        clamp(sa3, -2.0f, 3.0f, r3);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r3[i] == clamp(a3[i], -2.0f, 3.0f) );
+
+        dot(sa4, sb4, out.data());
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL( out[i], a4[i].x * b4[i].x + a4[i].y * b4[i].y + a4[i].z * b4[i].z + a4[i].w * b4[i].w );
+        }
+        length(sa4, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], length(a4[i]) );
+        distance(sa4, sb4, out.data());
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL( out[i], length(a4[i] - b4[i]) );
+        normalize(sa4, r4);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( r4[i] == normalize(a4[i]) );
+
+        // in place, the output aliasing an operand
+        axpy(0.5f, sb3, sa3);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( sa3[i] == a3[i] + b3[i] * 0.5f );
+        normalize(sa2, sa2);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( sa2[i] == normalize(a2[i]) );
+        axpy(-1.0f, sb4, sa4);
+        for (size_t i = 0; i < n; ++i) BOOST_CHECK( sa4[i] == a4[i] - b4[i] );
+    }
+}